@@ -0,0 +1,53 @@
+#include "alloc_counter.h"
+
+#include <cstddef>
+#include <cstdlib>
+
+namespace {
+thread_local quint64 t_allocations = 0;
+} // namespace
+
+#ifdef __GLIBC__
+
+extern "C" {
+void *__libc_malloc(size_t size) noexcept;
+void *__libc_calloc(size_t count, size_t size) noexcept;
+void *__libc_realloc(void *p, size_t size) noexcept;
+void __libc_free(void *p) noexcept;
+
+// operator new and QArrayData both end up here
+void *malloc(size_t size) noexcept {
+    ++t_allocations;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) noexcept {
+    ++t_allocations;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *p, size_t size) noexcept {
+    ++t_allocations;
+    return __libc_realloc(p, size);
+}
+
+void free(void *p) noexcept {
+    __libc_free(p);
+}
+}
+
+bool AllocCounter::isAvailable() {
+    return true;
+}
+
+#else
+
+bool AllocCounter::isAvailable() {
+    return false;
+}
+
+#endif
+
+quint64 AllocCounter::current() {
+    return t_allocations;
+}
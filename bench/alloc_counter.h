@@ -0,0 +1,12 @@
+#pragma once
+
+#include <QtGlobal>
+
+// Counts heap allocations made by the calling thread, including the ones
+// Qt containers make with malloc directly. The benchmark binary wraps
+// glibc's allocator to feed it; elsewhere the count stays at zero.
+class AllocCounter {
+public:
+    static bool isAvailable();
+    static quint64 current();
+};
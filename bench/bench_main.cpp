@@ -0,0 +1,183 @@
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTemporaryDir>
+
+#include <cstdio>
+
+#include "gui_bench.h"
+#include "micro_bench.h"
+#include "spawn_helper.h"
+#include "theme.h"
+
+namespace {
+
+struct BenchOptions {
+    QString suite;
+    QString output;
+    QString label;
+    bool noListen = false;
+    GuiBench::Options gui;
+    MicroBench::Options micro;
+};
+
+int intValue(const QCommandLineParser &parser, const QCommandLineOption &option, int fallback) {
+    bool ok = false;
+    const int value = parser.value(option).toInt(&ok);
+    return ok && value >= 0 ? value : fallback;
+}
+
+// Runs the micro suite in a fresh copy of this binary, so that the spawn
+// helper there belongs to the main thread instead of the engine thread
+QJsonObject runMicroInChild(const MicroBench::Options &options) {
+    const QStringList arguments{
+        QStringLiteral("--suite"), QStringLiteral("micro"),
+        QStringLiteral("--parse-iterations"), QString::number(options.parseIterations),
+        QStringLiteral("--settings-entries"), QString::number(options.settingsEntries),
+        QStringLiteral("--spawn-iterations"), QString::number(options.spawnIterations),
+        QStringLiteral("--ballast-mb"), QString::number(options.ballastMb),
+    };
+
+    QProcess child;
+    child.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    child.start(QCoreApplication::applicationFilePath(), arguments);
+    if (!child.waitForFinished(-1) || child.exitCode() != 0) {
+        return QJsonObject{{QStringLiteral("error"), QStringLiteral("micro suite failed")}};
+    }
+    return QJsonDocument::fromJson(child.readAllStandardOutput()).object();
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    QElapsedTimer sinceMain;
+    sinceMain.start();
+
+    QStringList arguments;
+    for (int i = 0; i < argc; ++i) {
+        arguments.append(QString::fromLocal8Bit(argv[i]));
+    }
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Measures warp-gui against a scripted warp-cli"));
+    const QCommandLineOption helpOption = parser.addHelpOption();
+    const QCommandLineOption suiteOption(QStringLiteral("suite"), QStringLiteral("all, gui or micro."),
+                                         QStringLiteral("name"), QStringLiteral("all"));
+    const QCommandLineOption outputOption(QStringLiteral("output"), QStringLiteral("Write JSON here instead of stdout."),
+                                          QStringLiteral("file"));
+    const QCommandLineOption labelOption(QStringLiteral("label"), QStringLiteral("Stored in the report, e.g. a commit."),
+                                         QStringLiteral("text"));
+    const QCommandLineOption noListenOption(QStringLiteral("no-listen"),
+                                            QStringLiteral("Make the status watch fail so the GUI polls."));
+    const QCommandLineOption iterationsOption(QStringLiteral("iterations"),
+                                              QStringLiteral("Popup shows, dialog reopens and page visits."),
+                                              QStringLiteral("n"));
+    const QCommandLineOption pollOption(QStringLiteral("poll-iterations"), QStringLiteral("Status round trips."),
+                                        QStringLiteral("n"));
+    const QCommandLineOption idleOption(QStringLiteral("idle-seconds"), QStringLiteral("Idle CPU window."),
+                                        QStringLiteral("s"));
+    const QCommandLineOption parseOption(QStringLiteral("parse-iterations"), QStringLiteral("Status parses."),
+                                         QStringLiteral("n"));
+    const QCommandLineOption entriesOption(QStringLiteral("settings-entries"),
+                                           QStringLiteral("Split tunnel entries in the settings text."),
+                                           QStringLiteral("n"));
+    const QCommandLineOption spawnOption(QStringLiteral("spawn-iterations"), QStringLiteral("Child processes per method."),
+                                         QStringLiteral("n"));
+    const QCommandLineOption ballastOption(QStringLiteral("ballast-mb"),
+                                           QStringLiteral("Heap held while measuring spawns."), QStringLiteral("mb"));
+    parser.addOptions({suiteOption, outputOption, labelOption, noListenOption, iterationsOption, pollOption, idleOption,
+                       parseOption, entriesOption, spawnOption, ballastOption});
+
+    // Parsed before QApplication: the environment below has to be in place
+    // before the spawn helper forks and before the platform plugin loads
+    const bool parsed = parser.parse(arguments);
+
+    BenchOptions options;
+    options.suite = parser.value(suiteOption);
+    options.output = parser.value(outputOption);
+    options.label = parser.value(labelOption);
+    options.noListen = parser.isSet(noListenOption);
+    options.gui.iterations = intValue(parser, iterationsOption, options.gui.iterations);
+    options.gui.pollIterations = intValue(parser, pollOption, options.gui.pollIterations);
+    options.gui.idleSeconds = intValue(parser, idleOption, options.gui.idleSeconds);
+    options.micro.parseIterations = qMax(1, intValue(parser, parseOption, options.micro.parseIterations));
+    options.micro.settingsEntries = intValue(parser, entriesOption, options.micro.settingsEntries);
+    options.micro.spawnIterations = intValue(parser, spawnOption, options.micro.spawnIterations);
+    options.micro.ballastMb = intValue(parser, ballastOption, options.micro.ballastMb);
+
+    // Stub warp-cli first on PATH, private config, state and runtime
+    // directories, no daemon socket
+    QTemporaryDir scratch;
+    const QByteArray stubDir = qEnvironmentVariableIsSet("WARP_GUI_BENCH_STUB_DIR")
+                                   ? qgetenv("WARP_GUI_BENCH_STUB_DIR")
+                                   : QByteArray(WARP_GUI_BENCH_STUB_DIR);
+    qputenv("PATH", stubDir + ':' + qgetenv("PATH"));
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    qputenv("XDG_CONFIG_HOME", QFile::encodeName(scratch.path()));
+    qputenv("XDG_RUNTIME_DIR", QFile::encodeName(scratch.path()));
+    qputenv("XDG_STATE_HOME", QFile::encodeName(scratch.path()));
+    qunsetenv("WARP_GUI_DAEMON_SOCKET");
+    options.gui.stubLog = scratch.filePath(QStringLiteral("warp-cli.log"));
+    options.gui.appPath = qEnvironmentVariableIsSet("WARP_GUI_BENCH_APP")
+                              ? qEnvironmentVariable("WARP_GUI_BENCH_APP")
+                              : QStringLiteral(WARP_GUI_BENCH_APP);
+    qputenv("WARP_STUB_LOG", QFile::encodeName(options.gui.stubLog));
+    if (options.noListen) {
+        qputenv("WARP_STUB_LISTEN", "0");
+    }
+
+    SpawnHelper::launch();
+
+    QApplication app(argc, argv);
+    app.setQuitOnLastWindowClosed(false);
+    static const QStringList suites{QStringLiteral("all"), QStringLiteral("gui"), QStringLiteral("micro")};
+    if (!parsed || !suites.contains(options.suite)) {
+        std::fprintf(stderr, "%s\n",
+                     qPrintable(parsed ? QStringLiteral("Unknown suite: %1").arg(options.suite) : parser.errorText()));
+        return 2;
+    }
+    if (parser.isSet(helpOption)) {
+        parser.showHelp();
+    }
+    Theme::install(app);
+
+    QJsonObject report;
+    if (options.suite == QStringLiteral("micro")) {
+        // Child of an "all" run, or run on its own
+        report = MicroBench::run(options.micro);
+    } else {
+        report.insert(QStringLiteral("benchmark"), QStringLiteral("warp-gui-bench"));
+        report.insert(QStringLiteral("label"), options.label);
+        report.insert(QStringLiteral("timestamp"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+        report.insert(QStringLiteral("qt"), QString::fromLatin1(qVersion()));
+        report.insert(QStringLiteral("platform"), QGuiApplication::platformName());
+        report.insert(QStringLiteral("statusChannel"),
+                      options.noListen ? QStringLiteral("poll") : QStringLiteral("listen"));
+        if (options.suite == QStringLiteral("all") || options.suite == QStringLiteral("gui")) {
+            report.insert(QStringLiteral("gui"), GuiBench::run(options.gui, sinceMain));
+        }
+        if (options.suite == QStringLiteral("all")) {
+            report.insert(QStringLiteral("micro"), runMicroInChild(options.micro));
+        }
+    }
+
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+    if (options.output.isEmpty()) {
+        std::fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+        return 0;
+    }
+
+    QFile file(options.output);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+        std::fprintf(stderr, "Cannot write %s\n", qPrintable(options.output));
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "bench_util.h"
+
+#include <QCoreApplication>
+#include <QDeadlineTimer>
+#include <QEvent>
+#include <QEventLoop>
+#include <QJsonValue>
+#include <QTimer>
+#include <QWidget>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+class PaintWatcher : public QObject {
+public:
+    bool painted = false;
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override {
+        if (event->type() == QEvent::Paint) {
+            // Let the widget paint first, then report
+            QCoreApplication::postEvent(this, new QEvent(QEvent::User));
+        }
+        return QObject::eventFilter(watched, event);
+    }
+
+    void customEvent(QEvent *event) override {
+        if (event->type() == QEvent::User) {
+            painted = true;
+        }
+    }
+};
+
+} // namespace
+
+BenchSamples::BenchSamples(const QString &unit)
+    : m_unit(unit) {
+}
+
+void BenchSamples::add(double value) {
+    m_values.append(value);
+}
+
+bool BenchSamples::isEmpty() const {
+    return m_values.isEmpty();
+}
+
+double BenchSamples::median() const {
+    return percentile(0.5);
+}
+
+double BenchSamples::percentile(double fraction) const {
+    if (m_values.isEmpty()) {
+        return 0.0;
+    }
+    QVector<double> sorted = m_values;
+    std::sort(sorted.begin(), sorted.end());
+    const qsizetype index = qBound<qsizetype>(
+        0, static_cast<qsizetype>(std::ceil(fraction * static_cast<double>(sorted.size()))) - 1, sorted.size() - 1);
+    return sorted.at(index);
+}
+
+QJsonObject BenchSamples::toJson() const {
+    QJsonObject json{
+        {QStringLiteral("unit"), m_unit},
+        {QStringLiteral("count"), static_cast<int>(m_values.size())},
+    };
+    if (m_values.isEmpty()) {
+        return json;
+    }
+
+    json.insert(QStringLiteral("min"), *std::min_element(m_values.cbegin(), m_values.cend()));
+    json.insert(QStringLiteral("median"), median());
+    json.insert(QStringLiteral("p95"), percentile(0.95));
+    json.insert(QStringLiteral("max"), *std::max_element(m_values.cbegin(), m_values.cend()));
+    json.insert(QStringLiteral("mean"),
+                std::accumulate(m_values.cbegin(), m_values.cend(), 0.0) / static_cast<double>(m_values.size()));
+    return json;
+}
+
+bool BenchUtil::waitUntil(const std::function<bool()> &done, int timeoutMs) {
+    // Guarantees a wakeup even when nothing else is pending
+    QTimer tick;
+    tick.start(5);
+
+    const QDeadlineTimer deadline(timeoutMs);
+    while (!done()) {
+        if (deadline.hasExpired()) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    return true;
+}
+
+bool BenchUtil::waitForPaint(QWidget *widget, int timeoutMs) {
+    PaintWatcher watcher;
+    widget->installEventFilter(&watcher);
+    const bool painted = waitUntil([&watcher]() { return watcher.painted; }, timeoutMs);
+    widget->removeEventFilter(&watcher);
+    return painted;
+}
+
+void BenchUtil::idle(int ms) {
+    QEventLoop loop;
+    QTimer::singleShot(ms, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+double BenchUtil::elapsedMs(qint64 nsecs) {
+    return static_cast<double>(nsecs) / 1e6;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+class QWidget;
+
+// Repeated measurements of one quantity, summarised for the JSON report
+class BenchSamples {
+public:
+    explicit BenchSamples(const QString &unit = QStringLiteral("ms"));
+
+    void add(double value);
+    bool isEmpty() const;
+    double median() const;
+
+    // {"unit", "count", "min", "median", "p95", "max", "mean"}
+    QJsonObject toJson() const;
+
+private:
+    double percentile(double fraction) const;
+
+    QString m_unit;
+    QVector<double> m_values;
+};
+
+class BenchUtil {
+public:
+    // Runs the event loop until done() holds. Returns false on timeout.
+    static bool waitUntil(const std::function<bool()> &done, int timeoutMs = 5000);
+
+    // Runs the event loop until widget has handled a paint event, i.e. a
+    // frame with it has been rendered. Returns false on timeout.
+    static bool waitForPaint(QWidget *widget, int timeoutMs = 5000);
+
+    // Runs the event loop for the given time
+    static void idle(int ms);
+
+    static double elapsedMs(qint64 nsecs);
+};
@@ -0,0 +1,277 @@
+#include "gui_bench.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QListWidget>
+#include <QProcess>
+#include <QStackedWidget>
+
+#include <memory>
+
+#include <sys/resource.h>
+
+#include "bench_util.h"
+#include "popup_widget.h"
+#include "preferences_dialog.h"
+#include "tray_app.h"
+#include "warp_state_cache.h"
+
+namespace {
+
+// The tray stays up for the whole run, like in the real application
+std::unique_ptr<TrayApp> s_tray;
+
+double cpuMs(const rusage &usage) {
+    return usage.ru_utime.tv_sec * 1e3 + usage.ru_utime.tv_usec / 1e3 + usage.ru_stime.tv_sec * 1e3 +
+           usage.ru_stime.tv_usec / 1e3;
+}
+
+int countLines(const QString &path) {
+    QFile file(path);
+    if (path.isEmpty() || !file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    return static_cast<int>(file.readAll().count('\n'));
+}
+
+} // namespace
+
+QJsonObject GuiBench::run(const Options &options, const QElapsedTimer &sinceMain) {
+    QJsonObject results;
+    results.insert(QStringLiteral("startup"), startup(sinceMain));
+    results.insert(QStringLiteral("popup"), popup(options));
+    results.insert(QStringLiteral("preferences"), preferences(options));
+    results.insert(QStringLiteral("statusPoll"), statusPoll(options));
+    results.insert(QStringLiteral("statusCommand"), statusCommand(options));
+    results.insert(QStringLiteral("idle"), idle(options));
+
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    results.insert(QStringLiteral("maxRssKb"), static_cast<double>(usage.ru_maxrss));
+
+    s_tray.reset();
+    return results;
+}
+
+QJsonObject GuiBench::startup(const QElapsedTimer &sinceMain) {
+    QJsonObject json;
+
+    s_tray = std::make_unique<TrayApp>();
+    json.insert(QStringLiteral("trayConstructedMs"), BenchUtil::elapsedMs(sinceMain.nsecsElapsed()));
+
+    // Connected after TrayApp's own handler, so by the time this runs the
+    // first status has been applied to the tray icon
+    WarpStateCache *cache = WarpStateCache::instance();
+    QObject context;
+    bool statusSeen = false;
+    QObject::connect(cache, &WarpStateCache::updated, &context, [&statusSeen](WarpStateCache::Entry entry) {
+        statusSeen = statusSeen || entry == WarpStateCache::Entry::Status;
+    });
+
+    s_tray->start();
+    json.insert(QStringLiteral("trayShownMs"), BenchUtil::elapsedMs(sinceMain.nsecsElapsed()));
+
+    if (BenchUtil::waitUntil([&statusSeen]() { return statusSeen; }, 10000)) {
+        json.insert(QStringLiteral("firstStatusIconMs"), BenchUtil::elapsedMs(sinceMain.nsecsElapsed()));
+    }
+    return json;
+}
+
+QJsonObject GuiBench::popup(const Options &options) {
+    // Same window setup as TrayApp, without the LayerShell placement
+    WarpPopup popup;
+    popup.setWindowFlags(Qt::Window | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint);
+    popup.setStatusText(QStringLiteral("Connected"), QString());
+    popup.setMode(QStringLiteral("warp"));
+
+    QJsonObject json;
+    BenchSamples warm;
+    QElapsedTimer timer;
+    for (int i = 0; i <= options.iterations; ++i) {
+        timer.start();
+        popup.show();
+        if (!BenchUtil::waitForPaint(&popup)) {
+            json.insert(QStringLiteral("error"), QStringLiteral("popup was never painted"));
+            break;
+        }
+        const double ms = BenchUtil::elapsedMs(timer.nsecsElapsed());
+        if (i == 0) {
+            json.insert(QStringLiteral("coldShowMs"), ms);
+        } else {
+            warm.add(ms);
+        }
+        popup.hide();
+        QCoreApplication::processEvents();
+    }
+
+    json.insert(QStringLiteral("show"), warm.toJson());
+    return json;
+}
+
+QJsonObject GuiBench::preferences(const Options &options) {
+    QJsonObject json;
+    QElapsedTimer timer;
+
+    timer.start();
+    auto dialog = std::make_unique<PreferencesDialog>();
+    dialog->show();
+    if (!BenchUtil::waitForPaint(dialog.get())) {
+        json.insert(QStringLiteral("error"), QStringLiteral("dialog was never painted"));
+        return json;
+    }
+    json.insert(QStringLiteral("coldOpenMs"), BenchUtil::elapsedMs(timer.nsecsElapsed()));
+
+    auto *sidebar = dialog->findChild<QListWidget *>(QString(), Qt::FindDirectChildrenOnly);
+    auto *stack = dialog->findChild<QStackedWidget *>(QString(), Qt::FindDirectChildrenOnly);
+    if (!sidebar || !stack) {
+        json.insert(QStringLiteral("error"), QStringLiteral("sidebar or page stack not found"));
+        return json;
+    }
+
+    // Visit every page in turn; the first visit of each builds it
+    const int pageCount = sidebar->count();
+    QVector<BenchSamples> warm(pageCount);
+    QJsonObject pages;
+    for (int round = 0; round < options.iterations; ++round) {
+        for (int step = 1; step <= pageCount; ++step) {
+            const int page = step % pageCount;
+            timer.start();
+            sidebar->setCurrentRow(page);
+            BenchUtil::waitForPaint(stack->currentWidget());
+            const double ms = BenchUtil::elapsedMs(timer.nsecsElapsed());
+
+            const QString name = sidebar->item(page)->text();
+            if (round == 0 && page != 0) {
+                QJsonObject entry;
+                entry.insert(QStringLiteral("coldMs"), ms);
+                pages.insert(name, entry);
+            } else {
+                warm[page].add(ms);
+            }
+        }
+    }
+    for (int page = 0; page < pageCount; ++page) {
+        const QString name = sidebar->item(page)->text();
+        QJsonObject entry = pages.value(name).toObject();
+        entry.insert(QStringLiteral("warm"), warm.at(page).toJson());
+        pages.insert(name, entry);
+    }
+    json.insert(QStringLiteral("pageSwitch"), pages);
+
+    // The dialog is kept and reused by TrayApp, so reopening is the common case
+    BenchSamples reopen;
+    for (int i = 0; i < options.iterations; ++i) {
+        dialog->hide();
+        QCoreApplication::processEvents();
+        timer.start();
+        dialog->show();
+        if (BenchUtil::waitForPaint(dialog.get())) {
+            reopen.add(BenchUtil::elapsedMs(timer.nsecsElapsed()));
+        }
+    }
+    json.insert(QStringLiteral("reopen"), reopen.toJson());
+
+    dialog->hide();
+    return json;
+}
+
+QJsonObject GuiBench::statusPoll(const Options &options) {
+    WarpStateCache *cache = WarpStateCache::instance();
+    QObject context;
+    bool done = false;
+    int failures = 0;
+    QObject::connect(cache, &WarpStateCache::updated, &context, [&done](WarpStateCache::Entry entry) {
+        done = done || entry == WarpStateCache::Entry::Status;
+    });
+    QObject::connect(cache, &WarpStateCache::failed, &context,
+                     [&done, &failures](WarpStateCache::Entry entry, const WarpResult &) {
+                         if (entry == WarpStateCache::Entry::Status) {
+                             done = true;
+                             ++failures;
+                         }
+                     });
+
+    // refresh() through to the parsed snapshot arriving on the GUI thread
+    BenchSamples roundTrip;
+    QElapsedTimer timer;
+    for (int i = 0; i < options.pollIterations; ++i) {
+        done = false;
+        timer.start();
+        cache->refresh(WarpStateCache::Entry::Status);
+        if (BenchUtil::waitUntil([&done]() { return done; }, 10000)) {
+            roundTrip.add(BenchUtil::elapsedMs(timer.nsecsElapsed()));
+        }
+    }
+
+    QJsonObject json = roundTrip.toJson();
+    json.insert(QStringLiteral("failures"), failures);
+    return json;
+}
+
+QJsonObject GuiBench::statusCommand(const Options &options) {
+    // Launch of `warp-gui --status` to its exit, answered by the tray's
+    // state server in this process; what a prompt or status bar pays per call
+    constexpr double kGoalMs = 10.0;
+    if (options.appPath.isEmpty() || !QFile::exists(options.appPath)) {
+        return QJsonObject{{QStringLiteral("error"), QStringLiteral("warp-gui binary not found")}};
+    }
+
+    BenchSamples launch;
+    int failures = 0;
+    QElapsedTimer timer;
+    for (int i = 0; i < options.pollIterations; ++i) {
+        QProcess process;
+        process.setStandardOutputFile(QProcess::nullDevice());
+        bool finished = false;
+        QObject::connect(&process, &QProcess::finished, [&finished]() { finished = true; });
+        QObject::connect(&process, &QProcess::errorOccurred, [&finished](QProcess::ProcessError error) {
+            finished = finished || error == QProcess::FailedToStart;
+        });
+        timer.start();
+        process.start(options.appPath, {QStringLiteral("--status")});
+        // The event loop has to keep running: this process is the server
+        if (!BenchUtil::waitUntil([&finished]() { return finished; }, 5000) ||
+            process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+            ++failures;
+            continue;
+        }
+        launch.add(BenchUtil::elapsedMs(timer.nsecsElapsed()));
+    }
+
+    QJsonObject json = launch.toJson();
+    json.insert(QStringLiteral("goalMs"), kGoalMs);
+    json.insert(QStringLiteral("withinGoal"), !launch.isEmpty() && launch.median() < kGoalMs);
+    json.insert(QStringLiteral("failures"), failures);
+    return json;
+}
+
+QJsonObject GuiBench::idle(const Options &options) {
+    // Settle whatever the previous steps left in flight
+    BenchUtil::idle(1000);
+
+    rusage before{};
+    getrusage(RUSAGE_SELF, &before);
+    const int spawnsBefore = countLines(options.stubLog);
+    QElapsedTimer wall;
+    wall.start();
+
+    BenchUtil::idle(options.idleSeconds * 1000);
+
+    rusage after{};
+    getrusage(RUSAGE_SELF, &after);
+    const double wallMs = BenchUtil::elapsedMs(wall.nsecsElapsed());
+    const double cpu = cpuMs(after) - cpuMs(before);
+    const int spawns = countLines(options.stubLog) - spawnsBefore;
+    const double perHour = 3600000.0 / wallMs;
+
+    // CPU of this process only; warp-cli children are counted, not timed
+    QJsonObject json;
+    json.insert(QStringLiteral("seconds"), wallMs / 1000.0);
+    json.insert(QStringLiteral("cpuMs"), cpu);
+    json.insert(QStringLiteral("cpuMsPerHour"), cpu * perHour);
+    json.insert(QStringLiteral("voluntaryContextSwitches"), static_cast<double>(after.ru_nvcsw - before.ru_nvcsw));
+    json.insert(QStringLiteral("warpCliSpawns"), spawns);
+    json.insert(QStringLiteral("warpCliSpawnsPerHour"), spawns * perHour);
+    return json;
+}
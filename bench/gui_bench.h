@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QString>
+
+class QElapsedTimer;
+
+// End-to-end timings of the real widgets and state cache, talking to the
+// stub warp-cli. Needs a QApplication, normally on the offscreen platform.
+class GuiBench {
+public:
+    struct Options {
+        int iterations = 20;      // popup shows, dialog reopens, page visits
+        int pollIterations = 50;  // status round trips
+        int idleSeconds = 60;     // idle CPU window
+        QString stubLog;          // WARP_STUB_LOG of the stub, for spawn counts
+        QString appPath;          // warp-gui binary run as `warp-gui --status`
+    };
+
+    // sinceMain was started at the top of main()
+    static QJsonObject run(const Options &options, const QElapsedTimer &sinceMain);
+
+private:
+    static QJsonObject startup(const QElapsedTimer &sinceMain);
+    static QJsonObject popup(const Options &options);
+    static QJsonObject preferences(const Options &options);
+    static QJsonObject statusPoll(const Options &options);
+    static QJsonObject statusCommand(const Options &options);
+    static QJsonObject idle(const Options &options);
+};
@@ -0,0 +1,200 @@
+#include "micro_bench.h"
+
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QLabel>
+#include <QProcess>
+
+#include <optional>
+
+#include "alloc_counter.h"
+#include "bench_util.h"
+#include "child_process.h"
+#include "popup_widget.h"
+#include "spawn_helper.h"
+#include "status_snapshot.h"
+#include "warp_settings.h"
+
+namespace {
+
+// Keeps the optimiser from discarding a result
+volatile quint64 s_sink = 0;
+
+QJsonObject perCall(qint64 nsecs, int calls, std::optional<quint64> allocations = std::nullopt) {
+    QJsonObject json;
+    json.insert(QStringLiteral("calls"), calls);
+    json.insert(QStringLiteral("nsPerCall"), static_cast<double>(nsecs) / calls);
+    if (allocations && AllocCounter::isAvailable()) {
+        json.insert(QStringLiteral("allocationsPerCall"), static_cast<double>(*allocations) / calls);
+    }
+    return json;
+}
+
+QByteArray settingsText(int entries) {
+    QByteArray text("Merged configuration:\n"
+                    "(user set)\tMode: WarpWithDnsOverHttps\n"
+                    "(default)\tDisabled for Wifi: false\n"
+                    "(default)\tDisabled for Ethernet: false\n"
+                    "(default)\tExclude mode, with hosts/ips:\n");
+    text.reserve(text.size() + entries * 24);
+    for (int i = 0; i < entries; ++i) {
+        if (i % 2 == 0) {
+            text += "  10." + QByteArray::number((i >> 16) & 0xff) + '.' + QByteArray::number((i >> 8) & 0xff) +
+                    '.' + QByteArray::number(i & 0xff) + "/32\n";
+        } else {
+            text += "  host" + QByteArray::number(i) + ".example.com\n";
+        }
+    }
+    text += "(default)\tFallback domains:\n";
+    for (int i = 0; i < 100; ++i) {
+        text += "  domain" + QByteArray::number(i) + ".internal\n";
+    }
+    text += "(default)\tFamilies: Off\n";
+    return text;
+}
+
+// Starts `true` and waits for it to exit; returns the elapsed milliseconds
+double spawnChild() {
+    QElapsedTimer timer;
+    timer.start();
+    ChildProcess child;
+    bool exited = false;
+    QObject::connect(&child, &ChildProcess::finished, [&exited]() { exited = true; });
+    QObject::connect(&child, &ChildProcess::failedToStart, [&exited]() { exited = true; });
+    child.start(QStringLiteral("true"), {});
+    BenchUtil::waitUntil([&exited]() { return exited; });
+    return BenchUtil::elapsedMs(timer.nsecsElapsed());
+}
+
+double spawnQProcess() {
+    QElapsedTimer timer;
+    timer.start();
+    QProcess process;
+    process.start(QStringLiteral("true"), {});
+    process.waitForFinished();
+    return BenchUtil::elapsedMs(timer.nsecsElapsed());
+}
+
+} // namespace
+
+QJsonObject MicroBench::run(const Options &options) {
+    QJsonObject results;
+    results.insert(QStringLiteral("statusParse"), statusParse(options));
+    results.insert(QStringLiteral("settingsParse"), settingsParse(options));
+    results.insert(QStringLiteral("themePolish"), themePolish(options));
+    results.insert(QStringLiteral("spawn"), spawn(options));
+    return results;
+}
+
+QJsonObject MicroBench::statusParse(const Options &options) {
+    const QByteArray connected(R"({"status":"Connected"})");
+    const QByteArray disconnected(
+        R"({"status":"Disconnected","reason":{"Manual":"The user disconnected"}})");
+    const int n = options.parseIterations;
+    QElapsedTimer timer;
+    QJsonObject json;
+
+    // Steady state: the poll returns what the last one did
+    StatusSnapshot snapshot;
+    snapshot.parseJson(connected);
+    quint64 allocations = AllocCounter::current();
+    timer.start();
+    for (int i = 0; i < n; ++i) {
+        s_sink += static_cast<quint64>(snapshot.parseJson(connected));
+    }
+    json.insert(QStringLiteral("unchanged"), perCall(timer.nsecsElapsed(), n, AllocCounter::current() - allocations));
+
+    // Every poll flips the state
+    allocations = AllocCounter::current();
+    timer.start();
+    for (int i = 0; i < n; ++i) {
+        s_sink += static_cast<quint64>(snapshot.parseJson((i & 1) ? connected : disconnected));
+    }
+    json.insert(QStringLiteral("changing"), perCall(timer.nsecsElapsed(), n, AllocCounter::current() - allocations));
+
+    // What the status path used to do, for comparison
+    allocations = AllocCounter::current();
+    timer.start();
+    for (int i = 0; i < n; ++i) {
+        const QJsonObject object = QJsonDocument::fromJson(connected).object();
+        s_sink += static_cast<quint64>(object.value(QStringLiteral("status")).toString().size());
+    }
+    json.insert(QStringLiteral("qjsonBaseline"),
+                perCall(timer.nsecsElapsed(), n, AllocCounter::current() - allocations));
+    return json;
+}
+
+QJsonObject MicroBench::settingsParse(const Options &options) {
+    const QByteArray text = settingsText(options.settingsEntries);
+    BenchSamples ms;
+    quint64 allocations = 0;
+    int parsed = 0;
+
+    for (int i = 0; i < options.settingsIterations; ++i) {
+        const quint64 before = AllocCounter::current();
+        QElapsedTimer timer;
+        timer.start();
+        const WarpSettings settings = WarpSettings::parse(text);
+        ms.add(BenchUtil::elapsedMs(timer.nsecsElapsed()));
+        allocations += AllocCounter::current() - before;
+        parsed = static_cast<int>(settings.exclude.addresses.size() + settings.exclude.hosts.size());
+    }
+
+    QJsonObject json = ms.toJson();
+    json.insert(QStringLiteral("entries"), options.settingsEntries);
+    json.insert(QStringLiteral("parsedEntries"), parsed);
+    json.insert(QStringLiteral("bytes"), static_cast<int>(text.size()));
+    if (AllocCounter::isAvailable() && options.settingsIterations > 0) {
+        json.insert(QStringLiteral("allocationsPerParse"),
+                    static_cast<double>(allocations) / options.settingsIterations);
+    }
+    return json;
+}
+
+QJsonObject MicroBench::themePolish(const Options &options) {
+    const int n = options.polishIterations;
+    QElapsedTimer timer;
+    QJsonObject json;
+
+    // Theme state switch, as applyUiState does on every status change
+    WarpPopup popup;
+    popup.ensurePolished();
+    timer.start();
+    for (int i = 0; i < n; ++i) {
+        popup.setZeroTrust(i & 1);
+    }
+    json.insert(QStringLiteral("themeState"), perCall(timer.nsecsElapsed(), n));
+
+    // A per-widget stylesheet per change, as the title used to be styled
+    QLabel label(QStringLiteral("WARP"));
+    label.ensurePolished();
+    const QString zeroTrust = QStringLiteral("color: #3b82f6; font-size: 20px; font-weight: bold;");
+    const QString warp = QStringLiteral("color: #f38020; font-size: 20px; font-weight: bold;");
+    timer.start();
+    for (int i = 0; i < n; ++i) {
+        label.setStyleSheet((i & 1) ? zeroTrust : warp);
+    }
+    json.insert(QStringLiteral("setStyleSheetBaseline"), perCall(timer.nsecsElapsed(), n));
+    return json;
+}
+
+QJsonObject MicroBench::spawn(const Options &options) {
+    // Grow and touch the heap so fork() has a realistic address space to copy
+    const QByteArray ballast(static_cast<qsizetype>(options.ballastMb) * 1024 * 1024, 'x');
+    s_sink += static_cast<quint64>(ballast.at(ballast.size() / 2));
+
+    BenchSamples helper;
+    BenchSamples qprocess;
+    for (int i = 0; i < options.spawnIterations; ++i) {
+        helper.add(spawnChild());
+        qprocess.add(spawnQProcess());
+    }
+
+    const SpawnHelper *spawnHelper = SpawnHelper::instance();
+    QJsonObject json;
+    json.insert(QStringLiteral("ballastMb"), options.ballastMb);
+    json.insert(QStringLiteral("helperAvailable"), spawnHelper && spawnHelper->isAvailable());
+    json.insert(QStringLiteral("childProcess"), helper.toJson());
+    json.insert(QStringLiteral("qprocess"), qprocess.toJson());
+    return json;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QJsonObject>
+
+// Focused measurements of single hot paths: parsing, theme state changes
+// and child process spawning. Runs in its own process (see bench_main.cpp)
+// so the spawn helper is owned by the main thread rather than the engine.
+class MicroBench {
+public:
+    struct Options {
+        int parseIterations = 100000;  // status parses
+        int settingsEntries = 10000;   // split tunnel entries in the settings text
+        int settingsIterations = 20;
+        int polishIterations = 2000;
+        int spawnIterations = 50;
+        int ballastMb = 512;           // heap the GUI process carries while spawning
+    };
+
+    static QJsonObject run(const Options &options);
+
+private:
+    static QJsonObject statusParse(const Options &options);
+    static QJsonObject settingsParse(const Options &options);
+    static QJsonObject themePolish(const Options &options);
+    static QJsonObject spawn(const Options &options);
+};
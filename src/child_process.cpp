@@ -0,0 +1,124 @@
+#include "child_process.h"
+
+#include <QProcess>
+#include <QThread>
+
+#include <csignal>
+#include <utility>
+
+#include "perf_counters.h"
+#include "spawn_helper.h"
+
+ChildProcess::ChildProcess(QObject *parent)
+    : QObject(parent), m_helper(nullptr), m_process(nullptr), m_id(0), m_running(false) {}
+
+void ChildProcess::start(const QString &program, const QStringList &args) {
+    PerfCounters::noteSpawn();
+    SpawnHelper *helper = SpawnHelper::instance();
+    if (helper && helper->isAvailable() && helper->thread() == QThread::currentThread()) {
+        startWithHelper(helper, program, args);
+    } else {
+        startWithProcess(program, args);
+    }
+}
+
+void ChildProcess::startWithHelper(SpawnHelper *helper, const QString &program, const QStringList &args) {
+    m_helper = helper;
+    m_running = true;
+
+    connect(helper, &SpawnHelper::output, this, [this](quint32 id, int channel, const QByteArray &data) {
+        if (id != m_id) {
+            return;
+        }
+        if (channel == SpawnHelper::StandardOutput) {
+            m_stdout += data;
+            emit readyReadStandardOutput();
+        } else {
+            m_stderr += data;
+        }
+    });
+    connect(helper, &SpawnHelper::exited, this, [this](quint32 id, int exitCode, bool crashed) {
+        if (id != m_id || !m_running) {
+            return;
+        }
+        m_running = false;
+        disconnect(m_helper, nullptr, this, nullptr);
+        emit finished(exitCode, crashed);
+    });
+    connect(helper, &SpawnHelper::failed, this, [this](quint32 id, const QString &error) {
+        if (id != m_id || !m_running) {
+            return;
+        }
+        m_running = false;
+        m_error = error;
+        disconnect(m_helper, nullptr, this, nullptr);
+        emit failedToStart();
+    });
+
+    m_id = helper->spawn(program, args);
+}
+
+void ChildProcess::startWithProcess(const QString &program, const QStringList &args) {
+    m_process = new QProcess(this);
+    m_running = true;
+
+    connect(m_process, &QProcess::readyReadStandardOutput, this, &ChildProcess::readyReadStandardOutput);
+    connect(m_process, &QProcess::finished, this, [this](int exitCode, QProcess::ExitStatus status) {
+        m_running = false;
+        emit finished(exitCode, status == QProcess::CrashExit);
+    });
+    connect(m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart) {
+            return;
+        }
+        m_running = false;
+        m_error = m_process->errorString();
+        emit failedToStart();
+    });
+
+    m_process->start(program, args);
+}
+
+void ChildProcess::terminate() {
+    if (m_process) {
+        m_process->terminate();
+    } else {
+        sendSignal(SIGTERM);
+    }
+}
+
+void ChildProcess::kill() {
+    if (m_process) {
+        m_process->kill();
+    } else {
+        sendSignal(SIGKILL);
+    }
+}
+
+void ChildProcess::sendSignal(int signal) {
+    if (m_helper && m_running) {
+        m_helper->sendSignal(m_id, signal);
+    }
+}
+
+bool ChildProcess::isRunning() const {
+    return m_running;
+}
+
+QString ChildProcess::errorString() const {
+    return m_error;
+}
+
+QByteArray ChildProcess::readAllStandardOutput() {
+    if (m_process) {
+        return m_process->readAllStandardOutput();
+    }
+    return std::exchange(m_stdout, QByteArray());
+}
+
+QByteArray ChildProcess::readAllStandardError() {
+    if (m_process) {
+        return m_process->readAllStandardError();
+    }
+    return std::exchange(m_stderr, QByteArray());
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QProcess;
+class SpawnHelper;
+
+// One child process, launched through the spawn helper when it is running
+// and usable from this thread, and through QProcess otherwise.
+class ChildProcess : public QObject {
+    Q_OBJECT
+
+public:
+    explicit ChildProcess(QObject *parent = nullptr);
+
+    void start(const QString &program, const QStringList &args);
+    void terminate();
+    void kill();
+
+    bool isRunning() const;
+    QString errorString() const;
+    QByteArray readAllStandardOutput();
+    QByteArray readAllStandardError();
+
+signals:
+    void readyReadStandardOutput();
+    void finished(int exitCode, bool crashed);
+    void failedToStart();
+
+private:
+    void startWithHelper(SpawnHelper *helper, const QString &program, const QStringList &args);
+    void startWithProcess(const QString &program, const QStringList &args);
+    void sendSignal(int signal);
+
+    SpawnHelper *m_helper;
+    QProcess *m_process;
+    quint32 m_id;
+    bool m_running;
+    QString m_error;
+    QByteArray m_stdout;
+    QByteArray m_stderr;
+};
@@ -0,0 +1,406 @@
+#include "connection_log.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QSettings>
+#include <QStringList>
+#include <QTimer>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tray_app.h"
+
+namespace {
+
+struct FileHeader {
+    char magic[4];
+    quint32 version;
+    quint32 recordSize;
+    quint32 reserved;
+};
+
+constexpr char kMagic[4] = {'W', 'G', 'C', 'L'};
+constexpr quint32 kVersion = 1;
+constexpr qint64 kDefaultMaxBytes = 4 * 1024 * 1024;
+constexpr int kDefaultGenerations = 4;
+constexpr int kDefaultHeartbeatMs = 5 * 60 * 1000;
+constexpr qint64 kDayMs = 24 * 60 * 60 * 1000;
+// A connect, disconnect or mode change explains the next transition only if
+// it comes within this window
+constexpr qint64 kUserActionWindowMs = 30000;
+
+static_assert(sizeof(FileHeader) == 16, "log header layout is part of the file format");
+static_assert(sizeof(ConnectionLog::Record) == 128, "record layout is part of the file format");
+
+bool isValidHeader(const FileHeader &header) {
+    return std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion &&
+           header.recordSize == sizeof(ConnectionLog::Record);
+}
+
+// NUL-pads value into field, cutting at a UTF-8 character boundary
+template <size_t N>
+void copyTruncated(char (&field)[N], const QByteArray &value) {
+    size_t size = std::min(static_cast<size_t>(value.size()), N);
+    while (size < static_cast<size_t>(value.size()) && size > 0 &&
+           (static_cast<unsigned char>(value.at(static_cast<qsizetype>(size))) & 0xC0) == 0x80) {
+        --size;
+    }
+    std::memcpy(field, value.constData(), size);
+    std::memset(field + size, 0, N - size);
+}
+
+template <size_t N>
+QByteArray fieldBytes(const char (&field)[N]) {
+    return QByteArray(field, static_cast<qsizetype>(::strnlen(field, N)));
+}
+
+void addOverlap(ConnectionLog::Period &period, qint64 from, qint64 to, bool connected) {
+    const qint64 start = qMax(from, period.startMs);
+    const qint64 end = qMin(to, period.endMs);
+    if (end > start) {
+        period.observedMs += end - start;
+        if (connected) {
+            period.connectedMs += end - start;
+        }
+    }
+}
+
+} // namespace
+
+double ConnectionLog::Period::uptime() const {
+    return observedMs > 0 ? static_cast<double>(connectedMs) / static_cast<double>(observedMs) : -1.0;
+}
+
+ConnectionLog::ConnectionLog(TrayApp *tray)
+    : QObject(tray),
+      m_tray(tray),
+      m_heartbeat(new QTimer(this)),
+      m_fd(-1),
+      m_size(0),
+      m_maxBytes(kDefaultMaxBytes),
+      m_lastState(StatusSnapshot::State::Unknown),
+      m_userActionMs(-1) {
+    connect(m_tray, &TrayApp::stateChanged, this, &ConnectionLog::onStateChanged);
+    connect(m_heartbeat, &QTimer::timeout, this, &ConnectionLog::onHeartbeat);
+}
+
+ConnectionLog::~ConnectionLog() {
+    if (m_fd < 0) {
+        return;
+    }
+    append(StatusSnapshot::State::Unknown, Stopped);
+    ::close(m_fd);
+}
+
+QString ConnectionLog::directory() {
+    QString base = qEnvironmentVariable("XDG_STATE_HOME");
+    if (base.isEmpty()) {
+        base = QDir::homePath() + QStringLiteral("/.local/state");
+    }
+    return base + QStringLiteral("/warp-gui");
+}
+
+QString ConnectionLog::path() {
+    return directory() + QStringLiteral("/connections.log");
+}
+
+int ConnectionLog::generations() {
+    QSettings settings(QStringLiteral("warp-gui"), QStringLiteral("warp-gui"));
+    return qBound(1, settings.value(QStringLiteral("connectionLog/generations"), kDefaultGenerations).toInt(), 99);
+}
+
+bool ConnectionLog::open() {
+    if (m_fd >= 0) {
+        return true;
+    }
+
+    QSettings settings(QStringLiteral("warp-gui"), QStringLiteral("warp-gui"));
+    // Room for the header and at least a few records
+    m_maxBytes = qMax<qint64>(settings.value(QStringLiteral("connectionLog/maxBytes"), kDefaultMaxBytes).toLongLong(),
+                              sizeof(FileHeader) + 16 * sizeof(Record));
+
+    if (!QDir().mkpath(directory()) || !openFile()) {
+        qWarning() << "Connection log disabled; cannot write" << path();
+        return false;
+    }
+
+    // Whatever state the previous run last logged ended when it stopped
+    append(StatusSnapshot::State::Unknown, Started);
+    onStateChanged();
+
+    const int heartbeatMs = settings.value(QStringLiteral("connectionLog/heartbeatMs"), kDefaultHeartbeatMs).toInt();
+    if (heartbeatMs > 0) {
+        m_heartbeat->start(qMax(1000, heartbeatMs));
+    }
+    return true;
+}
+
+bool ConnectionLog::openFile() {
+    const QByteArray file = QFile::encodeName(path());
+    m_fd = ::open(file.constData(), O_RDWR | O_APPEND | O_CREAT | O_CLOEXEC, 0600);
+    if (m_fd < 0) {
+        qWarning() << "Could not open" << path() << ":" << std::strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (::fstat(m_fd, &info) != 0) {
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    m_size = info.st_size;
+
+    if (m_size >= static_cast<qint64>(sizeof(FileHeader))) {
+        FileHeader header;
+        if (::pread(m_fd, &header, sizeof(header), 0) != sizeof(header) || !isValidHeader(header)) {
+            // Not ours, or an older format: keep it out of the way and start over
+            qWarning() << "Replacing unreadable connection log" << path();
+            rotate();
+            return m_fd >= 0;
+        }
+        // Drop a record cut short by a crash
+        const qint64 partial = (m_size - static_cast<qint64>(sizeof(FileHeader))) % static_cast<qint64>(sizeof(Record));
+        if (partial != 0 && ::ftruncate(m_fd, m_size - partial) == 0) {
+            m_size -= partial;
+        }
+        return true;
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.recordSize = sizeof(Record);
+    if (::ftruncate(m_fd, 0) != 0 || ::write(m_fd, &header, sizeof(header)) != sizeof(header)) {
+        qWarning() << "Could not initialize" << path() << ":" << std::strerror(errno);
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    m_size = sizeof(header);
+    return true;
+}
+
+void ConnectionLog::rotate() {
+    ::close(m_fd);
+    m_fd = -1;
+
+    // connections.log.N falls off the end, every other file moves up one
+    const QString current = path();
+    const int keep = generations();
+    QFile::remove(current + QStringLiteral(".%1").arg(keep));
+    for (int i = keep - 1; i >= 1; --i) {
+        QFile::rename(current + QStringLiteral(".%1").arg(i), current + QStringLiteral(".%1").arg(i + 1));
+    }
+    QFile::rename(current, current + QStringLiteral(".1"));
+    openFile();
+}
+
+void ConnectionLog::noteUserAction() {
+    m_userActionMs = QDateTime::currentMSecsSinceEpoch();
+}
+
+void ConnectionLog::onStateChanged() {
+    if (m_fd < 0) {
+        return;
+    }
+
+    // Only transitions are logged, plus the colo once it is known
+    const StatusSnapshot::State state = m_tray->state();
+    const QByteArray colo = state == StatusSnapshot::State::Connected ? m_tray->colo().toUtf8() : QByteArray();
+    if (state == m_lastState && colo == m_lastColo) {
+        return;
+    }
+
+    quint8 flags = 0;
+    if (state != m_lastState && m_userActionMs >= 0) {
+        if (QDateTime::currentMSecsSinceEpoch() - m_userActionMs <= kUserActionWindowMs) {
+            flags |= UserInitiated;
+        }
+        m_userActionMs = -1;
+    }
+    append(state, flags);
+}
+
+void ConnectionLog::onHeartbeat() {
+    if (m_fd >= 0) {
+        append(m_lastState, Heartbeat);
+    }
+}
+
+void ConnectionLog::append(StatusSnapshot::State state, quint8 flags) {
+    if (m_size + static_cast<qint64>(sizeof(Record)) > m_maxBytes) {
+        rotate();
+        if (m_fd < 0) {
+            return;
+        }
+    }
+
+    // Markers and heartbeats carry no state details
+    const bool marker = flags & (Started | Stopped | Heartbeat);
+    Record record{};
+    record.timeMs = QDateTime::currentMSecsSinceEpoch();
+    record.state = static_cast<quint8>(state);
+    record.flags = flags | (m_tray->isZeroTrust() ? ZeroTrust : 0);
+    if (!marker) {
+        copyTruncated(record.colo, state == StatusSnapshot::State::Connected ? m_tray->colo().toUtf8() : QByteArray());
+        copyTruncated(record.mode, m_tray->mode().toUtf8());
+        copyTruncated(record.reason, m_tray->statusReason().toUtf8());
+    }
+
+    // One write per record; O_APPEND keeps it in one piece
+    ssize_t written;
+    do {
+        written = ::write(m_fd, &record, sizeof(record));
+    } while (written < 0 && errno == EINTR);
+    if (written != static_cast<ssize_t>(sizeof(record))) {
+        qWarning() << "Could not append to" << path() << ":" << std::strerror(errno);
+        return;
+    }
+    m_size += written;
+
+    if (flags & Heartbeat) {
+        return;
+    }
+    m_lastState = state;
+    m_lastColo = fieldBytes(record.colo);
+}
+
+ConnectionLog::Analysis ConnectionLog::analyze(qint64 nowMs, int days, int weeks, int reasons) {
+    Analysis analysis;
+
+    const QDate today = QDateTime::fromMSecsSinceEpoch(nowMs).date();
+    for (int i = 0; i < days; ++i) {
+        const QDate day = today.addDays(-i);
+        Period period;
+        period.startMs = day.startOfDay().toMSecsSinceEpoch();
+        period.endMs = i == 0 ? nowMs : day.addDays(1).startOfDay().toMSecsSinceEpoch();
+        analysis.days.append(period);
+    }
+    for (int i = 0; i < weeks; ++i) {
+        Period period;
+        period.endMs = nowMs - i * 7 * kDayMs;
+        period.startMs = period.endMs - 7 * kDayMs;
+        analysis.weeks.append(period);
+    }
+    analysis.total.endMs = nowMs;
+
+    // Every interval between two records is credited to the periods it
+    // overlaps, in one pass over both files
+    QHash<QByteArray, int> reasonCounts;
+    quint8 state = static_cast<quint8>(StatusSnapshot::State::Unknown);
+    qint64 since = -1;
+    constexpr quint8 kConnected = static_cast<quint8>(StatusSnapshot::State::Connected);
+    constexpr quint8 kUnknown = static_cast<quint8>(StatusSnapshot::State::Unknown);
+
+    const auto account = [&analysis](qint64 from, qint64 to, quint8 observed) {
+        if (from < 0 || to <= from || observed == kUnknown) {
+            return;
+        }
+        const bool connected = observed == kConnected;
+        addOverlap(analysis.total, from, to, connected);
+        for (Period &period : analysis.days) {
+            addOverlap(period, from, to, connected);
+        }
+        for (Period &period : analysis.weeks) {
+            addOverlap(period, from, to, connected);
+        }
+    };
+    const auto countDrop = [&analysis](qint64 at) {
+        ++analysis.total.drops;
+        for (QList<Period> *periods : {&analysis.days, &analysis.weeks}) {
+            for (Period &period : *periods) {
+                if (at >= period.startMs && at < period.endMs) {
+                    ++period.drops;
+                }
+            }
+        }
+    };
+
+    // Oldest first, so the records come in time order
+    const QString current = path();
+    QStringList names;
+    for (int i = generations(); i >= 1; --i) {
+        names.append(current + QStringLiteral(".%1").arg(i));
+    }
+    names.append(current);
+
+    for (const QString &name : std::as_const(names)) {
+        QFile file(name);
+        if (!file.open(QIODevice::ReadOnly) || file.size() < static_cast<qint64>(sizeof(FileHeader))) {
+            continue;
+        }
+        const uchar *data = file.map(0, file.size());
+        if (!data) {
+            continue;
+        }
+        FileHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        if (!isValidHeader(header)) {
+            continue;
+        }
+
+        const qint64 count = (file.size() - static_cast<qint64>(sizeof(FileHeader))) / static_cast<qint64>(sizeof(Record));
+        const auto *records = reinterpret_cast<const Record *>(data + sizeof(FileHeader));
+        for (qint64 i = 0; i < count; ++i) {
+            const Record &record = records[i];
+            if (analysis.firstMs < 0) {
+                analysis.firstMs = record.timeMs;
+            }
+
+            if (record.flags & Heartbeat) {
+                // The state held at least until here
+                account(since, record.timeMs, state);
+                since = record.timeMs;
+                continue;
+            }
+            ++analysis.records;
+
+            // A start without a stop before it follows a crash, a power loss
+            // or a kill; the state is only known up to the last record or
+            // heartbeat, so the gap is not counted
+            if (!(record.flags & Started)) {
+                account(since, record.timeMs, state);
+            }
+
+            if (state == kConnected && record.state != kConnected && record.state != kUnknown) {
+                QByteArray reason = fieldBytes(record.reason);
+                ++reasonCounts[reason.isEmpty() ? QByteArrayLiteral("No reason given") : reason];
+                if (!(record.flags & UserInitiated)) {
+                    countDrop(record.timeMs);
+                }
+            }
+
+            state = record.state;
+            since = record.timeMs;
+        }
+    }
+
+    // The last state lasts until now; after a clean stop it is Unknown
+    account(since, nowMs, state);
+    analysis.total.startMs = analysis.firstMs;
+
+    if (analysis.total.drops > 0) {
+        analysis.mtbfMs = analysis.total.connectedMs / analysis.total.drops;
+    }
+
+    for (auto it = reasonCounts.cbegin(); it != reasonCounts.cend(); ++it) {
+        analysis.reasons.append(ReasonCount{QString::fromUtf8(it.key()), it.value()});
+    }
+    std::sort(analysis.reasons.begin(), analysis.reasons.end(), [](const ReasonCount &a, const ReasonCount &b) {
+        return a.count != b.count ? a.count > b.count : a.reason < b.reason;
+    });
+    if (analysis.reasons.size() > reasons) {
+        analysis.reasons.resize(reasons);
+    }
+    return analysis;
+}
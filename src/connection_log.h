@@ -0,0 +1,103 @@
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include "status_snapshot.h"
+
+class QTimer;
+class TrayApp;
+
+// Append-only record of connection state transitions, kept in
+// $XDG_STATE_HOME/warp-gui/connections.log. Each transition is one
+// fixed-size binary record, so the whole history can be mapped and scanned
+// in a single pass. The log rotates once it reaches connectionLog/maxBytes
+// (4 MiB by default); connectionLog/generations older files are kept as
+// connections.log.1 (newest) to connections.log.N. While running, a
+// heartbeat record every connectionLog/heartbeatMs bounds how much of a
+// crash or power loss can be counted as time in the last state.
+class ConnectionLog : public QObject {
+    Q_OBJECT
+
+public:
+    enum Flag : quint8 {
+        UserInitiated = 0x01, // follows a connect, disconnect or mode change from warp-gui
+        ZeroTrust = 0x02,
+        Started = 0x04, // warp-gui started; nothing known before this
+        Stopped = 0x08, // warp-gui exited cleanly
+        Heartbeat = 0x10, // still running, state unchanged
+    };
+
+    struct Record {
+        qint64 timeMs;  // milliseconds since the Unix epoch
+        quint8 state;   // StatusSnapshot::State
+        quint8 flags;   // Flag
+        quint8 reserved[2];
+        char colo[4];   // not NUL-terminated when all four are used
+        char mode[16];  // NUL-padded, truncated to fit
+        char reason[96]; // NUL-padded, truncated to fit
+    };
+
+    struct Period {
+        qint64 startMs = 0;
+        qint64 endMs = 0;
+        qint64 observedMs = 0;  // time warp-gui knew the state
+        qint64 connectedMs = 0;
+        int drops = 0;          // lost connections, not counting user disconnects
+
+        // Fraction of the observed time spent connected, or -1 if none
+        double uptime() const;
+    };
+
+    struct ReasonCount {
+        QString reason;
+        int count = 0;
+    };
+
+    struct Analysis {
+        QList<Period> days;  // calendar days, today first
+        QList<Period> weeks; // rolling seven-day windows, most recent first
+        Period total;        // the whole history
+        qint64 mtbfMs = -1;  // connected time per drop, -1 without drops
+        QList<ReasonCount> reasons; // most common first
+        qint64 records = 0;  // transitions and markers, not heartbeats
+        qint64 firstMs = -1;
+    };
+
+    explicit ConnectionLog(TrayApp *tray);
+    // Records that warp-gui stopped, so the gap is not counted as uptime
+    ~ConnectionLog() override;
+
+    // Opens or creates the log and records the start
+    bool open();
+
+    // The next transition was asked for by the user rather than the network
+    void noteUserAction();
+
+    static QString directory();
+    static QString path();
+
+    static int generations();
+
+    // Maps the current and the rotated logs and aggregates them in one pass
+    static Analysis analyze(qint64 nowMs, int days = 7, int weeks = 4, int reasons = 5);
+
+private:
+    void onStateChanged();
+    void onHeartbeat();
+    void append(StatusSnapshot::State state, quint8 flags);
+    bool openFile();
+    void rotate();
+
+    TrayApp *m_tray;
+    QTimer *m_heartbeat;
+    int m_fd;
+    qint64 m_size;
+    qint64 m_maxBytes;
+
+    StatusSnapshot::State m_lastState;
+    QByteArray m_lastColo;
+    qint64 m_userActionMs; // -1 when no user action is pending
+};
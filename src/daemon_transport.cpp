@@ -0,0 +1,183 @@
+#include "daemon_transport.h"
+
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalSocket>
+#include <QSettings>
+#include <QTimer>
+
+#include <limits>
+#include <utility>
+
+namespace {
+constexpr int kReconnectIntervalMs = 10000;
+constexpr int kDefaultReplyTimeoutMs = 5000;
+} // namespace
+
+DaemonTransport::DaemonTransport(const QString &socketPath, QObject *parent)
+    : WarpTransport(parent),
+      m_socket(new QLocalSocket(this)),
+      m_reconnect(new QTimer(this)),
+      m_deadline(new QTimer(this)),
+      m_socketPath(socketPath),
+      m_replyTimeoutMs(kDefaultReplyTimeoutMs) {
+    QSettings settings(QStringLiteral("warp-gui"), QStringLiteral("warp-gui"));
+    setReplyTimeout(settings.value(QStringLiteral("daemon/replyTimeoutMs"), kDefaultReplyTimeoutMs).toInt());
+    m_clock.start();
+
+    m_deadline->setSingleShot(true);
+    connect(m_deadline, &QTimer::timeout, this, &DaemonTransport::onDeadline);
+
+    m_reconnect->setSingleShot(true);
+    m_reconnect->setInterval(kReconnectIntervalMs);
+    connect(m_reconnect, &QTimer::timeout, this, &DaemonTransport::connectToDaemon);
+
+    connect(m_socket, &QLocalSocket::readyRead, this, &DaemonTransport::onReadyRead);
+    connect(m_socket, &QLocalSocket::disconnected, this, &DaemonTransport::onDisconnected);
+    connect(m_socket, &QLocalSocket::errorOccurred, this, [this](QLocalSocket::LocalSocketError) {
+        if (m_socket->state() != QLocalSocket::ConnectedState) {
+            onDisconnected();
+        }
+    });
+
+    connectToDaemon();
+}
+
+QString DaemonTransport::configuredSocketPath() {
+    const QString fromEnv = qEnvironmentVariable("WARP_GUI_DAEMON_SOCKET");
+    if (!fromEnv.isEmpty()) {
+        return fromEnv;
+    }
+
+    QSettings settings(QStringLiteral("warp-gui"), QStringLiteral("warp-gui"));
+    return settings.value(QStringLiteral("daemon/socket")).toString();
+}
+
+void DaemonTransport::setReplyTimeout(int ms) {
+    m_replyTimeoutMs = qMax(1, ms);
+}
+
+int DaemonTransport::replyTimeout() const {
+    return m_replyTimeoutMs;
+}
+
+QString DaemonTransport::name() const {
+    return QStringLiteral("daemon");
+}
+
+bool DaemonTransport::isAvailable() const {
+    return m_socket->state() == QLocalSocket::ConnectedState;
+}
+
+void DaemonTransport::submit(quint64 ticket, const QStringList &args) {
+    if (!isAvailable()) {
+        emit dropped(ticket);
+        return;
+    }
+
+    QJsonObject request;
+    request.insert(QStringLiteral("id"), static_cast<qint64>(ticket));
+    request.insert(QStringLiteral("args"), QJsonArray::fromStringList(args));
+
+    m_inFlight.insert(ticket, m_clock.elapsed() + m_replyTimeoutMs);
+    m_socket->write(QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n');
+    if (!m_deadline->isActive()) {
+        scheduleDeadline();
+    }
+}
+
+void DaemonTransport::abort(quint64 ticket) {
+    // The daemon owns the work; forgetting the ticket discards its late reply
+    m_inFlight.remove(ticket);
+}
+
+void DaemonTransport::scheduleDeadline() {
+    if (m_inFlight.isEmpty()) {
+        m_deadline->stop();
+        return;
+    }
+    qint64 earliest = std::numeric_limits<qint64>::max();
+    for (qint64 deadline : std::as_const(m_inFlight)) {
+        earliest = qMin(earliest, deadline);
+    }
+    m_deadline->start(static_cast<int>(qMax<qint64>(0, earliest - m_clock.elapsed())));
+}
+
+void DaemonTransport::onDeadline() {
+    const qint64 now = m_clock.elapsed();
+    bool expired = false;
+    for (qint64 deadline : std::as_const(m_inFlight)) {
+        expired |= deadline <= now;
+    }
+    if (!expired) {
+        scheduleDeadline();
+        return;
+    }
+
+    // Everything still outstanding is handed back in onDisconnected
+    qWarning() << "Daemon did not reply within" << m_replyTimeoutMs << "ms; disconnecting";
+    m_socket->abort();
+    onDisconnected();
+}
+
+void DaemonTransport::connectToDaemon() {
+    if (m_socketPath.isEmpty() || m_socket->state() != QLocalSocket::UnconnectedState) {
+        return;
+    }
+    m_socket->connectToServer(m_socketPath);
+}
+
+void DaemonTransport::onReadyRead() {
+    m_buffer += m_socket->readAll();
+
+    qsizetype newline;
+    while ((newline = m_buffer.indexOf('\n')) >= 0) {
+        const QByteArray line = m_buffer.left(newline);
+        m_buffer.remove(0, newline + 1);
+        if (!line.trimmed().isEmpty()) {
+            handleReply(line);
+        }
+    }
+}
+
+void DaemonTransport::handleReply(const QByteArray &line) {
+    const auto doc = QJsonDocument::fromJson(line);
+    if (!doc.isObject()) {
+        // Without an id there is no telling which request it answers, and
+        // the stream may be out of step; start over on a fresh connection
+        qWarning() << "Malformed reply from daemon, disconnecting:" << line.left(80);
+        m_socket->abort();
+        onDisconnected();
+        return;
+    }
+
+    const QJsonObject obj = doc.object();
+    const quint64 ticket = static_cast<quint64>(obj.value(QStringLiteral("id")).toInteger(-1));
+    if (!m_inFlight.remove(ticket)) {
+        return;
+    }
+
+    WarpResult result;
+    result.exitCode = obj.value(QStringLiteral("exitCode")).toInt(-1);
+    result.stdoutData = obj.value(QStringLiteral("stdout")).toString().toUtf8();
+    result.stderrData = obj.value(QStringLiteral("stderr")).toString().toUtf8();
+    emit completed(ticket, result);
+}
+
+void DaemonTransport::onDisconnected() {
+    m_buffer.clear();
+
+    m_deadline->stop();
+
+    // Hand outstanding requests back so they can run through another transport
+    const QHash<quint64, qint64> lost = std::exchange(m_inFlight, {});
+    for (auto it = lost.cbegin(); it != lost.cend(); ++it) {
+        emit dropped(it.key());
+    }
+
+    if (!m_socketPath.isEmpty() && !m_reconnect->isActive()) {
+        m_reconnect->start();
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+
+#include "warp_transport.h"
+
+class QLocalSocket;
+class QTimer;
+
+// Keeps one long-lived connection to a warp-svc compatible socket and sends
+// queries over it instead of spawning warp-cli for each one.
+//
+// Framing is one JSON object per line in both directions:
+//   request:  {"id": 7, "args": ["--accept-tos", "-j", "status"]}
+//   response: {"id": 7, "exitCode": 0, "stdout": "...", "stderr": "..."}
+//
+// A request that gets no reply within the reply timeout (daemon/replyTimeoutMs,
+// 5 s by default) is dropped, and so is the connection: a daemon that stops
+// answering is treated like one that went away, and queries run as processes
+// until it can be reached again.
+class DaemonTransport : public WarpTransport {
+    Q_OBJECT
+
+public:
+    explicit DaemonTransport(const QString &socketPath, QObject *parent = nullptr);
+
+    // Socket path from $WARP_GUI_DAEMON_SOCKET or the "daemon/socket" setting.
+    // Empty when the daemon transport is not configured.
+    static QString configuredSocketPath();
+
+    void setReplyTimeout(int ms);
+    int replyTimeout() const;
+
+    QString name() const override;
+    bool isAvailable() const override;
+    void submit(quint64 ticket, const QStringList &args) override;
+    void abort(quint64 ticket) override;
+
+private:
+    void connectToDaemon();
+    void onReadyRead();
+    void onDisconnected();
+    void handleReply(const QByteArray &line);
+    void scheduleDeadline();
+    void onDeadline();
+
+    QLocalSocket *m_socket;
+    QTimer *m_reconnect;
+    QTimer *m_deadline;
+    QElapsedTimer m_clock;
+    QString m_socketPath;
+    QByteArray m_buffer;
+    QHash<quint64, qint64> m_inFlight; // ticket -> reply deadline on m_clock
+    int m_replyTimeoutMs;
+};
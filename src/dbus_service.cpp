@@ -0,0 +1,153 @@
+#include "dbus_service.h"
+
+#include <QDBusConnection>
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QDebug>
+#include <QStringList>
+#include <QVariantMap>
+
+#include "tray_app.h"
+
+const QString DBusService::kServiceName = QStringLiteral("io.github.WarpGui");
+const QString DBusService::kObjectPath = QStringLiteral("/io/github/WarpGui");
+const QString DBusService::kInterfaceName = QStringLiteral("io.github.WarpGui");
+
+DBusService::DBusService(TrayApp *tray)
+    : QObject(tray),
+      m_tray(tray),
+      m_registered(false),
+      m_status(tray->statusText()),
+      m_reason(tray->statusReason()),
+      m_mode(modeName(tray->mode())),
+      m_busy(tray->isBusy()) {
+    connect(m_tray, &TrayApp::stateChanged, this, &DBusService::onStateChanged);
+}
+
+bool DBusService::registerService() {
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    if (!bus.isConnected()) {
+        qWarning() << "D-Bus session bus unavailable:" << bus.lastError().message();
+        return false;
+    }
+
+    if (!bus.registerObject(kObjectPath, this,
+                            QDBusConnection::ExportScriptableSlots | QDBusConnection::ExportScriptableSignals |
+                                QDBusConnection::ExportAllProperties)) {
+        qWarning() << "Could not export" << kObjectPath << "on the session bus";
+        return false;
+    }
+
+    // Leave the name to a running instance rather than queueing for it
+    if (!bus.registerService(kServiceName)) {
+        qWarning() << "Could not claim" << kServiceName << "on the session bus:" << bus.lastError().message();
+        bus.unregisterObject(kObjectPath);
+        return false;
+    }
+
+    m_registered = true;
+    return true;
+}
+
+QString DBusService::status() const {
+    return m_tray->statusText();
+}
+
+QString DBusService::reason() const {
+    return m_tray->statusReason();
+}
+
+QString DBusService::mode() const {
+    return modeName(m_tray->mode());
+}
+
+bool DBusService::isBusy() const {
+    return m_tray->isBusy();
+}
+
+QString DBusService::modeName(const QString &settingsMode) {
+    const QString mode = settingsMode.trimmed().toLower();
+    if (mode == QStringLiteral("dnsoverhttps")) {
+        return QStringLiteral("doh");
+    }
+    if (mode == QStringLiteral("warpwithdnsoverhttps") || mode == QStringLiteral("warpplusdoh")) {
+        return QStringLiteral("warp+doh");
+    }
+    if (mode == QStringLiteral("dnsovertls")) {
+        return QStringLiteral("dot");
+    }
+    if (mode == QStringLiteral("warpwithdnsovertls") || mode == QStringLiteral("warpplusdot")) {
+        return QStringLiteral("warp+dot");
+    }
+    // "WarpProxy on port 40000"
+    if (mode.startsWith(QStringLiteral("warpproxy"))) {
+        return QStringLiteral("proxy");
+    }
+    if (mode == QStringLiteral("tunnelonly")) {
+        return QStringLiteral("tunnel_only");
+    }
+    return mode;
+}
+
+void DBusService::Connect() {
+    m_tray->connectWarp();
+}
+
+void DBusService::Disconnect() {
+    m_tray->disconnectWarp();
+}
+
+void DBusService::SetMode(const QString &mode) {
+    static const QStringList modes{QStringLiteral("warp"),     QStringLiteral("doh"),
+                                   QStringLiteral("warp+doh"), QStringLiteral("dot"),
+                                   QStringLiteral("warp+dot"), QStringLiteral("proxy"),
+                                   QStringLiteral("tunnel_only")};
+    if (!modes.contains(mode)) {
+        if (calledFromDBus()) {
+            sendErrorReply(QDBusError::InvalidArgs, QStringLiteral("Unknown mode '%1', expected one of %2")
+                                                        .arg(mode, modes.join(QStringLiteral(", "))));
+        }
+        return;
+    }
+    m_tray->setMode(mode);
+}
+
+void DBusService::onStateChanged() {
+    // The tray re-applies its state far more often than it changes; only
+    // announce actual differences
+    QVariantMap changed;
+    const QString status = m_tray->statusText();
+    const QString reason = m_tray->statusReason();
+    const bool statusChanged = status != m_status || reason != m_reason;
+    if (status != m_status) {
+        m_status = status;
+        changed.insert(QStringLiteral("Status"), status);
+    }
+    if (reason != m_reason) {
+        m_reason = reason;
+        changed.insert(QStringLiteral("Reason"), reason);
+    }
+    const QString mode = modeName(m_tray->mode());
+    if (mode != m_mode) {
+        m_mode = mode;
+        changed.insert(QStringLiteral("Mode"), mode);
+    }
+    const bool busy = m_tray->isBusy();
+    if (busy != m_busy) {
+        m_busy = busy;
+        changed.insert(QStringLiteral("Busy"), busy);
+    }
+
+    if (!m_registered || changed.isEmpty()) {
+        return;
+    }
+
+    if (statusChanged) {
+        emit StatusChanged(m_status, m_reason);
+    }
+
+    QDBusMessage signal = QDBusMessage::createSignal(kObjectPath, QStringLiteral("org.freedesktop.DBus.Properties"),
+                                                     QStringLiteral("PropertiesChanged"));
+    signal << kInterfaceName << changed << QStringList();
+    QDBusConnection::sessionBus().send(signal);
+}
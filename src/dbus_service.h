@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QDBusContext>
+#include <QObject>
+#include <QString>
+
+class TrayApp;
+
+// Publishes the tray's cached WARP state and its actions on the session
+// bus, so scripts and panel widgets can watch one source instead of each
+// running warp-cli on a timer. Reads never spawn anything; they return what
+// the tray last saw.
+//
+//   service    io.github.WarpGui
+//   path       /io/github/WarpGui
+//   interface  io.github.WarpGui
+class DBusService : public QObject, protected QDBusContext {
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "io.github.WarpGui")
+    // Written out by hand so the mode vocabulary is documented to clients
+    Q_CLASSINFO("D-Bus Introspection",
+                "  <interface name=\"io.github.WarpGui\">\n"
+                "    <property name=\"Status\" type=\"s\" access=\"read\"/>\n"
+                "    <property name=\"Reason\" type=\"s\" access=\"read\"/>\n"
+                "    <property name=\"Mode\" type=\"s\" access=\"read\">\n"
+                "      <annotation name=\"org.gtk.GDBus.DocString\" value=\"One of warp, doh, warp+doh, dot, "
+                "warp+dot, proxy, tunnel_only, the same names "
+                "SetMode accepts\"/>\n"
+                "    </property>\n"
+                "    <property name=\"Busy\" type=\"b\" access=\"read\"/>\n"
+                "    <signal name=\"StatusChanged\">\n"
+                "      <arg name=\"status\" type=\"s\" direction=\"out\"/>\n"
+                "      <arg name=\"reason\" type=\"s\" direction=\"out\"/>\n"
+                "    </signal>\n"
+                "    <method name=\"Connect\"/>\n"
+                "    <method name=\"Disconnect\"/>\n"
+                "    <method name=\"SetMode\">\n"
+                "      <annotation name=\"org.gtk.GDBus.DocString\" value=\"mode is one of warp, doh, warp+doh, "
+                "dot, warp+dot, proxy, tunnel_only\"/>\n"
+                "      <arg name=\"mode\" type=\"s\" direction=\"in\"/>\n"
+                "    </method>\n"
+                "  </interface>\n")
+    Q_PROPERTY(QString Status READ status)
+    Q_PROPERTY(QString Reason READ reason)
+    Q_PROPERTY(QString Mode READ mode)
+    Q_PROPERTY(bool Busy READ isBusy)
+
+public:
+    static const QString kServiceName;
+    static const QString kObjectPath;
+    static const QString kInterfaceName;
+
+    explicit DBusService(TrayApp *tray);
+
+    // Claims the service name on the session bus. Fails when no bus is
+    // reachable or another instance already owns the name.
+    bool registerService();
+
+    QString status() const;
+    QString reason() const;
+    QString mode() const;
+    bool isBusy() const;
+
+    // Maps the mode warp-cli reports in its settings (lower-cased by the
+    // tray, e.g. "warpwithdnsoverhttps") to the name SetMode takes
+    // ("warp+doh"). Unknown modes pass through unchanged.
+    static QString modeName(const QString &settingsMode);
+
+public slots:
+    Q_SCRIPTABLE void Connect();
+    Q_SCRIPTABLE void Disconnect();
+    // One of warp, doh, warp+doh, dot, warp+dot, proxy, tunnel_only
+    Q_SCRIPTABLE void SetMode(const QString &mode);
+
+signals:
+    // Also announced through org.freedesktop.DBus.Properties.PropertiesChanged
+    Q_SCRIPTABLE void StatusChanged(const QString &status, const QString &reason);
+
+private:
+    void onStateChanged();
+
+    TrayApp *m_tray;
+    bool m_registered;
+
+    // Last values announced on the bus
+    QString m_status;
+    QString m_reason;
+    QString m_mode;
+    bool m_busy;
+};
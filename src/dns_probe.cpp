@@ -0,0 +1,334 @@
+#include "dns_probe.h"
+
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+using Bytes = std::vector<std::uint8_t>;
+
+constexpr std::uint16_t kFlagTruncated = 0x0200;
+constexpr std::uint16_t kFlagRecursionDesired = 0x0100;
+constexpr std::uint16_t kClassIn = 1;
+constexpr size_t kHeaderSize = 12;
+
+void put16(Bytes &out, std::uint16_t value) {
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+    out.push_back(static_cast<std::uint8_t>(value & 0xff));
+}
+
+std::uint16_t get16(const Bytes &in, size_t pos) {
+    return static_cast<std::uint16_t>((in[pos] << 8) | in[pos + 1]);
+}
+
+bool buildQuery(std::uint16_t id, const std::string &name, std::uint16_t type, Bytes &out) {
+    out.clear();
+    put16(out, id);
+    put16(out, kFlagRecursionDesired);
+    put16(out, 1); // QDCOUNT
+    put16(out, 0);
+    put16(out, 0);
+    put16(out, 0);
+
+    size_t start = 0;
+    while (start < name.size()) {
+        size_t dot = name.find('.', start);
+        if (dot == std::string::npos) {
+            dot = name.size();
+        }
+        const size_t length = dot - start;
+        if (length == 0 || length > 63) {
+            return false;
+        }
+        out.push_back(static_cast<std::uint8_t>(length));
+        out.insert(out.end(), name.begin() + static_cast<std::ptrdiff_t>(start),
+                   name.begin() + static_cast<std::ptrdiff_t>(dot));
+        start = dot + 1;
+    }
+    out.push_back(0);
+    put16(out, type);
+    put16(out, kClassIn);
+    return true;
+}
+
+// Advances pos past a possibly compressed name. Returns false on overrun.
+bool skipName(const Bytes &in, size_t &pos) {
+    while (pos < in.size()) {
+        const std::uint8_t length = in[pos];
+        if ((length & 0xc0) == 0xc0) {
+            pos += 2; // compression pointer ends the name
+            return pos <= in.size();
+        }
+        pos += 1 + length;
+        if (length == 0) {
+            return pos <= in.size();
+        }
+    }
+    return false;
+}
+
+struct Answer {
+    int rcode = -1;
+    bool truncated = false;
+    std::vector<std::string> addresses;
+};
+
+bool parseResponse(const Bytes &in, std::uint16_t id, std::uint16_t type, Answer &answer) {
+    if (in.size() < kHeaderSize || get16(in, 0) != id) {
+        return false;
+    }
+
+    const std::uint16_t flags = get16(in, 2);
+    answer.rcode = flags & 0x000f;
+    answer.truncated = (flags & kFlagTruncated) != 0;
+
+    const std::uint16_t questions = get16(in, 4);
+    const std::uint16_t answers = get16(in, 6);
+    size_t pos = kHeaderSize;
+
+    for (std::uint16_t i = 0; i < questions; ++i) {
+        if (!skipName(in, pos) || pos + 4 > in.size()) {
+            return false;
+        }
+        pos += 4;
+    }
+
+    for (std::uint16_t i = 0; i < answers; ++i) {
+        if (!skipName(in, pos) || pos + 10 > in.size()) {
+            return false;
+        }
+        const std::uint16_t rrType = get16(in, pos);
+        const std::uint16_t rrClass = get16(in, pos + 2);
+        const std::uint16_t length = get16(in, pos + 8);
+        pos += 10;
+        if (pos + length > in.size()) {
+            return false;
+        }
+
+        // CNAMEs and other records on the way to the address are skipped
+        if (rrClass == kClassIn && rrType == type) {
+            char text[INET6_ADDRSTRLEN] = {};
+            if (type == DnsProbe::A && length == 4) {
+                inet_ntop(AF_INET, &in[pos], text, sizeof(text));
+                answer.addresses.emplace_back(text);
+            } else if (type == DnsProbe::AAAA && length == 16) {
+                inet_ntop(AF_INET6, &in[pos], text, sizeof(text));
+                answer.addresses.emplace_back(text);
+            }
+        }
+        pos += length;
+    }
+    return true;
+}
+
+class Socket {
+public:
+    explicit Socket(int fd) : m_fd(fd) {}
+    ~Socket() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+    Socket(const Socket &) = delete;
+    Socket &operator=(const Socket &) = delete;
+
+    int fd() const { return m_fd; }
+
+private:
+    int m_fd;
+};
+
+struct Endpoint {
+    sockaddr_storage address{};
+    socklen_t length = 0;
+    int family = AF_UNSPEC;
+};
+
+bool makeEndpoint(const std::string &host, std::uint16_t port, Endpoint &endpoint) {
+    auto *v4 = reinterpret_cast<sockaddr_in *>(&endpoint.address);
+    if (inet_pton(AF_INET, host.c_str(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(port);
+        endpoint.length = sizeof(sockaddr_in);
+        endpoint.family = AF_INET;
+        return true;
+    }
+    auto *v6 = reinterpret_cast<sockaddr_in6 *>(&endpoint.address);
+    if (inet_pton(AF_INET6, host.c_str(), &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(port);
+        endpoint.length = sizeof(sockaddr_in6);
+        endpoint.family = AF_INET6;
+        return true;
+    }
+    return false;
+}
+
+// Waits for events on fd until the deadline. Returns false on timeout.
+bool waitFor(int fd, short events, const QElapsedTimer &clock, int timeoutMs) {
+    for (;;) {
+        const qint64 remaining = timeoutMs - clock.elapsed();
+        if (remaining <= 0) {
+            return false;
+        }
+        pollfd pfd{fd, events, 0};
+        const int ready = ::poll(&pfd, 1, static_cast<int>(remaining));
+        if (ready > 0) {
+            return true;
+        }
+        if (ready == 0 || errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+bool queryUdp(const Endpoint &endpoint, const Bytes &request, Bytes &response, const QElapsedTimer &clock,
+              int timeoutMs, std::string &error) {
+    Socket socket(::socket(endpoint.family, SOCK_DGRAM | SOCK_CLOEXEC, 0));
+    if (socket.fd() < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+    // connect() makes the kernel drop datagrams from any other source
+    if (::connect(socket.fd(), reinterpret_cast<const sockaddr *>(&endpoint.address), endpoint.length) != 0 ||
+        ::send(socket.fd(), request.data(), request.size(), 0) < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+    if (!waitFor(socket.fd(), POLLIN, clock, timeoutMs)) {
+        error = "timed out";
+        return false;
+    }
+    response.resize(4096);
+    const ssize_t n = ::recv(socket.fd(), response.data(), response.size(), 0);
+    if (n < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+    response.resize(static_cast<size_t>(n));
+    return true;
+}
+
+bool readExactly(int fd, std::uint8_t *data, size_t size, const QElapsedTimer &clock, int timeoutMs) {
+    while (size > 0) {
+        if (!waitFor(fd, POLLIN, clock, timeoutMs)) {
+            return false;
+        }
+        const ssize_t n = ::recv(fd, data, size, 0);
+        if (n <= 0) {
+            if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool queryTcp(const Endpoint &endpoint, const Bytes &request, Bytes &response, const QElapsedTimer &clock,
+              int timeoutMs, std::string &error) {
+    Socket socket(::socket(endpoint.family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0));
+    if (socket.fd() < 0) {
+        error = std::strerror(errno);
+        return false;
+    }
+    if (::connect(socket.fd(), reinterpret_cast<const sockaddr *>(&endpoint.address), endpoint.length) != 0 &&
+        errno != EINPROGRESS) {
+        error = std::strerror(errno);
+        return false;
+    }
+    if (!waitFor(socket.fd(), POLLOUT, clock, timeoutMs)) {
+        error = "timed out";
+        return false;
+    }
+    int connectError = 0;
+    socklen_t length = sizeof(connectError);
+    ::getsockopt(socket.fd(), SOL_SOCKET, SO_ERROR, &connectError, &length);
+    if (connectError != 0) {
+        error = std::strerror(connectError);
+        return false;
+    }
+
+    // TCP messages carry a two-byte length prefix
+    Bytes framed;
+    put16(framed, static_cast<std::uint16_t>(request.size()));
+    framed.insert(framed.end(), request.begin(), request.end());
+    if (::send(socket.fd(), framed.data(), framed.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(framed.size())) {
+        error = "short write";
+        return false;
+    }
+
+    std::uint8_t prefix[2];
+    if (!readExactly(socket.fd(), prefix, sizeof(prefix), clock, timeoutMs)) {
+        error = "timed out";
+        return false;
+    }
+    response.resize(static_cast<size_t>((prefix[0] << 8) | prefix[1]));
+    if (!readExactly(socket.fd(), response.data(), response.size(), clock, timeoutMs)) {
+        error = "timed out";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+DnsProbe::Result DnsProbe::query(const QString &server, const QString &name, RecordType type, int timeoutMs,
+                                 quint16 port) {
+    Result result;
+    QElapsedTimer clock;
+    clock.start();
+
+    Endpoint endpoint;
+    if (!makeEndpoint(server.toStdString(), port, endpoint)) {
+        result.error = QStringLiteral("Invalid resolver address %1").arg(server);
+        return result;
+    }
+
+    const auto id = static_cast<std::uint16_t>(QRandomGenerator::global()->bounded(0x10000));
+    Bytes request;
+    if (!buildQuery(id, name.toStdString(), type, request)) {
+        result.error = QStringLiteral("Invalid name %1").arg(name);
+        return result;
+    }
+
+    Bytes response;
+    Answer answer;
+    std::string error;
+    bool answered = queryUdp(endpoint, request, response, clock, timeoutMs, error) &&
+                    parseResponse(response, id, type, answer);
+    if (answered && answer.truncated) {
+        result.usedTcp = true;
+        answer = Answer();
+        answered = queryTcp(endpoint, request, response, clock, timeoutMs, error) &&
+                   parseResponse(response, id, type, answer);
+    }
+    result.latencyMs = clock.elapsed();
+
+    if (!answered) {
+        result.error = error.empty() ? QStringLiteral("Malformed response") : QString::fromStdString(error);
+        return result;
+    }
+
+    result.rcode = answer.rcode;
+    for (const std::string &address : answer.addresses) {
+        result.addresses.append(QString::fromStdString(address));
+    }
+    result.ok = answer.rcode == 0 && !result.addresses.isEmpty();
+    return result;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+// Sends one DNS query straight to a resolver and times it, without going
+// through the system resolver or spawning dig. Blocking; meant to run on a
+// probe worker thread.
+class DnsProbe {
+public:
+    struct Result {
+        bool ok = false;     // NOERROR with at least one address
+        int rcode = -1;      // DNS response code, -1 when no answer came back
+        bool usedTcp = false; // UDP reply was truncated and retried over TCP
+        QStringList addresses;
+        qint64 latencyMs = -1;
+        QString error;
+    };
+
+    enum RecordType : quint16 {
+        A = 1,
+        AAAA = 28,
+    };
+
+    static Result query(const QString &server, const QString &name, RecordType type = A, int timeoutMs = 2000,
+                        quint16 port = 53);
+};
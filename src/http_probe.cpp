@@ -0,0 +1,167 @@
+#include "http_probe.h"
+
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHostInfo>
+#include <QSslSocket>
+#include <QTimer>
+
+namespace {
+
+int remainingMs(const QElapsedTimer &clock, int timeoutMs) {
+    return static_cast<int>(qMax<qint64>(0, timeoutMs - clock.elapsed()));
+}
+
+// QHostInfo::fromName() has no timeout; wait for an asynchronous lookup
+// only as long as the probe's budget allows
+QHostInfo resolve(const QString &host, int timeoutMs, bool *timedOut) {
+    QEventLoop loop;
+    QHostInfo info;
+    bool done = false;
+    const int id = QHostInfo::lookupHost(host, &loop, [&](const QHostInfo &found) {
+        info = found;
+        done = true;
+        loop.quit();
+    });
+    if (!done) {
+        QTimer::singleShot(timeoutMs, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+    *timedOut = !done;
+    if (!done) {
+        QHostInfo::abortHostLookup(id);
+    }
+    return info;
+}
+
+// Splits a raw response into status code and body. Returns false until the
+// header block is complete.
+bool parseResponse(const QByteArray &raw, int *statusCode, QByteArray *body) {
+    const qsizetype headerEnd = raw.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return false;
+    }
+
+    // "HTTP/1.1 200 OK"
+    const qsizetype firstSpace = raw.indexOf(' ');
+    if (firstSpace < 0 || firstSpace > headerEnd) {
+        return false;
+    }
+    bool ok = false;
+    *statusCode = raw.mid(firstSpace + 1, 3).toInt(&ok);
+    if (!ok) {
+        return false;
+    }
+    *body = raw.mid(headerEnd + 4);
+    return true;
+}
+
+} // namespace
+
+HttpProbe::Result HttpProbe::get(const QUrl &url, int timeoutMs) {
+    Result result;
+    QElapsedTimer clock;
+    clock.start();
+
+    const bool https = url.scheme() == QStringLiteral("https");
+    const QString host = url.host();
+    const quint16 port = static_cast<quint16>(url.port(https ? 443 : 80));
+
+    // Resolve separately so name lookup shows up as its own phase; it
+    // counts against the same deadline as everything else
+    bool dnsTimedOut = false;
+    const QHostInfo info = resolve(host, timeoutMs, &dnsTimedOut);
+    result.timing.dnsMs = clock.elapsed();
+    if (dnsTimedOut || info.error() != QHostInfo::NoError || info.addresses().isEmpty()) {
+        result.error = dnsTimedOut ? QStringLiteral("Timed out resolving %1").arg(host) : info.errorString();
+        result.timing.totalMs = clock.elapsed();
+        return result;
+    }
+
+    // Try each address in turn, e.g. IPv4 after an unreachable IPv6 one
+    QSslSocket socket;
+    qint64 mark = clock.elapsed();
+    bool connected = false;
+    for (const QHostAddress &address : info.addresses()) {
+        socket.connectToHost(address, port);
+        if (socket.waitForConnected(remainingMs(clock, timeoutMs))) {
+            connected = true;
+            break;
+        }
+        result.error = socket.errorString();
+        socket.abort();
+        if (remainingMs(clock, timeoutMs) == 0) {
+            break;
+        }
+    }
+    if (!connected) {
+        result.timing.totalMs = clock.elapsed();
+        return result;
+    }
+    result.error.clear();
+    result.timing.connectMs = clock.elapsed() - mark;
+
+    if (https) {
+        mark = clock.elapsed();
+        socket.setPeerVerifyName(host);
+        socket.startClientEncryption();
+        if (!socket.waitForEncrypted(remainingMs(clock, timeoutMs))) {
+            result.error = socket.errorString();
+            result.timing.totalMs = clock.elapsed();
+            return result;
+        }
+        result.timing.tlsMs = clock.elapsed() - mark;
+    }
+
+    // HTTP/1.0 keeps the body unchunked and the server closes when done
+    QByteArray path = url.path(QUrl::FullyEncoded).toUtf8();
+    if (path.isEmpty()) {
+        path = "/";
+    }
+    if (url.hasQuery()) {
+        path += '?' + url.query(QUrl::FullyEncoded).toUtf8();
+    }
+    const QByteArray request = "GET " + path + " HTTP/1.0\r\nHost: " + host.toUtf8() +
+                               "\r\nUser-Agent: warp-gui\r\nAccept: */*\r\nConnection: close\r\n\r\n";
+    mark = clock.elapsed();
+    socket.write(request);
+
+    QByteArray raw;
+    while (socket.waitForReadyRead(remainingMs(clock, timeoutMs))) {
+        if (raw.isEmpty()) {
+            result.timing.firstByteMs = clock.elapsed() - mark;
+        }
+        raw += socket.readAll();
+    }
+    raw += socket.readAll();
+    result.timing.totalMs = clock.elapsed();
+
+    if (socket.state() != QAbstractSocket::UnconnectedState && clock.elapsed() >= timeoutMs) {
+        result.error = QStringLiteral("Timed out");
+        return result;
+    }
+    if (!parseResponse(raw, &result.statusCode, &result.body)) {
+        result.error = raw.isEmpty() ? socket.errorString() : QStringLiteral("Malformed HTTP response");
+        return result;
+    }
+
+    result.ok = true;
+    return result;
+}
+
+QHash<QByteArray, QByteArray> HttpProbe::parseKeyValues(const QByteArray &body) {
+    QHash<QByteArray, QByteArray> fields;
+    qsizetype start = 0;
+    while (start < body.size()) {
+        qsizetype end = body.indexOf('\n', start);
+        if (end < 0) {
+            end = body.size();
+        }
+        const qsizetype equals = body.indexOf('=', start);
+        if (equals > start && equals < end) {
+            fields.insert(body.mid(start, equals - start).trimmed(), body.mid(equals + 1, end - equals - 1).trimmed());
+        }
+        start = end + 1;
+    }
+    return fields;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QUrl>
+
+// Minimal HTTP/1.0 GET over a plain or TLS socket, timed phase by phase.
+// Blocking; meant to run on a probe worker thread. The timeout covers the
+// whole request, name lookup included.
+class HttpProbe {
+public:
+    // Milliseconds spent in each phase, -1 for phases that did not happen
+    struct Timing {
+        qint64 dnsMs = -1;
+        qint64 connectMs = -1;
+        qint64 tlsMs = -1;
+        qint64 firstByteMs = -1; // from sending the request to the first response byte
+        qint64 totalMs = -1;
+    };
+
+    struct Result {
+        bool ok = false; // a complete HTTP response was received
+        int statusCode = -1;
+        QByteArray body;
+        Timing timing;
+        QString error;
+    };
+
+    static Result get(const QUrl &url, int timeoutMs = 3000);
+
+    // Parses a key=value per line body such as /cdn-cgi/trace
+    static QHash<QByteArray, QByteArray> parseKeyValues(const QByteArray &body);
+};
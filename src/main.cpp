@@ -1,13 +1,47 @@
 #include <QApplication>
+#include <QCoreApplication>
 
+#include "perf_counters.h"
+#include "quit_signals.h"
+#include "single_instance.h"
+#include "spawn_helper.h"
+#include "state_client.h"
+#include "theme.h"
+#include "trace.h"
 #include "tray_app.h"
 
 int main(int argc, char **argv) {
+    // --status and --watch only talk to the running instance; keep them free
+    // of widgets, Wayland and the spawn helper so they start in milliseconds
+    if (const std::optional<StateClient::Mode> mode = StateClient::modeFromArguments(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return StateClient::run(*mode);
+    }
+
+    // One instance per user; a second launch hands its command to the first.
+    // The lock is taken before the helper forks, which keeps a copy of it
+    // only until it notices this process is gone.
+    const SingleInstance::Command command = SingleInstance::commandFromArguments(argc, argv);
+    if (!SingleInstance::acquire()) {
+        QCoreApplication app(argc, argv);
+        return SingleInstance::forward(command);
+    }
+
+    // Fork the spawn helper while the process is still small and single-threaded
+    SpawnHelper::launch();
+
     QApplication app(argc, argv);
     app.setQuitOnLastWindowClosed(false);
+    Trace::configure();
+    Trace::installSignalHandler();
+    // Logout sends SIGTERM; quit normally so the tray's destructors run
+    QuitSignals::install();
+    PerfCounters::installStallMonitor();
+    Theme::install(app);
 
     TrayApp tray;
     tray.start();
+    tray.handleCommand(command);
 
     return app.exec();
 }
@@ -0,0 +1,242 @@
+#include "perf_counters.h"
+
+#include <QAbstractEventDispatcher>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <cmath>
+
+#include <unistd.h>
+
+namespace {
+
+std::array<PerfCounters::Histogram, static_cast<size_t>(PerfCounters::Series::Count)> s_histograms;
+
+std::atomic<quint64> s_spawns{0};
+std::atomic<quint64> s_cacheHits{0};
+std::atomic<quint64> s_cacheMisses{0};
+std::atomic<int> s_pollIntervalMs{-1};
+std::atomic<int> s_pollReason{0};
+std::atomic<quint64> s_stalls{0};
+std::atomic<qint64> s_longestStallUs{0};
+
+void raiseTo(std::atomic<qint64> &target, qint64 value) {
+    qint64 current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+int highestBit(quint64 value) {
+    int bit = -1;
+    while (value) {
+        value >>= 1;
+        ++bit;
+    }
+    return bit;
+}
+
+} // namespace
+
+int PerfCounters::Histogram::bucketFor(qint64 us) {
+    if (us < 4) {
+        return static_cast<int>(qMax<qint64>(us, 0));
+    }
+    // Two bits below the leading one pick one of four sub-buckets
+    const int exponent = highestBit(static_cast<quint64>(us));
+    const int sub = static_cast<int>((us >> (exponent - 2)) & 3);
+    return qMin(4 * (exponent - 1) + sub, kBuckets - 1);
+}
+
+qint64 PerfCounters::Histogram::bucketUpperBound(int bucket) {
+    if (bucket < 4) {
+        return bucket;
+    }
+    const int exponent = bucket / 4 + 1;
+    const qint64 width = qint64(1) << (exponent - 2);
+    return (4 + bucket % 4) * width + width - 1;
+}
+
+void PerfCounters::Histogram::record(qint64 us) {
+    m_buckets[static_cast<size_t>(bucketFor(us))].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    raiseTo(m_maxUs, us);
+}
+
+PerfCounters::Summary PerfCounters::Histogram::summary() const {
+    std::array<quint32, kBuckets> counts;
+    quint64 total = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        counts[static_cast<size_t>(i)] = m_buckets[static_cast<size_t>(i)].load(std::memory_order_relaxed);
+        total += counts[static_cast<size_t>(i)];
+    }
+
+    Summary summary;
+    summary.count = total;
+    summary.maxUs = m_maxUs.load(std::memory_order_relaxed);
+    if (total == 0) {
+        return summary;
+    }
+
+    const auto percentile = [&](double fraction) {
+        const quint64 rank = qMax<quint64>(1, static_cast<quint64>(std::ceil(fraction * static_cast<double>(total))));
+        quint64 seen = 0;
+        for (int i = 0; i < kBuckets; ++i) {
+            seen += counts[static_cast<size_t>(i)];
+            if (seen >= rank) {
+                return qMin(bucketUpperBound(i), summary.maxUs);
+            }
+        }
+        return summary.maxUs;
+    };
+    summary.p50Us = percentile(0.50);
+    summary.p95Us = percentile(0.95);
+    summary.p99Us = percentile(0.99);
+    return summary;
+}
+
+PerfCounters::Histogram &PerfCounters::histogram(Series series) {
+    return s_histograms[static_cast<size_t>(series)];
+}
+
+PerfCounters::Series PerfCounters::seriesForCommand(const QStringList &args) {
+    for (const QString &arg : args) {
+        if (arg.startsWith(QLatin1Char('-'))) {
+            continue;
+        }
+        if (arg == QStringLiteral("status")) {
+            return Series::Status;
+        }
+        if (arg == QStringLiteral("settings")) {
+            return Series::Settings;
+        }
+        if (arg == QStringLiteral("registration")) {
+            return Series::Registration;
+        }
+        if (arg == QStringLiteral("tunnel")) {
+            return Series::Tunnel;
+        }
+        if (arg == QStringLiteral("connect")) {
+            return Series::Connect;
+        }
+        if (arg == QStringLiteral("disconnect")) {
+            return Series::Disconnect;
+        }
+        if (arg == QStringLiteral("mode")) {
+            return Series::Mode;
+        }
+        break;
+    }
+    return Series::OtherCommand;
+}
+
+QString PerfCounters::seriesName(Series series) {
+    switch (series) {
+    case Series::Status:
+        return QStringLiteral("status");
+    case Series::Settings:
+        return QStringLiteral("settings");
+    case Series::Registration:
+        return QStringLiteral("registration");
+    case Series::Tunnel:
+        return QStringLiteral("tunnel");
+    case Series::Connect:
+        return QStringLiteral("connect");
+    case Series::Disconnect:
+        return QStringLiteral("disconnect");
+    case Series::Mode:
+        return QStringLiteral("mode");
+    case Series::OtherCommand:
+        return QStringLiteral("other commands");
+    case Series::ProbeApi:
+        return QStringLiteral("API probe");
+    case Series::ProbeDns:
+        return QStringLiteral("DNS probe");
+    case Series::ProbeWarp:
+        return QStringLiteral("WARP probe");
+    case Series::ProbeTrace:
+        return QStringLiteral("trace probe");
+    case Series::Count:
+        break;
+    }
+    return QString();
+}
+
+void PerfCounters::noteSpawn() {
+    s_spawns.fetch_add(1, std::memory_order_relaxed);
+}
+
+quint64 PerfCounters::spawns() {
+    return s_spawns.load(std::memory_order_relaxed);
+}
+
+void PerfCounters::noteCacheHit() {
+    s_cacheHits.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PerfCounters::noteCacheMiss() {
+    s_cacheMisses.fetch_add(1, std::memory_order_relaxed);
+}
+
+quint64 PerfCounters::cacheHits() {
+    return s_cacheHits.load(std::memory_order_relaxed);
+}
+
+quint64 PerfCounters::cacheMisses() {
+    return s_cacheMisses.load(std::memory_order_relaxed);
+}
+
+void PerfCounters::setPoll(int intervalMs, int reason) {
+    s_pollIntervalMs.store(intervalMs, std::memory_order_relaxed);
+    s_pollReason.store(reason, std::memory_order_relaxed);
+}
+
+int PerfCounters::pollIntervalMs() {
+    return s_pollIntervalMs.load(std::memory_order_relaxed);
+}
+
+int PerfCounters::pollReason() {
+    return s_pollReason.load(std::memory_order_relaxed);
+}
+
+void PerfCounters::installStallMonitor() {
+    QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance();
+    if (!dispatcher) {
+        return;
+    }
+
+    // Busy time is measured from waking up to the next time the loop would
+    // block, i.e. one full pass over the pending events
+    static QElapsedTimer busy;
+    QObject::connect(dispatcher, &QAbstractEventDispatcher::awake, dispatcher, []() { busy.start(); });
+    QObject::connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, dispatcher, []() {
+        if (!busy.isValid()) {
+            return;
+        }
+        const qint64 us = busy.nsecsElapsed() / 1000;
+        busy.invalidate();
+        if (us >= qint64(kStallThresholdMs) * 1000) {
+            s_stalls.fetch_add(1, std::memory_order_relaxed);
+            raiseTo(s_longestStallUs, us);
+        }
+    });
+}
+
+quint64 PerfCounters::stalls() {
+    return s_stalls.load(std::memory_order_relaxed);
+}
+
+qint64 PerfCounters::longestStallUs() {
+    return s_longestStallUs.load(std::memory_order_relaxed);
+}
+
+qint64 PerfCounters::residentBytes() {
+    // statm: size resident shared text lib data dt, in pages
+    QFile statm(QStringLiteral("/proc/self/statm"));
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QList<QByteArray> fields = statm.readAll().split(' ');
+    bool ok = false;
+    const qint64 pages = fields.value(1).toLongLong(&ok);
+    return ok ? pages * ::sysconf(_SC_PAGESIZE) : -1;
+}
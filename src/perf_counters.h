@@ -0,0 +1,90 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+#include <array>
+#include <atomic>
+
+// Process-wide performance counters for the Performance page. Writers on
+// any thread only do relaxed atomic increments; readers take a consistent
+// enough snapshot whenever they look.
+class PerfCounters {
+public:
+    enum class Series {
+        // warp-cli subcommands, timed from spawn to exit
+        Status,
+        Settings,
+        Registration,
+        Tunnel,
+        Connect,
+        Disconnect,
+        Mode,
+        OtherCommand,
+        // Connectivity probes
+        ProbeApi,
+        ProbeDns,
+        ProbeWarp,
+        ProbeTrace,
+        Count,
+    };
+
+    struct Summary {
+        quint64 count = 0;
+        qint64 p50Us = 0;
+        qint64 p95Us = 0;
+        qint64 p99Us = 0;
+        qint64 maxUs = 0;
+    };
+
+    // Lock-free latency histogram. Four buckets per power of two keep
+    // percentiles within about 20% of the true value.
+    class Histogram {
+    public:
+        void record(qint64 us);
+        Summary summary() const;
+
+    private:
+        static constexpr int kBuckets = 128;
+
+        static int bucketFor(qint64 us);
+        static qint64 bucketUpperBound(int bucket);
+
+        std::array<std::atomic<quint32>, kBuckets> m_buckets{};
+        std::atomic<quint64> m_count{0};
+        std::atomic<qint64> m_maxUs{0};
+    };
+
+    static Histogram &histogram(Series series);
+    static Series seriesForCommand(const QStringList &args);
+    static QString seriesName(Series series);
+
+    // Child processes started by the GUI, including blocking ones
+    static void noteSpawn();
+    static quint64 spawns();
+
+    // Requests answered from the state cache or a matching warp-cli call,
+    // against those that had to start a new one
+    static void noteCacheHit();
+    static void noteCacheMiss();
+    static quint64 cacheHits();
+    static quint64 cacheMisses();
+
+    // Current status poll interval (-1 while not polling) and
+    // PollScheduler::Reason
+    static void setPoll(int intervalMs, int reason);
+    static int pollIntervalMs();
+    static int pollReason();
+
+    // Counts main event loop iterations that ran longer than
+    // kStallThresholdMs. Hooks the dispatcher of the calling thread, which
+    // must be the GUI thread; no timers are involved.
+    static constexpr int kStallThresholdMs = 100;
+    static void installStallMonitor();
+    static quint64 stalls();
+    static qint64 longestStallUs();
+
+    // Resident set size of this process, or -1 if unknown
+    static qint64 residentBytes();
+};
@@ -0,0 +1,155 @@
+#include "poll_scheduler.h"
+
+#include <QDebug>
+#include <QSettings>
+#include <QTimer>
+
+#include <cmath>
+
+#include "perf_counters.h"
+
+PollScheduler::Config PollScheduler::Config::load() {
+    QSettings settings(QStringLiteral("warp-gui"), QStringLiteral("warp-gui"));
+    Config config;
+    config.fastIntervalMs = settings.value(QStringLiteral("poll/fastIntervalMs"), config.fastIntervalMs).toInt();
+    config.userActionWindowMs =
+        settings.value(QStringLiteral("poll/userActionWindowMs"), config.userActionWindowMs).toInt();
+    config.connectedIntervalMs =
+        settings.value(QStringLiteral("poll/connectedIntervalMs"), config.connectedIntervalMs).toInt();
+    config.stableIntervalMs = settings.value(QStringLiteral("poll/stableIntervalMs"), config.stableIntervalMs).toInt();
+    config.backoffFactor = settings.value(QStringLiteral("poll/backoffFactor"), config.backoffFactor).toDouble();
+    config.maxIntervalMs = settings.value(QStringLiteral("poll/maxIntervalMs"), config.maxIntervalMs).toInt();
+    config.pushedIntervalMs = settings.value(QStringLiteral("poll/pushedIntervalMs"), config.pushedIntervalMs).toInt();
+    return config;
+}
+
+PollScheduler::PollScheduler(QObject *parent)
+    : QObject(parent),
+      m_timer(new QTimer(this)),
+      m_state(StatusSnapshot::State::Unknown),
+      m_reason(Reason::Idle),
+      m_fastUntilMs(-1),
+      m_stablePolls(0),
+      m_started(false),
+      m_suspended(false) {
+    m_clock.start();
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &PollScheduler::onTimeout);
+}
+
+void PollScheduler::setConfig(const Config &config) {
+    m_config = config;
+    m_config.fastIntervalMs = qMax(50, m_config.fastIntervalMs);
+    m_config.backoffFactor = qMax(1.0, m_config.backoffFactor);
+    m_config.maxIntervalMs = qMax(m_config.fastIntervalMs, m_config.maxIntervalMs);
+    m_config.pushedIntervalMs = qMax(m_config.fastIntervalMs, m_config.pushedIntervalMs);
+    reschedule();
+}
+
+PollScheduler::Config PollScheduler::config() const {
+    return m_config;
+}
+
+void PollScheduler::start() {
+    m_started = true;
+    reschedule();
+}
+
+void PollScheduler::setState(StatusSnapshot::State state) {
+    if (m_state == state) {
+        return;
+    }
+    m_state = state;
+    m_stablePolls = 0;
+    reschedule();
+}
+
+void PollScheduler::setSuspended(bool suspended) {
+    if (m_suspended == suspended) {
+        return;
+    }
+    m_suspended = suspended;
+    m_stablePolls = 0;
+    reschedule();
+}
+
+void PollScheduler::noteUserAction() {
+    m_fastUntilMs = m_clock.elapsed() + m_config.userActionWindowMs;
+    m_stablePolls = 0;
+    reschedule();
+}
+
+void PollScheduler::noteVisible() {
+    m_stablePolls = 0;
+    emit pollRequested();
+    reschedule();
+}
+
+int PollScheduler::currentInterval() const {
+    return m_timer->isActive() ? m_timer->interval() : -1;
+}
+
+PollScheduler::Reason PollScheduler::reason() const {
+    return m_reason;
+}
+
+QString PollScheduler::reasonName(Reason reason) {
+    switch (reason) {
+    case Reason::Idle:
+        return QStringLiteral("idle");
+    case Reason::Pushed:
+        return QStringLiteral("pushed");
+    case Reason::Connecting:
+        return QStringLiteral("connecting");
+    case Reason::UserAction:
+        return QStringLiteral("user action");
+    case Reason::Connected:
+        return QStringLiteral("connected");
+    case Reason::Disconnected:
+        return QStringLiteral("disconnected");
+    }
+    return QString();
+}
+
+void PollScheduler::onTimeout() {
+    m_stablePolls++;
+    emit pollRequested();
+    reschedule();
+}
+
+void PollScheduler::reschedule() {
+    const Reason previous = m_reason;
+    int interval = -1;
+
+    if (!m_started) {
+        m_reason = Reason::Idle;
+    } else if (m_suspended) {
+        m_reason = Reason::Pushed;
+        interval = m_config.pushedIntervalMs;
+    } else if (m_state == StatusSnapshot::State::Connecting) {
+        m_reason = Reason::Connecting;
+        interval = m_config.fastIntervalMs;
+    } else if (m_clock.elapsed() < m_fastUntilMs) {
+        m_reason = Reason::UserAction;
+        interval = m_config.fastIntervalMs;
+    } else if (m_state == StatusSnapshot::State::Connected) {
+        m_reason = Reason::Connected;
+        interval = m_config.connectedIntervalMs;
+    } else {
+        // Disconnected or unknown: nothing is expected to change on its own
+        m_reason = Reason::Disconnected;
+        const double scaled = m_config.stableIntervalMs * std::pow(m_config.backoffFactor, m_stablePolls);
+        interval = static_cast<int>(qMin<double>(scaled, m_config.maxIntervalMs));
+    }
+
+    if (interval < 0) {
+        m_timer->stop();
+    } else {
+        m_timer->start(interval);
+    }
+    PerfCounters::setPoll(interval, static_cast<int>(m_reason));
+
+    if (m_reason != previous) {
+        qDebug() << "Status poll:" << reasonName(m_reason) << "interval" << interval << "ms";
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+
+#include "status_snapshot.h"
+
+class QTimer;
+
+// Decides when the status should be polled. Polls quickly while a
+// connection is being set up or right after a user action, backs off while
+// nothing changes, and stays quiet while status is pushed to us.
+class PollScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Reason {
+        Idle,       // not started
+        Pushed,     // status watch channel is live, slow verification poll only
+        Connecting,
+        UserAction,
+        Connected,
+        Disconnected,
+    };
+
+    struct Config {
+        int fastIntervalMs = 250;       // while connecting / after a user action
+        int userActionWindowMs = 10000; // how long a user action keeps polls fast
+        int connectedIntervalMs = 5000;
+        int stableIntervalMs = 5000;    // first interval once disconnected and stable
+        double backoffFactor = 2.0;
+        int maxIntervalMs = 300000;
+        int pushedIntervalMs = 60000;   // verification poll while status is pushed
+
+        // Reads poll/* keys from the application settings over the defaults
+        static Config load();
+    };
+
+    explicit PollScheduler(QObject *parent = nullptr);
+
+    void setConfig(const Config &config);
+    Config config() const;
+
+    void start();
+
+    void setState(StatusSnapshot::State state);
+    // While suspended the status arrives by push; only a slow verification
+    // poll runs, in case the push channel stalls without exiting
+    void setSuspended(bool suspended);
+    void noteUserAction();
+    // A status view became visible; poll right away
+    void noteVisible();
+
+    // Interval of the pending poll, or -1 when none is scheduled
+    int currentInterval() const;
+    Reason reason() const;
+    static QString reasonName(Reason reason);
+
+signals:
+    void pollRequested();
+
+private:
+    void onTimeout();
+    void reschedule();
+
+    QTimer *m_timer;
+    QElapsedTimer m_clock;
+    Config m_config;
+    StatusSnapshot::State m_state;
+    Reason m_reason;
+    qint64 m_fastUntilMs;
+    int m_stablePolls;
+    bool m_started;
+    bool m_suspended;
+};
@@ -1,4 +1,5 @@
 #include "popup_widget.h"
+#include "theme.h"
 #include "toggle_switch.h"
 #include "wayland_popup_helper.h"
 
@@ -59,7 +60,7 @@ WarpPopup::WarpPopup(QWidget *parent)
     handleFont.setPointSize(10);
     dragHandle->setFont(handleFont);
     dragHandle->setAlignment(Qt::AlignCenter);
-    dragHandle->setStyleSheet(QStringLiteral("color: #666666; background: transparent;"));
+    dragHandle->setObjectName(QStringLiteral("dragHandle"));
     dragHandle->setToolTip(QStringLiteral("Drag to reposition popup"));
     dragHandle->setCursor(Qt::OpenHandCursor);
     contentLayout->addWidget(dragHandle);
@@ -71,6 +72,7 @@ WarpPopup::WarpPopup(QWidget *parent)
     titleFont.setPointSize(28);
     titleFont.setBold(true);
     m_title->setFont(titleFont);
+    m_title->setObjectName(QStringLiteral("popupTitle"));
     m_title->setAlignment(Qt::AlignCenter);
     m_title->setToolTip(QStringLiteral("Click and drag to reposition"));
     m_title->setCursor(Qt::OpenHandCursor);
@@ -116,10 +118,13 @@ WarpPopup::WarpPopup(QWidget *parent)
     m_settingsBtn->setFixedSize(28, 28);
     bottomLayout->addWidget(m_settingsBtn);
 
+    m_bottomBar->setObjectName(QStringLiteral("bottomBar"));
+    m_brandingLabel->setObjectName(QStringLiteral("brandingLabel"));
     m_bottomBar->setFixedHeight(50);
     layout->addWidget(m_bottomBar);
 
-    applyStyle();
+    // Colors come from the application theme; see theme.cpp
+    updateTitleColor();
 
     connect(m_toggle, &ToggleSwitch::toggled, this, &WarpPopup::onToggleChanged);
     connect(m_settingsBtn, &QPushButton::clicked, this, &WarpPopup::requestSettings);
@@ -127,47 +132,6 @@ WarpPopup::WarpPopup(QWidget *parent)
     setFixedSize(260, 332);
 }
 
-void WarpPopup::applyStyle() {
-    setStyleSheet(QStringLiteral(
-        "WarpPopup { "
-        "  background-color: transparent; " // Transparent for arrow
-        "}"
-        "#contentWidget { "
-        "  background-color: #1e1e1e; "
-        "  border: 1px solid #3a3a3a; "
-        "  border-radius: 12px; "
-        "}"
-        "QLabel { color: #ffffff; background: transparent; }"
-        "QPushButton {"
-        "  background: transparent; "
-        "  border: none; "
-        "  color: #999999; "
-        "  font-size: 18px; "
-        "  padding: 0px;"
-        "}"
-        "QPushButton:hover { color: #ffffff; }"
-    ));
-
-    // Title color will be set dynamically in updateTitle()
-    updateTitleColor();
-
-    // Bottom bar styling
-    m_bottomBar->setStyleSheet(QStringLiteral(
-        "QWidget { "
-        "  background-color: #2a2a2a; "
-        "  border-top: 1px solid #3a3a3a; "
-        "  border-bottom-left-radius: 12px; "
-        "  border-bottom-right-radius: 12px; "
-        "}"
-    ));
-
-    m_brandingLabel->setStyleSheet(QStringLiteral(
-        "color: #888888; "
-        "background: transparent; "
-        "font-weight: bold;"
-    ));
-}
-
 void WarpPopup::setStatusText(const QString &status, const QString &reason) {
     const QString s = status.trimmed();
     m_status->setText(s.isEmpty() ? QStringLiteral("Unknown") : s);
@@ -345,12 +309,9 @@ void WarpPopup::updateTitle() {
 }
 
 void WarpPopup::updateTitleColor() {
-    // Zero Trust uses blue, WARP and 1.1.1.1 use orange
-    if (m_isZeroTrust) {
-        m_title->setStyleSheet(QStringLiteral("color: #0A64BC; background: transparent; font-weight: bold;"));
-    } else {
-        m_title->setStyleSheet(QStringLiteral("color: #ff6a00; background: transparent; font-weight: bold;"));
-    }
+    // Zero Trust uses blue, WARP and 1.1.1.1 use orange. Runs on every
+    // status update, so only repolishes when the accent actually flips.
+    Theme::setState(m_title, "accent", m_isZeroTrust ? QStringLiteral("zeroTrust") : QStringLiteral("warp"));
 }
 
 void WarpPopup::setAnchorBottom(bool anchorBottom) {
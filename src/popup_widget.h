@@ -41,7 +41,6 @@ private slots:
     void onToggleChanged(bool checked);
 
 private:
-    void applyStyle();
     void updateTitle();
     void updateTitleColor();
 
@@ -2,36 +2,105 @@
 
 #include <QCheckBox>
 #include <QComboBox>
+#include <QDateTime>
 #include <QDebug>
 #include <QFormLayout>
 #include <QGroupBox>
 #include <QHBoxLayout>
+#include <QHeaderView>
 #include <QInputDialog>
 #include <QLabel>
 #include <QLineEdit>
 #include <QListWidget>
+#include <QLocale>
 #include <QMessageBox>
 #include <QProcess>
 #include <QPushButton>
 #include <QRegularExpression>
+#include <QSettings>
+#include <QSignalBlocker>
 #include <QStackedWidget>
+#include <QStandardPaths>
+#include <QTableWidget>
 #include <QTextEdit>
-#include <QThread>
 #include <QTimer>
 #include <QVBoxLayout>
 
+#include "connection_log.h"
+#include "perf_counters.h"
+#include "poll_scheduler.h"
+#include "probe_engine.h"
+#include "theme.h"
+#include "warp_state_cache.h"
+
+namespace {
+
+// What to tell the user about a warp-cli command that did not succeed
+QString failureText(const WarpResult &result) {
+    switch (result.outcome) {
+    case WarpResult::Outcome::TimedOut:
+        return QStringLiteral("warp-cli did not respond in time");
+    case WarpResult::Outcome::FailedToStart:
+        return QStringLiteral("warp-cli could not be run");
+    default:
+        break;
+    }
+    const QString text = result.stderrText().trimmed();
+    return text.isEmpty() ? QStringLiteral("warp-cli failed") : text;
+}
+
+// "3 d 4 h", "2 h 15 min", "12 min"
+QString formatDuration(qint64 ms) {
+    const qint64 minutes = ms / 60000;
+    if (minutes < 60) {
+        return minutes < 1 ? QStringLiteral("< 1 min") : QStringLiteral("%1 min").arg(minutes);
+    }
+    if (minutes < 24 * 60) {
+        return QStringLiteral("%1 h %2 min").arg(minutes / 60).arg(minutes % 60);
+    }
+    return QStringLiteral("%1 d %2 h").arg(minutes / (24 * 60)).arg((minutes / 60) % 24);
+}
+
+QString formatLatency(qint64 us) {
+    if (us < 10000) {
+        return QStringLiteral("%1 ms").arg(static_cast<double>(us) / 1000.0, 0, 'f', 1);
+    }
+    if (us < 10000000) {
+        return QStringLiteral("%1 ms").arg(us / 1000);
+    }
+    return QStringLiteral("%1 s").arg(static_cast<double>(us) / 1e6, 0, 'f', 1);
+}
+
+} // namespace
+
 PreferencesDialog::PreferencesDialog(QWidget *parent)
     : QDialog(parent),
       m_sidebar(new QListWidget(this)),
       m_contentStack(new QStackedWidget(this)),
+      m_pages{},
+      m_idleTimer(new QTimer(this)),
+      m_performanceTimer(new QTimer(this)),
+      m_probes(new ProbeEngine(this)),
       m_isZeroTrust(false) {
 
     setWindowTitle(QStringLiteral("WARP Preferences"));
     setMinimumSize(850, 750);
 
     setupUi();
-    applyStyles();
-    refreshSettings();
+
+    // Hidden for this long, the dialog drops its pages; 0 keeps them
+    QSettings settings(QStringLiteral("warp-gui"), QStringLiteral("warp-gui"));
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(settings.value(QStringLiteral("preferences/releaseIdleMs"), 300000).toInt());
+    connect(m_idleTimer, &QTimer::timeout, this, &PreferencesDialog::releasePages);
+
+    m_performanceTimer->setInterval(1000);
+    connect(m_performanceTimer, &QTimer::timeout, this, &PreferencesDialog::updatePerformance);
+
+    connect(m_probes, &ProbeEngine::probeFinished, this, &PreferencesDialog::onProbeFinished);
+    connect(WarpStateCache::instance(), &WarpStateCache::updated, this, &PreferencesDialog::onStateUpdated);
+    connect(WarpStateCache::instance(), &WarpStateCache::failed, this, &PreferencesDialog::onStateFailed);
+    connect(WarpStateCache::instance(), &WarpStateCache::finished, this, &PreferencesDialog::onWarpFinished);
 }
 
 void PreferencesDialog::setupUi() {
@@ -46,23 +115,161 @@ void PreferencesDialog::setupUi() {
     m_sidebar->addItem(QStringLiteral("Account"));
     m_sidebar->addItem(QStringLiteral("Connectivity"));
     m_sidebar->addItem(QStringLiteral("Advanced"));
+    m_sidebar->addItem(QStringLiteral("Performance"));
 
-    connect(m_sidebar, &QListWidget::currentRowChanged, this, &PreferencesDialog::onCategoryChanged);
-
-    // Content pages
-    createGeneralPage();
-    createConnectionPage();
-    createAccountPage();
-    createConnectivityPage();
-    createAdvancedPage();
+    // Empty placeholders until each page is first visited
+    for (int i = 0; i < PageCount; ++i) {
+        m_contentStack->addWidget(new QWidget());
+    }
 
     mainLayout->addWidget(m_sidebar);
     mainLayout->addWidget(m_contentStack, 1);
 
-    m_sidebar->setCurrentRow(0);
+    // Pages are built and loaded from showEvent, not while constructing
+    m_sidebar->setCurrentRow(GeneralPage);
+    connect(m_sidebar, &QListWidget::currentRowChanged, this, &PreferencesDialog::onCategoryChanged);
 }
 
-void PreferencesDialog::createGeneralPage() {
+QWidget *PreferencesDialog::ensurePage(int index) {
+    if (m_pages[index]) {
+        return m_pages[index];
+    }
+
+    QWidget *page = nullptr;
+    switch (index) {
+    case GeneralPage:
+        page = createGeneralPage();
+        break;
+    case ConnectionPage:
+        page = createConnectionPage();
+        break;
+    case AccountPage:
+        page = createAccountPage();
+        break;
+    case ConnectivityPage:
+        page = createConnectivityPage();
+        break;
+    case AdvancedPage:
+        page = createAdvancedPage();
+        break;
+    case PerformancePage:
+        page = createPerformancePage();
+        break;
+    default:
+        return nullptr;
+    }
+
+    QWidget *placeholder = m_contentStack->widget(index);
+    m_contentStack->insertWidget(index, page);
+    m_contentStack->removeWidget(placeholder);
+    delete placeholder;
+    m_pages[index] = page;
+
+    // Fill the new page from whatever is already cached
+    if (index == GeneralPage) {
+        for (QLabel *label : {m_statusLabel, m_dnsProtocolLabel, m_coloLabel, m_connectionTypeLabel,
+                              m_publicIpLabel, m_deviceIdLabel}) {
+            setFieldLoading(label);
+        }
+    } else if (index == AccountPage) {
+        setFieldLoading(page->property("accountStatusLabel").value<QLabel*>());
+    }
+    auto *cache = WarpStateCache::instance();
+    for (WarpStateCache::Entry entry : {WarpStateCache::Entry::Settings, WarpStateCache::Entry::TunnelStats,
+                                        WarpStateCache::Entry::Registration, WarpStateCache::Entry::Network}) {
+        if (cache->hasData(entry)) {
+            onStateUpdated(entry);
+        }
+    }
+    return page;
+}
+
+void PreferencesDialog::releasePages() {
+    if (isVisible()) {
+        return;
+    }
+
+    // Split tunnel lists and account pages can be large; rebuild on demand
+    for (int i = 0; i < PageCount; ++i) {
+        QWidget *page = m_pages[i];
+        if (!page) {
+            continue;
+        }
+        forgetPageWidgets(i);
+        m_pages[i] = nullptr;
+        m_contentStack->insertWidget(i, new QWidget());
+        m_contentStack->removeWidget(page);
+        page->deleteLater();
+    }
+}
+
+void PreferencesDialog::forgetPageWidgets(int index) {
+    switch (index) {
+    case GeneralPage:
+        m_statusLabel = nullptr;
+        m_dnsProtocolLabel = nullptr;
+        m_coloLabel = nullptr;
+        m_connectionTypeLabel = nullptr;
+        m_publicIpLabel = nullptr;
+        m_deviceIdLabel = nullptr;
+        break;
+    case ConnectionPage:
+        m_networkExclusionWidget = nullptr;
+        m_excludedNetworksList = nullptr;
+        m_addNetworkBtn = nullptr;
+        m_removeNetworkBtn = nullptr;
+        m_disableWifiCheck = nullptr;
+        m_disableEthernetCheck = nullptr;
+        m_consumerDnsWidget = nullptr;
+        m_familiesModeComboConnection = nullptr;
+        m_zeroTrustDnsWidget = nullptr;
+        m_gatewayDohInput = nullptr;
+        break;
+    case ConnectivityPage:
+        m_apiConnectivityLabel = nullptr;
+        m_dnsConnectivityLabel = nullptr;
+        m_warpConnectivityLabel = nullptr;
+        m_coloConnectivityLabel = nullptr;
+        m_historyTable = nullptr;
+        m_mtbfLabel = nullptr;
+        m_reasonsLabel = nullptr;
+        break;
+    case AdvancedPage:
+        m_autoConnectCheck = nullptr;
+        m_viewSplitTunnelBtn = nullptr;
+        m_excludedHostsText = nullptr;
+        m_excludedIpsText = nullptr;
+        m_advancedInfoLabel = nullptr;
+        break;
+    case PerformancePage:
+        m_latencyTable = nullptr;
+        m_spawnRateLabel = nullptr;
+        m_pollLabel = nullptr;
+        m_cacheHitLabel = nullptr;
+        m_stallLabel = nullptr;
+        m_rssLabel = nullptr;
+        break;
+    default:
+        // The Account page keeps its widgets in dynamic properties
+        break;
+    }
+}
+
+void PreferencesDialog::showEvent(QShowEvent *event) {
+    QDialog::showEvent(event);
+    m_idleTimer->stop();
+    onCategoryChanged(m_sidebar->currentRow());
+}
+
+void PreferencesDialog::hideEvent(QHideEvent *event) {
+    QDialog::hideEvent(event);
+    m_performanceTimer->stop();
+    if (m_idleTimer->interval() > 0) {
+        m_idleTimer->start();
+    }
+}
+
+QWidget *PreferencesDialog::createGeneralPage() {
     auto *page = new QWidget();
     auto *layout = new QVBoxLayout(page);
     layout->setContentsMargins(30, 30, 30, 30);
@@ -123,10 +330,10 @@ void PreferencesDialog::createGeneralPage() {
 
     layout->addStretch();
 
-    m_contentStack->addWidget(page);
+    return page;
 }
 
-void PreferencesDialog::createConnectivityPage() {
+QWidget *PreferencesDialog::createConnectivityPage() {
     auto *page = new QWidget();
     auto *layout = new QVBoxLayout(page);
     layout->setContentsMargins(30, 30, 30, 30);
@@ -157,13 +364,43 @@ void PreferencesDialog::createConnectivityPage() {
 
     layout->addWidget(statusGroup);
 
+    // Connection History group, from the connection log
+    auto *historyGroup = new QGroupBox(QStringLiteral("Connection History"));
+    auto *historyLayout = new QVBoxLayout(historyGroup);
+
+    m_historyTable = new QTableWidget(0, 4);
+    m_historyTable->setHorizontalHeaderLabels({QStringLiteral("Period"), QStringLiteral("Uptime"),
+                                               QStringLiteral("Monitored"), QStringLiteral("Drops")});
+    m_historyTable->verticalHeader()->hide();
+    m_historyTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_historyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_historyTable->setSelectionMode(QAbstractItemView::NoSelection);
+    m_historyTable->setFocusPolicy(Qt::NoFocus);
+    historyLayout->addWidget(m_historyTable);
+
+    auto *historyForm = new QFormLayout();
+    m_mtbfLabel = new QLabel();
+    m_reasonsLabel = new QLabel();
+    m_reasonsLabel->setWordWrap(true);
+    historyForm->addRow(QStringLiteral("Mean time between drops:"), m_mtbfLabel);
+    historyForm->addRow(QStringLiteral("Common disconnect reasons:"), m_reasonsLabel);
+    historyLayout->addLayout(historyForm);
+
+    auto *historyDesc = new QLabel(
+        QStringLiteral("Uptime counts only the time warp-gui was running. Disconnects you asked for are not drops."));
+    historyDesc->setWordWrap(true);
+    Theme::setState(historyDesc, "role", QStringLiteral("groupDescription"));
+    historyLayout->addWidget(historyDesc);
+
+    layout->addWidget(historyGroup, 1);
+
     // Service Status section
     auto *serviceGroup = new QGroupBox(QStringLiteral("Service Status"));
     auto *serviceLayout = new QVBoxLayout(serviceGroup);
 
     auto *serviceDesc = new QLabel(QStringLiteral("Check Cloudflare's system status for any ongoing service interruptions or maintenance."));
     serviceDesc->setWordWrap(true);
-    serviceDesc->setStyleSheet(QStringLiteral("color: #999; font-size: 11px; margin-bottom: 5px;"));
+    Theme::setState(serviceDesc, "role", QStringLiteral("groupDescription"));
     serviceLayout->addWidget(serviceDesc);
 
     auto *checkStatusBtn = new QPushButton(QStringLiteral("Check for Service Interruptions"));
@@ -179,15 +416,16 @@ void PreferencesDialog::createConnectivityPage() {
     auto *refreshBtn = new QPushButton(QStringLiteral("Refresh Connectivity Status"));
     connect(refreshBtn, &QPushButton::clicked, this, [this]() {
         updateConnectivityStatus();
+        updateConnectionHistory();
     });
     layout->addWidget(refreshBtn);
 
     layout->addStretch();
 
-    m_contentStack->addWidget(page);
+    return page;
 }
 
-void PreferencesDialog::createAccountPage() {
+QWidget *PreferencesDialog::createAccountPage() {
     auto *page = new QWidget();
     auto *layout = new QVBoxLayout(page);
     layout->setContentsMargins(30, 30, 30, 30);
@@ -217,16 +455,17 @@ void PreferencesDialog::createAccountPage() {
 
     auto *registerDesc = new QLabel(QStringLiteral("Register this device to start using WARP."));
     registerDesc->setWordWrap(true);
-    registerDesc->setStyleSheet(QStringLiteral("color: #999; font-size: 11px; margin-bottom: 5px;"));
+    Theme::setState(registerDesc, "role", QStringLiteral("groupDescription"));
     actionsLayout->addWidget(registerDesc);
 
     auto *registerBtn = new QPushButton(QStringLiteral("Register New Device"));
     registerBtn->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Fixed);
     connect(registerBtn, &QPushButton::clicked, this, [this]() {
-        QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("registration"), QStringLiteral("new")});
-        QMessageBox::information(this, QStringLiteral("Register"), QStringLiteral("Registration command executed. Check status below."));
-        refreshSettings();
-        emit settingsChanged();
+        runWarpCommand({QStringLiteral("registration"), QStringLiteral("new")}, [this](const WarpResult &) {
+            QMessageBox::information(this, QStringLiteral("Register"), QStringLiteral("Registration command executed. Check status below."));
+            refreshSettings();
+            emit settingsChanged();
+        });
     });
     actionsLayout->addWidget(registerBtn);
 
@@ -234,7 +473,7 @@ void PreferencesDialog::createAccountPage() {
 
     auto *enrollDesc = new QLabel(QStringLiteral("Connect to your organization's Zero Trust network."));
     enrollDesc->setWordWrap(true);
-    enrollDesc->setStyleSheet(QStringLiteral("color: #999; font-size: 11px; margin-bottom: 5px;"));
+    Theme::setState(enrollDesc, "role", QStringLiteral("groupDescription"));
     actionsLayout->addWidget(enrollDesc);
 
     auto *enrollOrgBtn = new QPushButton(QStringLiteral("Enroll in Zero Trust Organization"));
@@ -327,14 +566,11 @@ void PreferencesDialog::createAccountPage() {
                     connect(pollTimer, &QTimer::timeout, this, [this, pollTimer, retryCount]() {
                         (*retryCount)++;
                         
-                        // Check if Zero Trust status has updated
-                        QProcess checkProcess;
-                        checkProcess.start(QStringLiteral("warp-cli"), {QStringLiteral("registration"), QStringLiteral("show")});
-                        checkProcess.waitForFinished();
-                        QString regOutput = QString::fromUtf8(checkProcess.readAllStandardOutput());
-                        
-                        bool isZeroTrust = regOutput.contains(QStringLiteral("Account type: Team"), Qt::CaseInsensitive) ||
-                                          regOutput.contains(QStringLiteral("Organization:"), Qt::CaseInsensitive);
+                        // Check the registration fetched on the previous tick and
+                        // ask for a new one for the next
+                        auto *cache = WarpStateCache::instance();
+                        bool isZeroTrust = cache->isZeroTrust();
+                        cache->refresh(WarpStateCache::Entry::Registration);
                         
                         // If Zero Trust detected or we've tried 10 times (10 seconds), stop and refresh
                         if (isZeroTrust || *retryCount >= 10) {
@@ -361,42 +597,41 @@ void PreferencesDialog::createAccountPage() {
                         QMessageBox::Yes | QMessageBox::No);
 
                     if (reply == QMessageBox::Yes) {
-                        // Delete old registration and retry
-                        QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("registration"), QStringLiteral("delete")});
-
-                        // Retry enrollment
-                        QProcess *retryProcess = new QProcess(this);
-                        connect(retryProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                                this, [this, retryProcess](int code, QProcess::ExitStatus status) {
-                            QString output = QString::fromUtf8(retryProcess->readAllStandardOutput()) +
-                                           QString::fromUtf8(retryProcess->readAllStandardError());
-
-                            // Check for URL in retry output
-                            QRegularExpression urlRegex(QStringLiteral("https://[^\\s]+"));
-                            auto urlMatch = urlRegex.match(output);
-
-                            if (urlMatch.hasMatch()) {
-                                QString url = urlMatch.captured(0);
-                                QProcess::startDetached(QStringLiteral("xdg-open"), {url});
-
-                                QMessageBox::information(this, QStringLiteral("Complete Enrollment in Browser"),
-                                                       QStringLiteral("Browser opened. Complete authentication and click OK when done."));
-                            } else {
-                                QMessageBox::warning(this, QStringLiteral("Enrollment Failed"),
-                                                   QStringLiteral("Failed to enroll. Please try again or check warp-cli status."));
-                            }
+                        // Delete old registration, then retry enrollment
+                        runWarpCommand({QStringLiteral("registration"), QStringLiteral("delete")}, [this, org](const WarpResult &) {
+                            QProcess *retryProcess = new QProcess(this);
+                            connect(retryProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                                    this, [this, retryProcess](int code, QProcess::ExitStatus status) {
+                                QString output = QString::fromUtf8(retryProcess->readAllStandardOutput()) +
+                                               QString::fromUtf8(retryProcess->readAllStandardError());
+
+                                // Check for URL in retry output
+                                QRegularExpression urlRegex(QStringLiteral("https://[^\\s]+"));
+                                auto urlMatch = urlRegex.match(output);
+
+                                if (urlMatch.hasMatch()) {
+                                    QString url = urlMatch.captured(0);
+                                    QProcess::startDetached(QStringLiteral("xdg-open"), {url});
+
+                                    QMessageBox::information(this, QStringLiteral("Complete Enrollment in Browser"),
+                                                           QStringLiteral("Browser opened. Complete authentication and click OK when done."));
+                                } else {
+                                    QMessageBox::warning(this, QStringLiteral("Enrollment Failed"),
+                                                       QStringLiteral("Failed to enroll. Please try again or check warp-cli status."));
+                                }
                             
-                            // Wait a moment for the registration to fully process, then refresh
-                            QTimer::singleShot(1000, this, [this]() {
-                                refreshSettings();
-                                emit settingsChanged();
-                            });
+                                // Wait a moment for the registration to fully process, then refresh
+                                QTimer::singleShot(1000, this, [this]() {
+                                    refreshSettings();
+                                    emit settingsChanged();
+                                });
                             
-                            retryProcess->deleteLater();
-                        });
+                                retryProcess->deleteLater();
+                            });
 
-                        QString retryCmd = QStringLiteral("echo y | script -qec 'warp-cli registration new %1' /dev/null").arg(org);
-                        retryProcess->start(QStringLiteral("sh"), {QStringLiteral("-c"), retryCmd});
+                            QString retryCmd = QStringLiteral("echo y | script -qec 'warp-cli registration new %1' /dev/null").arg(org);
+                            retryProcess->start(QStringLiteral("sh"), {QStringLiteral("-c"), retryCmd});
+                        });
                     }
                 } else {
                     // Show only relevant error lines, not the whole ToS text
@@ -436,7 +671,7 @@ void PreferencesDialog::createAccountPage() {
             QString command;
 
             // Try unbuffer first (cleaner than script)
-            if (QProcess::execute(QStringLiteral("which"), {QStringLiteral("unbuffer")}) == 0) {
+            if (!QStandardPaths::findExecutable(QStringLiteral("unbuffer")).isEmpty()) {
                 command = QStringLiteral("(sleep 0.5; echo y) | unbuffer -p warp-cli registration new %1").arg(org);
             } else {
                 // Fallback: use script with a longer timeout to keep process alive
@@ -459,7 +694,7 @@ void PreferencesDialog::createAccountPage() {
 
     auto *licenseDesc = new QLabel(QStringLiteral("Enter your WARP+ license key to unlock premium features."));
     licenseDesc->setWordWrap(true);
-    licenseDesc->setStyleSheet(QStringLiteral("color: #999; font-size: 11px; margin-bottom: 5px;"));
+    Theme::setState(licenseDesc, "role", QStringLiteral("groupDescription"));
     licenseLayout->addWidget(licenseDesc);
 
     auto *attachLicenseBtn = new QPushButton(QStringLiteral("Attach License Key"));
@@ -470,10 +705,11 @@ void PreferencesDialog::createAccountPage() {
                                            QStringLiteral("Enter your WARP+ license key:"), QLineEdit::Password,
                                            QString(), &ok);
         if (ok && !key.isEmpty()) {
-            QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("registration"), QStringLiteral("license"), key});
-            QMessageBox::information(this, QStringLiteral("License"), QStringLiteral("License command executed. Check status below."));
-            refreshSettings();
-            emit settingsChanged();
+            runWarpCommand({QStringLiteral("registration"), QStringLiteral("license"), key}, [this](const WarpResult &) {
+                QMessageBox::information(this, QStringLiteral("License"), QStringLiteral("License command executed. Check status below."));
+                refreshSettings();
+                emit settingsChanged();
+            });
         }
     });
     licenseLayout->addWidget(attachLicenseBtn);
@@ -486,113 +722,115 @@ void PreferencesDialog::createAccountPage() {
 
     auto *reauthDesc = new QLabel(QStringLiteral("Refresh your authentication with the Zero Trust organization."));
     reauthDesc->setWordWrap(true);
-    reauthDesc->setStyleSheet(QStringLiteral("color: #999; font-size: 11px; margin-bottom: 5px;"));
+    Theme::setState(reauthDesc, "role", QStringLiteral("groupDescription"));
     teamsLayout->addWidget(reauthDesc);
 
     auto *reauthBtn = new QPushButton(QStringLiteral("Re-Authenticate Session"));
     reauthBtn->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Fixed);
     connect(reauthBtn, &QPushButton::clicked, this, [this]() {
+        // Re-authenticate with Cloudflare Access
+        const auto reauthenticate = [this]() {
+            QProcess *reauthProcess = new QProcess(this);
+            QString *allOutput = new QString();
+            bool *urlOpened = new bool(false);
+            QMetaObject::Connection *readConnection = new QMetaObject::Connection();
+
+            // Read output as it comes
+            *readConnection = connect(reauthProcess, &QProcess::readyReadStandardOutput, this, [reauthProcess, allOutput, urlOpened, readConnection, this]() {
+                QString newOutput = QString::fromUtf8(reauthProcess->readAllStandardOutput());
+                *allOutput += newOutput;
+
+                // Check if URL appeared in the NEW output (not the accumulated output)
+                QRegularExpression urlRegex(QStringLiteral("https://[^\\s]+"));
+                auto urlMatch = urlRegex.match(newOutput);
+
+                if (urlMatch.hasMatch() && !*urlOpened) {
+                    QString url = urlMatch.captured(0);
+                    *urlOpened = true;
+
+                    // Disconnect this signal immediately to prevent duplicate triggers
+                    disconnect(*readConnection);
+
+                    // NOTE: Don't open browser - warp-cli already opens it automatically
+                    // Just show notification that browser was opened
+
+                    // Show non-blocking notification
+                    QMessageBox *msgBox = new QMessageBox(this);
+                    msgBox->setWindowTitle(QStringLiteral("Browser Opened"));
+                    msgBox->setIcon(QMessageBox::Information);
+                    msgBox->setText(QStringLiteral("Complete authentication in browser"));
+                    msgBox->setInformativeText(
+                        QStringLiteral("Browser opened to:\n") + url + QStringLiteral("\n\n"
+                                      "Complete the authentication to refresh your session.")
+                    );
+                    msgBox->setStandardButtons(QMessageBox::Ok);
+                    msgBox->setAttribute(Qt::WA_DeleteOnClose);
+                    msgBox->setModal(false);
+                    msgBox->show();
+                }
+            });
+
+            connect(reauthProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                    this, [this, reauthProcess, allOutput, urlOpened, readConnection](int exitCode, QProcess::ExitStatus exitStatus) {
+                *allOutput += QString::fromUtf8(reauthProcess->readAllStandardOutput());
+                *allOutput += QString::fromUtf8(reauthProcess->readAllStandardError());
+
+                if (exitCode == 0) {
+                    if (*urlOpened) {
+                        // URL was opened - user already got the "Browser Opened" notification
+                        // Don't show another popup, just refresh silently
+                    } else {
+                        // Command succeeded but no URL (might already be authenticated)
+                        QMessageBox::information(this, QStringLiteral("Re-Authentication Complete"),
+                                               QStringLiteral("Re-authentication completed successfully."));
+                    }
+                    refreshSettings();
+                    emit settingsChanged();
+                } else {
+                    // Show the actual error message from warp-cli
+                    QString errorMsg = *allOutput;
+                    if (errorMsg.isEmpty()) {
+                        errorMsg = QStringLiteral("Failed to re-authenticate. Please try logging out and enrolling again.");
+                    }
+                    QMessageBox::warning(this, QStringLiteral("Re-Authentication Failed"), errorMsg.trimmed());
+                }
+
+                delete allOutput;
+                delete urlOpened;
+                delete readConnection;
+                reauthProcess->deleteLater();
+            });
+
+            reauthProcess->start(QStringLiteral("warp-cli"), {QStringLiteral("debug"), QStringLiteral("access-reauth")});
+        };
+
         // First check if WARP is connected
-        QProcess checkProcess;
-        checkProcess.start(QStringLiteral("warp-cli"), {QStringLiteral("status")});
-        checkProcess.waitForFinished();
-        QString statusOutput = QString::fromUtf8(checkProcess.readAllStandardOutput());
-        
-        bool isConnected = statusOutput.contains(QStringLiteral("Status update: Connected"), Qt::CaseInsensitive) ||
-                          statusOutput.contains(QStringLiteral("\"status\": \"Connected\""), Qt::CaseInsensitive);
-        
-        if (!isConnected) {
+        runWarpQuery({QStringLiteral("status")}, [this, reauthenticate](const WarpResult &check) {
+            const QString statusOutput = check.stdoutText();
+            const bool isConnected =
+                statusOutput.contains(QStringLiteral("Status update: Connected"), Qt::CaseInsensitive) ||
+                statusOutput.contains(QStringLiteral("\"status\": \"Connected\""), Qt::CaseInsensitive);
+            if (isConnected) {
+                reauthenticate();
+                return;
+            }
+
             // Need to connect first
             auto reply = QMessageBox::question(this,
                 QStringLiteral("WARP Not Connected"),
                 QStringLiteral("Re-authentication requires WARP to be connected.\n\nConnect now and then re-authenticate?"),
                 QMessageBox::Yes | QMessageBox::No);
-            
             if (reply != QMessageBox::Yes) {
                 return;
             }
-            
-            // Connect WARP
-            QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("connect")});
-            
-            // Wait a moment for connection
-            QMessageBox::information(this, QStringLiteral("Connecting"),
-                QStringLiteral("Connecting to WARP...\n\nClick OK to continue with re-authentication."));
-        }
-        
-        // Re-authenticate with Cloudflare Access
-        QProcess *reauthProcess = new QProcess(this);
-        QString *allOutput = new QString();
-        bool *urlOpened = new bool(false);
-        QMetaObject::Connection *readConnection = new QMetaObject::Connection();
-
-        // Read output as it comes
-        *readConnection = connect(reauthProcess, &QProcess::readyReadStandardOutput, this, [reauthProcess, allOutput, urlOpened, readConnection, this]() {
-            QString newOutput = QString::fromUtf8(reauthProcess->readAllStandardOutput());
-            *allOutput += newOutput;
-
-            // Check if URL appeared in the NEW output (not the accumulated output)
-            QRegularExpression urlRegex(QStringLiteral("https://[^\\s]+"));
-            auto urlMatch = urlRegex.match(newOutput);
-
-            if (urlMatch.hasMatch() && !*urlOpened) {
-                QString url = urlMatch.captured(0);
-                *urlOpened = true;
-
-                // Disconnect this signal immediately to prevent duplicate triggers
-                disconnect(*readConnection);
-
-                // NOTE: Don't open browser - warp-cli already opens it automatically
-                // Just show notification that browser was opened
-
-                // Show non-blocking notification
-                QMessageBox *msgBox = new QMessageBox(this);
-                msgBox->setWindowTitle(QStringLiteral("Browser Opened"));
-                msgBox->setIcon(QMessageBox::Information);
-                msgBox->setText(QStringLiteral("Complete authentication in browser"));
-                msgBox->setInformativeText(
-                    QStringLiteral("Browser opened to:\n") + url + QStringLiteral("\n\n"
-                                  "Complete the authentication to refresh your session.")
-                );
-                msgBox->setStandardButtons(QMessageBox::Ok);
-                msgBox->setAttribute(Qt::WA_DeleteOnClose);
-                msgBox->setModal(false);
-                msgBox->show();
-            }
-        });
 
-        connect(reauthProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                this, [this, reauthProcess, allOutput, urlOpened, readConnection](int exitCode, QProcess::ExitStatus exitStatus) {
-            *allOutput += QString::fromUtf8(reauthProcess->readAllStandardOutput());
-            *allOutput += QString::fromUtf8(reauthProcess->readAllStandardError());
-
-            if (exitCode == 0) {
-                if (*urlOpened) {
-                    // URL was opened - user already got the "Browser Opened" notification
-                    // Don't show another popup, just refresh silently
-                } else {
-                    // Command succeeded but no URL (might already be authenticated)
-                    QMessageBox::information(this, QStringLiteral("Re-Authentication Complete"),
-                                           QStringLiteral("Re-authentication completed successfully."));
-                }
-                refreshSettings();
-                emit settingsChanged();
-            } else {
-                // Show the actual error message from warp-cli
-                QString errorMsg = *allOutput;
-                if (errorMsg.isEmpty()) {
-                    errorMsg = QStringLiteral("Failed to re-authenticate. Please try logging out and enrolling again.");
-                }
-                QMessageBox::warning(this, QStringLiteral("Re-Authentication Failed"), errorMsg.trimmed());
-            }
-
-            delete allOutput;
-            delete urlOpened;
-            delete readConnection;
-            reauthProcess->deleteLater();
+            runWarpCommand({QStringLiteral("connect")}, [this, reauthenticate](const WarpResult &) {
+                // Give the tunnel a moment to come up
+                QMessageBox::information(this, QStringLiteral("Connecting"),
+                    QStringLiteral("Connecting to WARP...\n\nClick OK to continue with re-authentication."));
+                reauthenticate();
+            });
         });
-
-        reauthProcess->start(QStringLiteral("warp-cli"), {QStringLiteral("debug"), QStringLiteral("access-reauth")});
     });
     teamsLayout->addWidget(reauthBtn);
 
@@ -600,7 +838,7 @@ void PreferencesDialog::createAccountPage() {
 
     auto *logoutDesc = new QLabel(QStringLiteral("Remove this device from your Zero Trust organization."));
     logoutDesc->setWordWrap(true);
-    logoutDesc->setStyleSheet(QStringLiteral("color: #999; font-size: 11px; margin-bottom: 5px;"));
+    Theme::setState(logoutDesc, "role", QStringLiteral("groupDescription"));
     teamsLayout->addWidget(logoutDesc);
 
     auto *logoutBtn = new QPushButton(QStringLiteral("Log Out from Organization"));
@@ -615,25 +853,23 @@ void PreferencesDialog::createAccountPage() {
             // To log out from Teams while keeping device registered:
             // 1. Delete current registration (which is enrolled in Teams)
             // 2. Re-register without organization (regular WARP account)
-            
-            QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("registration"), QStringLiteral("delete")});
-            
-            // Wait a moment for deletion to complete
-            QThread::msleep(500);
-            
-            // Re-register as a regular WARP device (no organization)
-            int exitCode = QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("registration"), QStringLiteral("new")});
-            
-            if (exitCode == 0) {
-                QMessageBox::information(this, QStringLiteral("Logged Out"), 
-                    QStringLiteral("Successfully logged out from Zero Trust organization.\n\nYour device is now registered with regular WARP."));
-            } else {
-                QMessageBox::warning(this, QStringLiteral("Registration Error"), 
-                    QStringLiteral("Logged out from organization but failed to re-register.\n\nPlease manually register using 'warp-cli registration new'."));
-            }
-            
-            refreshSettings();
-            emit settingsChanged();
+            runWarpCommand({QStringLiteral("registration"), QStringLiteral("delete")}, [this](const WarpResult &) {
+                // Give the deletion a moment to settle before registering again
+                QTimer::singleShot(500, this, [this]() {
+                    runWarpCommand({QStringLiteral("registration"), QStringLiteral("new")}, [this](const WarpResult &result) {
+                        if (result.succeeded()) {
+                            QMessageBox::information(this, QStringLiteral("Logged Out"),
+                                QStringLiteral("Successfully logged out from Zero Trust organization.\n\nYour device is now registered with regular WARP."));
+                        } else {
+                            QMessageBox::warning(this, QStringLiteral("Registration Error"),
+                                QStringLiteral("Logged out from organization but failed to re-register.\n\nPlease manually register using 'warp-cli registration new'."));
+                        }
+
+                        refreshSettings();
+                        emit settingsChanged();
+                    });
+                });
+            });
         }
     });
     teamsLayout->addWidget(logoutBtn);
@@ -649,10 +885,10 @@ void PreferencesDialog::createAccountPage() {
     // Store the account status label for updates
     page->setProperty("accountStatusLabel", QVariant::fromValue(accountStatusLabel));
 
-    m_contentStack->addWidget(page);
+    return page;
 }
 
-void PreferencesDialog::createConnectionPage() {
+QWidget *PreferencesDialog::createConnectionPage() {
     auto *page = new QWidget();
     auto *layout = new QVBoxLayout(page);
     layout->setContentsMargins(30, 30, 30, 30);
@@ -677,7 +913,7 @@ void PreferencesDialog::createConnectionPage() {
 
     auto *excludeDesc = new QLabel(QStringLiteral("WARP will pause when connected to these WiFi networks:"));
     excludeDesc->setWordWrap(true);
-    excludeDesc->setStyleSheet(QStringLiteral("color: #999; font-size: 11px;"));
+    Theme::setState(excludeDesc, "role", QStringLiteral("description"));
     excludeLayout->addWidget(excludeDesc);
 
     m_excludedNetworksList = new QListWidget();
@@ -738,7 +974,7 @@ void PreferencesDialog::createConnectionPage() {
 
     auto *familiesDesc = new QLabel(QStringLiteral("Filter malware and adult content"));
     familiesDesc->setWordWrap(true);
-    familiesDesc->setStyleSheet(QStringLiteral("color: #999; font-size: 11px;"));
+    Theme::setState(familiesDesc, "role", QStringLiteral("description"));
     familiesLayout->addRow(familiesDesc);
 
     consumerDnsLayout->addWidget(familiesGroup);
@@ -766,7 +1002,7 @@ void PreferencesDialog::createConnectionPage() {
                       "Example: if your endpoint is https://abc123def.cloudflare-gateway.com/dns-query\n"
                       "enter only: abc123def"));
     gatewayDesc->setWordWrap(true);
-    gatewayDesc->setStyleSheet(QStringLiteral("color: #999; font-size: 11px;"));
+    Theme::setState(gatewayDesc, "role", QStringLiteral("description"));
     gatewayLayout->addRow(gatewayDesc);
 
     zeroTrustDnsLayout->addWidget(gatewayGroup);
@@ -775,10 +1011,10 @@ void PreferencesDialog::createConnectionPage() {
 
     layout->addStretch();
 
-    m_contentStack->addWidget(page);
+    return page;
 }
 
-void PreferencesDialog::createAdvancedPage() {
+QWidget *PreferencesDialog::createAdvancedPage() {
     auto *page = new QWidget();
     auto *layout = new QVBoxLayout(page);
     layout->setContentsMargins(30, 30, 30, 30);
@@ -810,27 +1046,24 @@ void PreferencesDialog::createAdvancedPage() {
         QStringLiteral("Configure which traffic should bypass the WARP tunnel. "
                       "By default, local network traffic is excluded."));
     splitDesc->setWordWrap(true);
-    splitDesc->setStyleSheet(QStringLiteral("color: #999; font-size: 11px;"));
+    Theme::setState(splitDesc, "role", QStringLiteral("description"));
     splitTunnelLayout->addWidget(splitDesc);
 
     // View current split tunnel
     m_viewSplitTunnelBtn = new QPushButton(QStringLiteral("View Live Routing Dump"));
     connect(m_viewSplitTunnelBtn, &QPushButton::clicked, this, [this]() {
-        QProcess process;
-        process.start(QStringLiteral("warp-cli"), {QStringLiteral("tunnel"), QStringLiteral("dump")});
-        process.waitForFinished();
-        QString output = QString::fromUtf8(process.readAllStandardOutput());
-
-        if (process.exitCode() != 0) {
-            output = QStringLiteral("Error: WARP must be connected to view live routing dump.\n\n") +
-                     QString::fromUtf8(process.readAllStandardError());
-        }
+        runWarpQuery({QStringLiteral("tunnel"), QStringLiteral("dump")}, [this](const WarpResult &dump) {
+            QString output = dump.stdoutText();
+            if (!dump.succeeded()) {
+                output = QStringLiteral("Error: WARP must be connected to view live routing dump.\n\n") + failureText(dump);
+            }
 
-        QMessageBox msgBox(this);
-        msgBox.setWindowTitle(QStringLiteral("Live Routing Dump"));
-        msgBox.setText(output);
-        msgBox.setDetailedText(output);
-        msgBox.exec();
+            QMessageBox msgBox(this);
+            msgBox.setWindowTitle(QStringLiteral("Live Routing Dump"));
+            msgBox.setText(output);
+            msgBox.setDetailedText(output);
+            msgBox.exec();
+        });
     });
     splitTunnelLayout->addWidget(m_viewSplitTunnelBtn);
 
@@ -839,7 +1072,7 @@ void PreferencesDialog::createAdvancedPage() {
     splitTunnelLayout->addWidget(hostsLabel);
 
     auto *hostsDescLabel = new QLabel(QStringLiteral("Domains excluded from WARP tunnel (read-only):"));
-    hostsDescLabel->setStyleSheet(QStringLiteral("color: #999; font-size: 11px;"));
+    Theme::setState(hostsDescLabel, "role", QStringLiteral("description"));
     splitTunnelLayout->addWidget(hostsDescLabel);
 
     m_excludedHostsText = new QTextEdit();
@@ -855,8 +1088,14 @@ void PreferencesDialog::createAdvancedPage() {
                                             QStringLiteral("Hostname or domain:"), QLineEdit::Normal,
                                             QString(), &ok);
         if (ok && !host.isEmpty()) {
-            QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("tunnel"), QStringLiteral("host"), QStringLiteral("add"), host});
-            QMessageBox::information(this, QStringLiteral("Host Added"), QStringLiteral("Host added to split tunnel exclusions."));
+            runWarpCommand({QStringLiteral("tunnel"), QStringLiteral("host"), QStringLiteral("add"), host},
+                           [this](const WarpResult &result) {
+                if (result.succeeded()) {
+                    QMessageBox::information(this, QStringLiteral("Host Added"), QStringLiteral("Host added to split tunnel exclusions."));
+                } else {
+                    QMessageBox::warning(this, QStringLiteral("Add Host"), failureText(result));
+                }
+            });
         }
     });
     splitTunnelLayout->addWidget(addHostBtn);
@@ -868,7 +1107,7 @@ void PreferencesDialog::createAdvancedPage() {
     splitTunnelLayout->addWidget(ipsLabel);
 
     auto *ipsDescLabel = new QLabel(QStringLiteral("IP ranges excluded from tunnel (read-only):"));
-    ipsDescLabel->setStyleSheet(QStringLiteral("color: #999; font-size: 11px;"));
+    Theme::setState(ipsDescLabel, "role", QStringLiteral("description"));
     splitTunnelLayout->addWidget(ipsDescLabel);
 
     m_excludedIpsText = new QTextEdit();
@@ -884,8 +1123,14 @@ void PreferencesDialog::createAdvancedPage() {
                                           QStringLiteral("IP range (CIDR):"), QLineEdit::Normal,
                                           QString(), &ok);
         if (ok && !ip.isEmpty()) {
-            QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("tunnel"), QStringLiteral("ip"), QStringLiteral("add"), ip});
-            QMessageBox::information(this, QStringLiteral("IP Added"), QStringLiteral("IP range added to split tunnel exclusions."));
+            runWarpCommand({QStringLiteral("tunnel"), QStringLiteral("ip"), QStringLiteral("add"), ip},
+                           [this](const WarpResult &result) {
+                if (result.succeeded()) {
+                    QMessageBox::information(this, QStringLiteral("IP Added"), QStringLiteral("IP range added to split tunnel exclusions."));
+                } else {
+                    QMessageBox::warning(this, QStringLiteral("Add IP Range"), failureText(result));
+                }
+            });
         }
     });
     splitTunnelLayout->addWidget(addIpBtn);
@@ -897,33 +1142,36 @@ void PreferencesDialog::createAdvancedPage() {
     auto *diagLayout = new QVBoxLayout(diagGroup);
 
     auto *viewStatsBtn = new QPushButton(QStringLiteral("View Connection Statistics"));
-    connect(viewStatsBtn, &QPushButton::clicked, this, []() {
-        QProcess process;
-        process.start(QStringLiteral("warp-cli"), {QStringLiteral("tunnel"), QStringLiteral("stats")});
-        process.waitForFinished();
-        QString output = QString::fromUtf8(process.readAllStandardOutput());
-        QMessageBox::information(nullptr, QStringLiteral("Tunnel Stats"), output);
+    connect(viewStatsBtn, &QPushButton::clicked, this, [this]() {
+        runWarpQuery({QStringLiteral("tunnel"), QStringLiteral("stats")}, [](const WarpResult &result) {
+            QMessageBox::information(nullptr, QStringLiteral("Tunnel Stats"),
+                                     result.succeeded() ? result.stdoutText() : failureText(result));
+        });
     });
     diagLayout->addWidget(viewStatsBtn);
 
     auto *dnsStatsBtn = new QPushButton(QStringLiteral("View DNS Statistics"));
-    connect(dnsStatsBtn, &QPushButton::clicked, this, []() {
-        QProcess process;
-        process.start(QStringLiteral("warp-cli"), {QStringLiteral("dns"), QStringLiteral("stats")});
-        process.waitForFinished();
-        QString output = QString::fromUtf8(process.readAllStandardOutput());
-        QMessageBox::information(nullptr, QStringLiteral("DNS Stats"), output);
+    connect(dnsStatsBtn, &QPushButton::clicked, this, [this]() {
+        runWarpQuery({QStringLiteral("dns"), QStringLiteral("stats")}, [](const WarpResult &result) {
+            QMessageBox::information(nullptr, QStringLiteral("DNS Stats"),
+                                     result.succeeded() ? result.stdoutText() : failureText(result));
+        });
     });
     diagLayout->addWidget(dnsStatsBtn);
 
     auto *rotateKeysBtn = new QPushButton(QStringLiteral("Rotate Tunnel Keys"));
-    connect(rotateKeysBtn, &QPushButton::clicked, this, []() {
+    connect(rotateKeysBtn, &QPushButton::clicked, this, [this]() {
         auto reply = QMessageBox::question(nullptr, QStringLiteral("Rotate Keys"),
             QStringLiteral("Generate a new key-pair for the tunnel? This will maintain your registration."),
             QMessageBox::Yes | QMessageBox::No);
         if (reply == QMessageBox::Yes) {
-            QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("tunnel"), QStringLiteral("rotate-keys")});
-            QMessageBox::information(nullptr, QStringLiteral("Keys Rotated"), QStringLiteral("Tunnel keys have been rotated."));
+            runWarpCommand({QStringLiteral("tunnel"), QStringLiteral("rotate-keys")}, [](const WarpResult &result) {
+                if (result.succeeded()) {
+                    QMessageBox::information(nullptr, QStringLiteral("Keys Rotated"), QStringLiteral("Tunnel keys have been rotated."));
+                } else {
+                    QMessageBox::warning(nullptr, QStringLiteral("Rotate Keys"), failureText(result));
+                }
+            });
         }
     });
     diagLayout->addWidget(rotateKeysBtn);
@@ -933,140 +1181,168 @@ void PreferencesDialog::createAdvancedPage() {
     // Info label
     m_advancedInfoLabel = new QLabel();
     m_advancedInfoLabel->setWordWrap(true);
-    m_advancedInfoLabel->setStyleSheet(QStringLiteral("background: #2a2a2a; padding: 10px; border-radius: 5px; border: 1px solid #3a3a3a;"));
+    Theme::setState(m_advancedInfoLabel, "role", QStringLiteral("infoBox"));
     layout->addWidget(m_advancedInfoLabel);
 
     layout->addStretch();
 
-    m_contentStack->addWidget(page);
+    return page;
 }
 
-void PreferencesDialog::applyStyles() {
-    setStyleSheet(QStringLiteral(
-        "QDialog {"
-        "  background-color: #1e1e1e;"
-        "  color: #ffffff;"
-        "}"
-        "QListWidget {"
-        "  background-color: #2a2a2a;"
-        "  border: none;"
-        "  border-right: 1px solid #3a3a3a;"
-        "  outline: none;"
-        "}"
-        "QListWidget::item {"
-        "  padding: 12px 20px;"
-        "  border: none;"
-        "  color: #ffffff;"
-        "}"
-        "QListWidget::item:selected {"
-        "  background-color: #ff6a00;"
-        "  color: #ffffff;"
-        "}"
-        "QListWidget::item:hover {"
-        "  background-color: #3a3a3a;"
-        "}"
-        "QLabel {"
-        "  color: #ffffff;"
-        "  background: transparent;"
-        "}"
-        "QGroupBox {"
-        "  color: #ffffff;"
-        "  font-weight: bold;"
-        "  border: 1px solid #3a3a3a;"
-        "  border-radius: 5px;"
-        "  margin-top: 10px;"
-        "  padding-top: 10px;"
-        "  background-color: #2a2a2a;"
-        "}"
-        "QGroupBox::title {"
-        "  subcontrol-origin: margin;"
-        "  left: 10px;"
-        "  padding: 0 5px;"
-        "  color: #ff6a00;"
-        "}"
-        "QPushButton {"
-        "  background-color: #ff6a00;"
-        "  color: #ffffff;"
-        "  border: none;"
-        "  padding: 8px 16px;"
-        "  border-radius: 4px;"
-        "  font-weight: bold;"
-        "}"
-        "QPushButton:hover {"
-        "  background-color: #ff8533;"
-        "}"
-        "QPushButton:pressed {"
-        "  background-color: #cc5500;"
-        "}"
-        "QPushButton:disabled {"
-        "  background-color: #3a3a3a;"
-        "  color: #666666;"
-        "}"
-        "QComboBox {"
-        "  background-color: #2a2a2a;"
-        "  color: #ffffff;"
-        "  padding: 5px;"
-        "  border: 1px solid #3a3a3a;"
-        "  border-radius: 3px;"
-        "}"
-        "QComboBox::drop-down {"
-        "  border: none;"
-        "  background-color: #3a3a3a;"
-        "}"
-        "QComboBox::down-arrow {"
-        "  image: none;"
-        "  border-left: 4px solid transparent;"
-        "  border-right: 4px solid transparent;"
-        "  border-top: 6px solid #ffffff;"
-        "  width: 0;"
-        "  height: 0;"
-        "}"
-        "QComboBox QAbstractItemView {"
-        "  background-color: #2a2a2a;"
-        "  color: #ffffff;"
-        "  selection-background-color: #ff6a00;"
-        "  border: 1px solid #3a3a3a;"
-        "}"
-        "QTextEdit {"
-        "  background-color: #2a2a2a;"
-        "  color: #ffffff;"
-        "  border: 1px solid #3a3a3a;"
-        "  border-radius: 3px;"
-        "}"
-        "QCheckBox {"
-        "  color: #ffffff;"
-        "  spacing: 8px;"
-        "}"
-        "QCheckBox::indicator {"
-        "  width: 18px;"
-        "  height: 18px;"
-        "  border: 1px solid #3a3a3a;"
-        "  border-radius: 3px;"
-        "  background-color: #2a2a2a;"
-        "}"
-        "QCheckBox::indicator:checked {"
-        "  background-color: #ff6a00;"
-        "  border-color: #ff6a00;"
-        "}"
-        "QCheckBox::indicator:hover {"
-        "  border-color: #ff6a00;"
-        "}"
-    ));
+QWidget *PreferencesDialog::createPerformancePage() {
+    auto *page = new QWidget();
+    auto *layout = new QVBoxLayout(page);
+    layout->setContentsMargins(30, 30, 30, 30);
+    layout->setSpacing(20);
+
+    // Header
+    auto *header = new QLabel(QStringLiteral("Performance"));
+    QFont headerFont = header->font();
+    headerFont.setPointSize(16);
+    headerFont.setBold(true);
+    header->setFont(headerFont);
+    layout->addWidget(header);
+
+    auto *description = new QLabel(
+        QStringLiteral("Live measurements since warp-gui started. Slow warp-cli commands point at warp-svc; "
+                      "event loop stalls point at the GUI itself."));
+    description->setWordWrap(true);
+    Theme::setState(description, "role", QStringLiteral("description"));
+    layout->addWidget(description);
+
+    // Latency per warp-cli subcommand and per connectivity probe
+    auto *latencyGroup = new QGroupBox(QStringLiteral("Command Latency"));
+    auto *latencyLayout = new QVBoxLayout(latencyGroup);
+
+    const int rows = static_cast<int>(PerfCounters::Series::Count);
+    m_latencyTable = new QTableWidget(rows, 6);
+    m_latencyTable->setHorizontalHeaderLabels({QStringLiteral("Command"), QStringLiteral("Calls"),
+                                               QStringLiteral("p50"), QStringLiteral("p95"), QStringLiteral("p99"),
+                                               QStringLiteral("Max")});
+    m_latencyTable->verticalHeader()->hide();
+    m_latencyTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    m_latencyTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_latencyTable->setSelectionMode(QAbstractItemView::NoSelection);
+    m_latencyTable->setFocusPolicy(Qt::NoFocus);
+    for (int row = 0; row < rows; ++row) {
+        m_latencyTable->setItem(row, 0, new QTableWidgetItem(
+                                             PerfCounters::seriesName(static_cast<PerfCounters::Series>(row))));
+        for (int column = 1; column < 6; ++column) {
+            auto *item = new QTableWidgetItem();
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            m_latencyTable->setItem(row, column, item);
+        }
+    }
+    latencyLayout->addWidget(m_latencyTable);
+
+    auto *latencyDesc = new QLabel(
+        QStringLiteral("warp-cli commands are timed from launch to exit, probes from start to answer."));
+    latencyDesc->setWordWrap(true);
+    Theme::setState(latencyDesc, "role", QStringLiteral("description"));
+    latencyLayout->addWidget(latencyDesc);
+    layout->addWidget(latencyGroup, 1);
+
+    // Process-wide counters
+    auto *processGroup = new QGroupBox(QStringLiteral("Application"));
+    auto *processLayout = new QFormLayout(processGroup);
+
+    m_spawnRateLabel = new QLabel();
+    processLayout->addRow(QStringLiteral("Process spawns:"), m_spawnRateLabel);
+
+    m_pollLabel = new QLabel();
+    processLayout->addRow(QStringLiteral("Status polling:"), m_pollLabel);
+
+    m_cacheHitLabel = new QLabel();
+    processLayout->addRow(QStringLiteral("Cache hit rate:"), m_cacheHitLabel);
+
+    m_stallLabel = new QLabel();
+    processLayout->addRow(QStringLiteral("Event loop stalls:"), m_stallLabel);
+
+    m_rssLabel = new QLabel();
+    processLayout->addRow(QStringLiteral("Memory (RSS):"), m_rssLabel);
+
+    layout->addWidget(processGroup);
+
+    return page;
+}
+
+void PreferencesDialog::updatePerformance() {
+    if (!m_pages[PerformancePage]) {
+        return;
+    }
+
+    for (int row = 0; row < m_latencyTable->rowCount(); ++row) {
+        const PerfCounters::Summary summary =
+            PerfCounters::histogram(static_cast<PerfCounters::Series>(row)).summary();
+        const bool empty = summary.count == 0;
+        m_latencyTable->item(row, 1)->setText(QString::number(summary.count));
+        m_latencyTable->item(row, 2)->setText(empty ? QStringLiteral("–") : formatLatency(summary.p50Us));
+        m_latencyTable->item(row, 3)->setText(empty ? QStringLiteral("–") : formatLatency(summary.p95Us));
+        m_latencyTable->item(row, 4)->setText(empty ? QStringLiteral("–") : formatLatency(summary.p99Us));
+        m_latencyTable->item(row, 5)->setText(empty ? QStringLiteral("–") : formatLatency(summary.maxUs));
+    }
+
+    // Spawn rate over a sliding minute
+    const qint64 now = WarpStateCache::clockMs();
+    const quint64 spawns = PerfCounters::spawns();
+    m_spawnSamples.enqueue(qMakePair(now, spawns));
+    while (m_spawnSamples.size() > 2 && now - m_spawnSamples.head().first > 60000) {
+        m_spawnSamples.dequeue();
+    }
+    const qint64 windowMs = now - m_spawnSamples.head().first;
+    const quint64 recent = spawns - m_spawnSamples.head().second;
+    m_spawnRateLabel->setText(
+        windowMs > 0 ? QStringLiteral("%1 per minute (%2 total)")
+                           .arg(static_cast<double>(recent) * 60000.0 / static_cast<double>(windowMs), 0, 'f', 1)
+                           .arg(spawns)
+                     : QStringLiteral("%1 total").arg(spawns));
+
+    const int interval = PerfCounters::pollIntervalMs();
+    const QString reason =
+        PollScheduler::reasonName(static_cast<PollScheduler::Reason>(PerfCounters::pollReason()));
+    m_pollLabel->setText(interval < 0 ? QStringLiteral("Not polling (%1)").arg(reason)
+                                      : QStringLiteral("Every %1 (%2)").arg(formatLatency(qint64(interval) * 1000), reason));
+
+    const quint64 hits = PerfCounters::cacheHits();
+    const quint64 total = hits + PerfCounters::cacheMisses();
+    m_cacheHitLabel->setText(total ? QStringLiteral("%1% of %2 requests")
+                                         .arg(static_cast<double>(hits) * 100.0 / static_cast<double>(total), 0, 'f', 1)
+                                         .arg(total)
+                                   : QStringLiteral("No requests yet"));
+
+    const quint64 stalls = PerfCounters::stalls();
+    m_stallLabel->setText(stalls ? QStringLiteral("%1 over %2 ms, longest %3")
+                                       .arg(stalls)
+                                       .arg(PerfCounters::kStallThresholdMs)
+                                       .arg(formatLatency(PerfCounters::longestStallUs()))
+                                 : QStringLiteral("None over %1 ms").arg(PerfCounters::kStallThresholdMs));
+
+    const qint64 rss = PerfCounters::residentBytes();
+    m_rssLabel->setText(rss < 0 ? QStringLiteral("Unknown")
+                                : QStringLiteral("%1 MiB").arg(static_cast<double>(rss) / (1024.0 * 1024.0), 0, 'f', 1));
 }
 
 void PreferencesDialog::onCategoryChanged(int index) {
+    if (index < 0 || !ensurePage(index)) {
+        return;
+    }
     m_contentStack->setCurrentIndex(index);
-    if (index == 0 || index == 1 || index == 2) { // General, Connection, or Account page
-        refreshSettings();
-    } else if (index == 3) { // Connectivity page
+    m_performanceTimer->stop();
+    if (index == GeneralPage || index == ConnectionPage || index == AccountPage) {
+        loadState(false);
+    } else if (index == ConnectivityPage) {
         updateConnectivityStatus();
+        updateConnectionHistory();
+    } else if (index == PerformancePage) {
+        updatePerformance();
+        m_performanceTimer->start();
     }
 }
 
 void PreferencesDialog::onFamiliesModeConnectionChanged(int index) {
     QString mode = m_familiesModeComboConnection->itemData(index).toString();
-    QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("dns"), QStringLiteral("families"), mode});
-    emit settingsChanged();
+    runWarpCommand({QStringLiteral("dns"), QStringLiteral("families"), mode},
+                   [this](const WarpResult &) { emit settingsChanged(); });
 }
 
 void PreferencesDialog::onAddNetwork() {
@@ -1078,9 +1354,14 @@ void PreferencesDialog::onAddNetwork() {
                                                 QString(),
                                                 &ok).trimmed();
     if (ok && !networkName.isEmpty()) {
-        QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("trusted"), QStringLiteral("ssid"), QStringLiteral("add"), networkName});
-        m_excludedNetworksList->addItem(networkName);
-        emit settingsChanged();
+        runWarpCommand({QStringLiteral("trusted"), QStringLiteral("ssid"), QStringLiteral("add"), networkName},
+                       [this, networkName](const WarpResult &result) {
+            // The page may have been released while the command ran
+            if (result.succeeded() && m_excludedNetworksList) {
+                m_excludedNetworksList->addItem(networkName);
+            }
+            emit settingsChanged();
+        });
     }
 }
 
@@ -1088,9 +1369,16 @@ void PreferencesDialog::onRemoveNetwork() {
     QListWidgetItem *item = m_excludedNetworksList->currentItem();
     if (item) {
         QString networkName = item->text();
-        QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("trusted"), QStringLiteral("ssid"), QStringLiteral("remove"), networkName});
-        delete m_excludedNetworksList->takeItem(m_excludedNetworksList->currentRow());
-        emit settingsChanged();
+        runWarpCommand({QStringLiteral("trusted"), QStringLiteral("ssid"), QStringLiteral("remove"), networkName},
+                       [this, networkName](const WarpResult &result) {
+            if (result.succeeded() && m_excludedNetworksList) {
+                const QList<QListWidgetItem *> items = m_excludedNetworksList->findItems(networkName, Qt::MatchExactly);
+                if (!items.isEmpty()) {
+                    delete items.constFirst();
+                }
+            }
+            emit settingsChanged();
+        });
     }
 }
 
@@ -1098,122 +1386,174 @@ void PreferencesDialog::onDisableWifiChanged(bool checked) {
     if (checked) {
         // Checkbox checked = user wants to disable WARP on WiFi
         // So enable the "trusted wifi" feature (auto-disconnect on WiFi)
-        QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("trusted"), QStringLiteral("wifi"), QStringLiteral("enable")});
+        runWarpCommand({QStringLiteral("trusted"), QStringLiteral("wifi"), QStringLiteral("enable")},
+                       [this](const WarpResult &) { emit settingsChanged(); });
     } else {
         // Checkbox unchecked = user wants WARP to work on WiFi
         // So disable the "trusted wifi" feature
-        QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("trusted"), QStringLiteral("wifi"), QStringLiteral("disable")});
+        runWarpCommand({QStringLiteral("trusted"), QStringLiteral("wifi"), QStringLiteral("disable")},
+                       [this](const WarpResult &) { emit settingsChanged(); });
     }
-    emit settingsChanged();
 }
 
 void PreferencesDialog::onDisableEthernetChanged(bool checked) {
     if (checked) {
         // Checkbox checked = user wants to disable WARP on Ethernet
         // So enable the "trusted ethernet" feature (auto-disconnect on Ethernet)
-        QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("trusted"), QStringLiteral("ethernet"), QStringLiteral("enable")});
+        runWarpCommand({QStringLiteral("trusted"), QStringLiteral("ethernet"), QStringLiteral("enable")},
+                       [this](const WarpResult &) { emit settingsChanged(); });
     } else {
         // Checkbox unchecked = user wants WARP to work on Ethernet
         // So disable the "trusted ethernet" feature
-        QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("trusted"), QStringLiteral("ethernet"), QStringLiteral("disable")});
+        runWarpCommand({QStringLiteral("trusted"), QStringLiteral("ethernet"), QStringLiteral("disable")},
+                       [this](const WarpResult &) { emit settingsChanged(); });
     }
-    emit settingsChanged();
 }
 
 void PreferencesDialog::onGatewayDohChanged() {
     QString subdomain = m_gatewayDohInput->text().trimmed();
     if (!subdomain.isEmpty()) {
-        QProcess::execute(QStringLiteral("warp-cli"), {QStringLiteral("dns"), QStringLiteral("gateway-id"), QStringLiteral("set"), subdomain});
-        emit settingsChanged();
+        runWarpCommand({QStringLiteral("dns"), QStringLiteral("gateway-id"), QStringLiteral("set"), subdomain},
+                       [this](const WarpResult &) { emit settingsChanged(); });
     }
 }
 
 void PreferencesDialog::refreshSettings() {
-    // Get settings
-    QProcess process;
-    process.start(QStringLiteral("warp-cli"), {QStringLiteral("settings")});
-    process.waitForFinished();
-    m_currentSettings = QString::fromUtf8(process.readAllStandardOutput());
-
-    // Get status for account info
-    QProcess statusProcess;
-    statusProcess.start(QStringLiteral("warp-cli"), {QStringLiteral("status")});
-    statusProcess.waitForFinished();
-    QString statusOutput = QString::fromUtf8(statusProcess.readAllStandardOutput());
-
-    loadCurrentSettings(m_currentSettings);
-    updateAccountStatus(statusOutput);
+    // Called after a change was made, so cached state cannot be trusted
+    loadState(true);
 }
 
-void PreferencesDialog::loadCurrentSettings(const QString &settingsText) {
-    // Parse split tunnel exclusions
-    QStringList ipExclusions;
-    QStringList hostExclusions;
-
-    QRegularExpression excludeRegex(QStringLiteral("Exclude mode, with hosts/ips:([\\s\\S]*?)(?=\\n\\([^)]+\\)|$)"));
-    auto excludeMatch = excludeRegex.match(settingsText);
-    if (excludeMatch.hasMatch()) {
-        QString exclusions = excludeMatch.captured(1);
-        QStringList lines = exclusions.split(QLatin1Char('\n'), Qt::SkipEmptyParts);
-
-        for (const QString &line : lines) {
-            QString trimmed = line.trimmed();
-            if (trimmed.isEmpty()) continue;
-
-            // Check if it's an IP/CIDR or a hostname
-            if (trimmed.contains(QLatin1Char('/')) || trimmed.contains(QLatin1Char(':')) ||
-                QRegularExpression(QStringLiteral("^\\d+\\.\\d+\\.\\d+\\.\\d+")).match(trimmed).hasMatch()) {
-                ipExclusions.append(trimmed);
-            } else {
-                hostExclusions.append(trimmed);
-            }
+void PreferencesDialog::loadState(bool force) {
+    // With every entry fresh this starts no warp-cli and no trace request
+    auto *cache = WarpStateCache::instance();
+    const WarpStateCache::Entry entries[] = {WarpStateCache::Entry::Settings, WarpStateCache::Entry::TunnelStats,
+                                             WarpStateCache::Entry::Registration, WarpStateCache::Entry::Network};
+    for (WarpStateCache::Entry entry : entries) {
+        // Show what is cached now; fresh data lands in onStateUpdated
+        if (cache->hasData(entry)) {
+            onStateUpdated(entry);
+        }
+        if (force) {
+            cache->refresh(entry);
+        } else {
+            cache->request(entry);
         }
     }
 
-    // Parse fallback domains (these are also excluded)
-    QRegularExpression fallbackRegex(QStringLiteral("Fallback domains:([\\s\\S]*?)(?=\\n\\([^)]+\\)|$)"));
-    auto fallbackMatch = fallbackRegex.match(settingsText);
-    if (fallbackMatch.hasMatch()) {
-        QString domains = fallbackMatch.captured(1);
-        QStringList lines = domains.split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    // Colocation and public IP come from the Cloudflare trace probe
+    if (!m_probes->isRunning(ProbeEngine::Probe::Trace)) {
+        if (force) {
+            m_probes->run(ProbeEngine::Probe::Trace);
+        } else {
+            m_probes->request(ProbeEngine::Probe::Trace);
+        }
+    }
+}
 
-        for (const QString &line : lines) {
-            QString trimmed = line.trimmed();
-            if (!trimmed.isEmpty() && !hostExclusions.contains(trimmed)) {
-                hostExclusions.append(trimmed);
-            }
+void PreferencesDialog::onStateUpdated(WarpStateCache::Entry entry) {
+    switch (entry) {
+    case WarpStateCache::Entry::Settings:
+        loadCurrentSettings(WarpStateCache::instance()->settings());
+        updateModeInfo();
+        break;
+    case WarpStateCache::Entry::TunnelStats:
+        updateModeInfo();
+        break;
+    case WarpStateCache::Entry::Registration:
+        updateAccountStatus(WarpStateCache::instance()->text(entry));
+        break;
+    case WarpStateCache::Entry::Network:
+        updateConnectionType();
+        break;
+    case WarpStateCache::Entry::Status:
+        break;
+    }
+}
+
+void PreferencesDialog::onStateFailed(WarpStateCache::Entry entry, const WarpResult &result) {
+    switch (entry) {
+    case WarpStateCache::Entry::Settings:
+        setFieldUnavailable(m_statusLabel, result);
+        setFieldUnavailable(m_dnsProtocolLabel, result);
+        break;
+    case WarpStateCache::Entry::TunnelStats:
+        setFieldUnavailable(m_dnsProtocolLabel, result);
+        break;
+    case WarpStateCache::Entry::Registration:
+        setFieldUnavailable(m_deviceIdLabel, result);
+        if (QWidget *accountPage = m_pages[AccountPage]) {
+            setFieldUnavailable(accountPage->property("accountStatusLabel").value<QLabel*>(), result);
+        }
+        break;
+    case WarpStateCache::Entry::Network:
+        setFieldUnavailable(m_connectionTypeLabel, result);
+        break;
+    case WarpStateCache::Entry::Status:
+        break;
+    }
+}
+
+void PreferencesDialog::loadCurrentSettings(const WarpSettings &settings) {
+    // Fallback domains are also excluded, so list them with the hosts
+    QStringList hostExclusions = settings.exclude.hosts;
+    for (const QString &domain : settings.fallbackDomains) {
+        if (!hostExclusions.contains(domain)) {
+            hostExclusions.append(domain);
         }
     }
 
     // Update text areas
-    if (!ipExclusions.isEmpty()) {
-        m_excludedIpsText->setPlainText(ipExclusions.join(QLatin1Char('\n')));
+    if (m_pages[AdvancedPage]) {
+        if (!settings.exclude.addresses.isEmpty()) {
+            m_excludedIpsText->setPlainText(settings.exclude.addresses.join(QLatin1Char('\n')));
+        }
+        if (!hostExclusions.isEmpty()) {
+            m_excludedHostsText->setPlainText(hostExclusions.join(QLatin1Char('\n')));
+        }
+        m_advancedInfoLabel->setText(QStringLiteral("Current configuration loaded from warp-cli settings"));
     }
-    if (!hostExclusions.isEmpty()) {
-        m_excludedHostsText->setPlainText(hostExclusions.join(QLatin1Char('\n')));
+
+    if (!m_pages[ConnectionPage]) {
+        return;
     }
 
-    // Update info labels
-    m_advancedInfoLabel->setText(QStringLiteral("Current configuration loaded from warp-cli settings"));
+    // Reflect current values without re-running the change handlers
+    {
+        const QSignalBlocker blocker(m_familiesModeComboConnection);
+        const int familiesIndex = m_familiesModeComboConnection->findData(settings.familiesMode);
+        if (familiesIndex >= 0) {
+            m_familiesModeComboConnection->setCurrentIndex(familiesIndex);
+        }
+    }
+    if (settings.disabledForWifi) {
+        const QSignalBlocker blocker(m_disableWifiCheck);
+        m_disableWifiCheck->setChecked(*settings.disabledForWifi);
+    }
+    if (settings.disabledForEthernet) {
+        const QSignalBlocker blocker(m_disableEthernetCheck);
+        m_disableEthernetCheck->setChecked(*settings.disabledForEthernet);
+    }
+    if (!settings.trustedSsids.isEmpty()) {
+        m_excludedNetworksList->clear();
+        m_excludedNetworksList->addItems(settings.trustedSsids);
+    }
+    if (!settings.gatewayId.isEmpty() && !m_gatewayDohInput->hasFocus()) {
+        m_gatewayDohInput->setText(settings.gatewayId);
+    }
 }
 
-void PreferencesDialog::updateAccountStatus(const QString &statusText) {
+void PreferencesDialog::updateModeInfo() {
     // Get mode from settings for connection type
-    QString mode = QStringLiteral("Unknown");
-    QRegularExpression modeRegex(QStringLiteral("Mode:\\s*([\\w+]+)"));
-    auto modeMatch = modeRegex.match(m_currentSettings);
-    if (modeMatch.hasMatch()) {
-        mode = modeMatch.captured(1);
+    QString mode = WarpStateCache::instance()->settings().mode;
+    if (mode.isEmpty()) {
+        mode = QStringLiteral("Unknown");
     }
 
     // Update connection mode
-    m_statusLabel->setText(mode);
+    setFieldValue(m_statusLabel, mode);
 
     // Get DNS protocol from tunnel stats
-    QProcess tunnelProcess;
-    tunnelProcess.start(QStringLiteral("warp-cli"), {QStringLiteral("tunnel"), QStringLiteral("stats")});
-    tunnelProcess.waitForFinished();
-    QString tunnelOutput = QString::fromUtf8(tunnelProcess.readAllStandardOutput());
+    const QString tunnelOutput = WarpStateCache::instance()->text(WarpStateCache::Entry::TunnelStats);
 
     QString dnsProtocol = mode;
     if (tunnelOutput.contains(QStringLiteral("MASQUE"), Qt::CaseInsensitive)) {
@@ -1222,33 +1562,12 @@ void PreferencesDialog::updateAccountStatus(const QString &statusText) {
         dnsProtocol = QStringLiteral("WARP (WireGuard)");
     }
 
-    // Get colocation and public IP from Cloudflare trace
-    QProcess traceProcess;
-    traceProcess.start(QStringLiteral("curl"), {QStringLiteral("-s"), QStringLiteral("https://www.cloudflare.com/cdn-cgi/trace")});
-    traceProcess.waitForFinished();
-    QString traceOutput = QString::fromUtf8(traceProcess.readAllStandardOutput());
-
-    QString publicIp = QStringLiteral("N/A");
-    QString colo = QStringLiteral("N/A");
-
-    QRegularExpression ipRegex(QStringLiteral("ip=([^\\n]+)"));
-    auto ipMatch = ipRegex.match(traceOutput);
-    if (ipMatch.hasMatch()) {
-        publicIp = ipMatch.captured(1).trimmed();
-    }
-
-    QRegularExpression coloRegex(QStringLiteral("colo=([^\\n]+)"));
-    auto coloMatch = coloRegex.match(traceOutput);
-    if (coloMatch.hasMatch()) {
-        colo = coloMatch.captured(1).trimmed();
-    }
+    setFieldValue(m_dnsProtocolLabel, dnsProtocol);
+}
 
+void PreferencesDialog::updateConnectionType() {
     // Get connection type from network debug
-    QProcess networkProcess;
-    networkProcess.start(QStringLiteral("warp-cli"), {QStringLiteral("debug"), QStringLiteral("network")});
-    networkProcess.waitForFinished();
-    QString networkOutput = QString::fromUtf8(networkProcess.readAllStandardOutput());
-
+    const QString networkOutput = WarpStateCache::instance()->text(WarpStateCache::Entry::Network);
     QString connectionType = QStringLiteral("Unknown");
     if (networkOutput.contains(QStringLiteral("WiFi:"), Qt::CaseInsensitive)) {
         connectionType = QStringLiteral("Wi-Fi");
@@ -1256,12 +1575,61 @@ void PreferencesDialog::updateAccountStatus(const QString &statusText) {
         connectionType = QStringLiteral("Ethernet");
     }
 
-    // Get Device ID
-    QProcess regProcess;
-    regProcess.start(QStringLiteral("warp-cli"), {QStringLiteral("registration"), QStringLiteral("show")});
-    regProcess.waitForFinished();
-    QString regOutput = QString::fromUtf8(regProcess.readAllStandardOutput());
+    setFieldValue(m_connectionTypeLabel, connectionType);
+}
+
+void PreferencesDialog::runWarpCommand(const QStringList &args, std::function<void(const WarpResult &)> done) {
+    const QString requestId = QStringLiteral("prefs:command:%1").arg(m_nextWarpRequest++);
+    m_warpCallbacks.insert(requestId, std::move(done));
+    WarpStateCache::instance()->runCommand(requestId, args);
+}
+
+void PreferencesDialog::runWarpQuery(const QStringList &args, std::function<void(const WarpResult &)> done) {
+    const QString requestId = QStringLiteral("prefs:query:%1").arg(m_nextWarpRequest++);
+    m_warpCallbacks.insert(requestId, std::move(done));
+    WarpStateCache::instance()->run(requestId, args);
+}
+
+void PreferencesDialog::onWarpFinished(const QString &requestId, const WarpResult &result) {
+    if (const std::function<void(const WarpResult &)> done = m_warpCallbacks.take(requestId)) {
+        done(result);
+    }
+}
+
+void PreferencesDialog::setFieldLoading(QLabel *label) {
+    if (!label) {
+        return;
+    }
+    label->setText(QStringLiteral("Loading..."));
+    Theme::setState(label, "loading", true);
+}
+
+void PreferencesDialog::setFieldValue(QLabel *label, const QString &text) {
+    if (!label) {
+        return;
+    }
+    label->setText(text);
+    label->setToolTip(QString());
+    Theme::setState(label, "loading", false);
+}
+
+void PreferencesDialog::setFieldUnavailable(QLabel *label, const WarpResult &result) {
+    if (!label || !label->property("loading").toBool()) {
+        return;
+    }
+
+    QString reason = result.stderrText().trimmed();
+    if (result.outcome == WarpResult::Outcome::TimedOut) {
+        reason = QStringLiteral("warp-cli did not respond in time");
+    } else if (reason.isEmpty()) {
+        reason = QStringLiteral("warp-cli could not be run");
+    }
+    setFieldValue(label, QStringLiteral("Unavailable"));
+    label->setToolTip(reason);
+}
 
+void PreferencesDialog::updateAccountStatus(const QString &regOutput) {
+    // Get Device ID
     QString deviceId = QStringLiteral("N/A");
     QRegularExpression deviceIdRegex(QStringLiteral("Device ID:\\s*([^\\n]+)"));
     auto deviceIdMatch = deviceIdRegex.match(regOutput);
@@ -1270,11 +1638,7 @@ void PreferencesDialog::updateAccountStatus(const QString &statusText) {
     }
 
     // Update the labels directly
-    if (m_dnsProtocolLabel) m_dnsProtocolLabel->setText(dnsProtocol);
-    if (m_coloLabel) m_coloLabel->setText(colo);
-    if (m_connectionTypeLabel) m_connectionTypeLabel->setText(connectionType);
-    if (m_publicIpLabel) m_publicIpLabel->setText(publicIp);
-    if (m_deviceIdLabel) m_deviceIdLabel->setText(deviceId);
+    setFieldValue(m_deviceIdLabel, deviceId);
 
     // Update Account page status
     QString accountStatusText;
@@ -1311,50 +1675,36 @@ void PreferencesDialog::updateAccountStatus(const QString &statusText) {
                          regOutput.contains(QStringLiteral("Organization:"), Qt::CaseInsensitive);
 
     // Update the Account page label
-    if (m_contentStack->count() > 2) {
-        auto *accountPage = m_contentStack->widget(2); // Account page is at index 2
-        if (accountPage) {
-            auto *accountLabel = accountPage->property("accountStatusLabel").value<QLabel*>();
-            if (accountLabel) {
-                if (regOutput.contains(QStringLiteral("No registration found"), Qt::CaseInsensitive)) {
-                    accountLabel->setText(QStringLiteral("<span style='color:#ff6a00'><b>Not Registered</b></span><br>Please register your device to use WARP."));
-                } else {
-                    accountLabel->setText(accountStatusText);
-                }
+    if (QWidget *accountPage = m_pages[AccountPage]) {
+        auto *accountLabel = accountPage->property("accountStatusLabel").value<QLabel*>();
+        if (accountLabel) {
+            if (regOutput.contains(QStringLiteral("No registration found"), Qt::CaseInsensitive)) {
+                setFieldValue(accountLabel, QStringLiteral("<span style='color:#ff6a00'><b>Not Registered</b></span><br>Please register your device to use WARP."));
+            } else {
+                setFieldValue(accountLabel, accountStatusText);
             }
+        }
 
-            // Show/hide Registration group (show when not registered OR registered but not with a team)
-            auto *registrationGroup = accountPage->property("registrationGroup").value<QGroupBox*>();
-            bool isRegistered = !regOutput.contains(QStringLiteral("No registration found"), Qt::CaseInsensitive);
-            if (registrationGroup) {
-                // Show registration options when: not registered OR registered but not in a team
-                registrationGroup->setVisible(!isRegistered || !isTeamsAccount);
-            }
+        // Show/hide Registration group (show when not registered OR registered but not with a team)
+        auto *registrationGroup = accountPage->property("registrationGroup").value<QGroupBox*>();
+        bool isRegistered = !regOutput.contains(QStringLiteral("No registration found"), Qt::CaseInsensitive);
+        if (registrationGroup) {
+            // Show registration options when: not registered OR registered but not in a team
+            registrationGroup->setVisible(!isRegistered || !isTeamsAccount);
+        }
 
-            // Show/hide Teams account management group (only show when registered with Teams)
-            auto *teamsGroup = accountPage->property("teamsGroup").value<QGroupBox*>();
-            if (teamsGroup) {
-                teamsGroup->setVisible(isTeamsAccount && isRegistered);
-            }
+        // Show/hide Teams account management group (only show when registered with Teams)
+        auto *teamsGroup = accountPage->property("teamsGroup").value<QGroupBox*>();
+        if (teamsGroup) {
+            teamsGroup->setVisible(isTeamsAccount && isRegistered);
         }
     }
 
     // Update Zero Trust enrollment status and Connection page visibility
-    m_isZeroTrust = isZeroTrustEnrolled();
+    m_isZeroTrust = isTeamsAccount;
     updateConnectionPageVisibility();
 }
 
-bool PreferencesDialog::isZeroTrustEnrolled() {
-    QProcess process;
-    process.start(QStringLiteral("warp-cli"), {QStringLiteral("registration"), QStringLiteral("show")});
-    process.waitForFinished();
-    QString output = QString::fromUtf8(process.readAllStandardOutput());
-
-    // Check for Zero Trust indicators
-    return output.contains(QStringLiteral("Account type: Team"), Qt::CaseInsensitive) ||
-           output.contains(QStringLiteral("Organization:"), Qt::CaseInsensitive);
-}
-
 void PreferencesDialog::updateConnectionPageVisibility() {
     // Show/hide widgets based on Zero Trust enrollment
     if (m_networkExclusionWidget) {
@@ -1369,74 +1719,129 @@ void PreferencesDialog::updateConnectionPageVisibility() {
 }
 
 void PreferencesDialog::updateConnectivityStatus() {
-    // Check API Connectivity (try to reach Cloudflare API endpoints)
-    QProcess apiProcess;
-    apiProcess.start(QStringLiteral("curl"), {
-        QStringLiteral("-s"),
-        QStringLiteral("-m"), QStringLiteral("3"),
-        QStringLiteral("-o"), QStringLiteral("/dev/null"),
-        QStringLiteral("-w"), QStringLiteral("%{http_code}"),
-        QStringLiteral("https://api.cloudflare.com/client/v4/user/tokens/verify")
-    });
-    apiProcess.waitForFinished(5000);
-    QString apiResponse = QString::fromUtf8(apiProcess.readAllStandardOutput()).trimmed();
-
-    if (apiResponse == QStringLiteral("400") || apiResponse == QStringLiteral("403") ||
-        apiResponse == QStringLiteral("401") || apiResponse.startsWith(QStringLiteral("2"))) {
-        // Any HTTP response means we can reach the API
-        m_apiConnectivityLabel->setText(QStringLiteral("<span style='color:#00ff00'>Connected</span>"));
-    } else {
-        m_apiConnectivityLabel->setText(QStringLiteral("<span style='color:#ff0000'>Not Connected</span>"));
+    for (QLabel *label : {m_apiConnectivityLabel, m_dnsConnectivityLabel, m_warpConnectivityLabel,
+                          m_coloConnectivityLabel}) {
+        label->setText(QStringLiteral("Checking..."));
     }
 
-    // Check DNS Connectivity (try to resolve cloudflare.com using 1.1.1.1)
-    QProcess dnsProcess;
-    dnsProcess.start(QStringLiteral("dig"), {
-        QStringLiteral("@1.1.1.1"),
-        QStringLiteral("+short"),
-        QStringLiteral("+time=2"),
-        QStringLiteral("cloudflare.com")
-    });
-    dnsProcess.waitForFinished(5000);
-    QString dnsOutput = QString::fromUtf8(dnsProcess.readAllStandardOutput()).trimmed();
+    // Results stream into onProbeFinished as each check completes
+    m_probes->runAll();
+}
 
-    if (!dnsOutput.isEmpty() && dnsProcess.exitCode() == 0) {
-        m_dnsConnectivityLabel->setText(QStringLiteral("<span style='color:#00ff00'>Connected</span>"));
-    } else {
-        m_dnsConnectivityLabel->setText(QStringLiteral("<span style='color:#ff0000'>Not Connected</span>"));
+void PreferencesDialog::updateConnectionHistory() {
+    if (!m_pages[ConnectivityPage]) {
+        return;
     }
 
-    // Check WARP Connectivity (use warp-cli status)
-    QProcess warpProcess;
-    warpProcess.start(QStringLiteral("warp-cli"), {QStringLiteral("status")});
-    warpProcess.waitForFinished(5000);
-    QString warpOutput = QString::fromUtf8(warpProcess.readAllStandardOutput());
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const ConnectionLog::Analysis analysis = ConnectionLog::analyze(now);
+
+    const auto addRow = [this](const QString &label, const ConnectionLog::Period &period) {
+        const int row = m_historyTable->rowCount();
+        m_historyTable->insertRow(row);
+        const double uptime = period.uptime();
+        const QStringList cells{label,
+                                uptime < 0 ? QStringLiteral("–") : QStringLiteral("%1%").arg(uptime * 100.0, 0, 'f', 1),
+                                formatDuration(period.observedMs), QString::number(period.drops)};
+        for (int column = 0; column < cells.size(); ++column) {
+            auto *item = new QTableWidgetItem(cells.at(column));
+            if (column > 0) {
+                item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            }
+            m_historyTable->setItem(row, column, item);
+        }
+    };
+
+    m_historyTable->setRowCount(0);
+    for (int i = 0; i < analysis.days.size(); ++i) {
+        const QDate day = QDateTime::fromMSecsSinceEpoch(analysis.days.at(i).startMs).date();
+        const QString label = i == 0   ? QStringLiteral("Today")
+                              : i == 1 ? QStringLiteral("Yesterday")
+                                       : QLocale().toString(day, QStringLiteral("dddd"));
+        addRow(label, analysis.days.at(i));
+    }
+    for (int i = 0; i < analysis.weeks.size(); ++i) {
+        const QString label = i == 0 ? QStringLiteral("Last 7 days")
+                                     : QStringLiteral("%1–%2 days ago").arg(7 * i).arg(7 * (i + 1));
+        addRow(label, analysis.weeks.at(i));
+    }
 
-    if (warpOutput.contains(QStringLiteral("Status update: Connected"), Qt::CaseInsensitive) ||
-        warpOutput.contains(QStringLiteral("\"status\": \"Connected\""), Qt::CaseInsensitive)) {
-        m_warpConnectivityLabel->setText(QStringLiteral("<span style='color:#00ff00'>Connected</span>"));
-    } else if (warpOutput.contains(QStringLiteral("Connecting"), Qt::CaseInsensitive)) {
-        m_warpConnectivityLabel->setText(QStringLiteral("<span style='color:#ffaa00'>Connecting...</span>"));
+    if (analysis.records == 0) {
+        m_mtbfLabel->setText(QStringLiteral("No history yet"));
+    } else if (analysis.mtbfMs < 0) {
+        m_mtbfLabel->setText(QStringLiteral("No drops in %1 connected").arg(formatDuration(analysis.total.connectedMs)));
     } else {
-        m_warpConnectivityLabel->setText(QStringLiteral("<span style='color:#888888'>Disconnected</span>"));
+        m_mtbfLabel->setText(QStringLiteral("%1 (%2 drops since %3)")
+                                 .arg(formatDuration(analysis.mtbfMs))
+                                 .arg(analysis.total.drops)
+                                 .arg(QLocale().toString(QDateTime::fromMSecsSinceEpoch(analysis.firstMs).date(),
+                                                         QLocale::ShortFormat)));
     }
 
-    // Get Colocation Center from Cloudflare trace
-    QProcess traceProcess;
-    traceProcess.start(QStringLiteral("curl"), {
-        QStringLiteral("-s"),
-        QStringLiteral("-m"), QStringLiteral("3"),
-        QStringLiteral("https://www.cloudflare.com/cdn-cgi/trace")
-    });
-    traceProcess.waitForFinished(5000);
-    QString traceOutput = QString::fromUtf8(traceProcess.readAllStandardOutput());
+    QStringList reasons;
+    for (const ConnectionLog::ReasonCount &reason : analysis.reasons) {
+        reasons.append(QStringLiteral("%1 (%2)").arg(reason.reason).arg(reason.count));
+    }
+    m_reasonsLabel->setText(reasons.isEmpty() ? QStringLiteral("None recorded") : reasons.join(QLatin1Char('\n')));
+}
+
+void PreferencesDialog::onProbeFinished(ProbeEngine::Probe probe, const ProbeEngine::Report &report) {
+    const QString latency = report.timing.totalMs >= 0
+        ? QStringLiteral(" <span style='color:#888888'>(%1 ms)</span>").arg(report.timing.totalMs)
+        : QString();
+    const QString connected = QStringLiteral("<span style='color:#00ff00'>Connected</span>") + latency;
+    const QString notConnected = QStringLiteral("<span style='color:#ff0000'>Not Connected</span>");
+    const QString notResponding = QStringLiteral("<span style='color:#ffaa00'>Not responding</span>");
+
+    // Hovering a result shows where the time went, or why it failed
+    QString toolTip = ProbeEngine::describeTiming(report.timing);
+    if (!report.ok && !report.error.isEmpty()) {
+        toolTip = report.error;
+    }
 
-    QString colo = QStringLiteral("Unknown");
-    QRegularExpression coloRegex(QStringLiteral("colo=([^\\n]+)"));
-    auto coloMatch = coloRegex.match(traceOutput);
-    if (coloMatch.hasMatch()) {
-        colo = coloMatch.captured(1).trimmed();
+    // The General page runs the trace on its own, before this page exists
+    if (probe != ProbeEngine::Probe::Trace && !m_pages[ConnectivityPage]) {
+        return;
     }
 
-    m_coloConnectivityLabel->setText(colo);
+    switch (probe) {
+    case ProbeEngine::Probe::Api:
+        // Any HTTP response, including auth errors, means we can reach the API
+        m_apiConnectivityLabel->setText(report.ok ? connected : report.timedOut ? notResponding : notConnected);
+        m_apiConnectivityLabel->setToolTip(toolTip);
+        break;
+    case ProbeEngine::Probe::Dns:
+        // Resolve cloudflare.com using 1.1.1.1
+        m_dnsConnectivityLabel->setText(report.ok ? connected : report.timedOut ? notResponding : notConnected);
+        m_dnsConnectivityLabel->setToolTip(report.ok ? QStringLiteral("cloudflare.com resolved to %1").arg(report.detail)
+                                                     : toolTip);
+        break;
+    case ProbeEngine::Probe::Warp: {
+        // Check WARP Connectivity (warp-cli status, as the cache last saw it)
+        const StatusSnapshot::State state = StatusSnapshot::stateFromStatus(report.detail.toUtf8());
+        if (report.timedOut) {
+            m_warpConnectivityLabel->setText(notResponding);
+        } else if (state == StatusSnapshot::State::Connected) {
+            m_warpConnectivityLabel->setText(connected);
+        } else if (state == StatusSnapshot::State::Connecting) {
+            m_warpConnectivityLabel->setText(QStringLiteral("<span style='color:#ffaa00'>Connecting...</span>"));
+        } else {
+            m_warpConnectivityLabel->setText(QStringLiteral("<span style='color:#888888'>Disconnected</span>"));
+        }
+        break;
+    }
+    case ProbeEngine::Probe::Trace: {
+        // The trace feeds both the General page and the Connectivity tab
+        const QString publicIp = QString::fromUtf8(report.fields.value("ip"));
+        setFieldValue(m_coloLabel, report.ok ? report.detail : QStringLiteral("N/A"));
+        setFieldValue(m_publicIpLabel, publicIp.isEmpty() ? QStringLiteral("N/A") : publicIp);
+
+        if (!m_pages[ConnectivityPage]) {
+            break;
+        }
+        m_coloConnectivityLabel->setText(report.ok ? report.detail + latency : QStringLiteral("Unknown"));
+        m_coloConnectivityLabel->setToolTip(toolTip);
+        break;
+    }
+    }
 }
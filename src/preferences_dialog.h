@@ -1,17 +1,28 @@
 #pragma once
 
 #include <QDialog>
+#include <QHash>
+#include <QPair>
+#include <QQueue>
 #include <QStackedWidget>
 #include <QString>
 
+#include <array>
+#include <functional>
+
+#include "probe_engine.h"
+#include "warp_state_cache.h"
+
 class QListWidget;
 class QListWidgetItem;
 class QLabel;
 class QLineEdit;
 class QComboBox;
 class QPushButton;
+class QTableWidget;
 class QTextEdit;
 class QCheckBox;
+class QTimer;
 class QWidget;
 
 class PreferencesDialog : public QDialog {
@@ -23,6 +34,10 @@ public:
 signals:
     void settingsChanged();
 
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
 private slots:
     void onCategoryChanged(int index);
     void onFamiliesModeConnectionChanged(int index);
@@ -34,62 +49,119 @@ private slots:
     void refreshSettings();
 
 private:
+    // Stack and sidebar order
+    enum Page {
+        GeneralPage,
+        ConnectionPage,
+        AccountPage,
+        ConnectivityPage,
+        AdvancedPage,
+        PerformancePage,
+        PageCount,
+    };
+
     void setupUi();
-    void createGeneralPage();
-    void createConnectivityPage();
-    void createConnectionPage();
-    void createAccountPage();
-    void createAdvancedPage();
-    void applyStyles();
-    void loadCurrentSettings(const QString &settingsText);
-    void updateAccountStatus(const QString &statusText);
+    // Pages are built the first time they are shown and can be released
+    // again while the dialog sits hidden; see releasePages()
+    QWidget *ensurePage(int index);
+    void releasePages();
+    void forgetPageWidgets(int index);
+    QWidget *createGeneralPage();
+    QWidget *createConnectivityPage();
+    QWidget *createConnectionPage();
+    QWidget *createAccountPage();
+    QWidget *createAdvancedPage();
+    QWidget *createPerformancePage();
+    // Shows cached warp-cli state and fetches whatever is stale, or
+    // everything when force is set
+    void loadState(bool force);
+    void onStateUpdated(WarpStateCache::Entry entry);
+    void onStateFailed(WarpStateCache::Entry entry, const WarpResult &result);
+    void loadCurrentSettings(const WarpSettings &settings);
+    void updateModeInfo();
+    void updateConnectionType();
+    // Run warp-cli on the engine thread and call done on this thread when it
+    // finishes, so no click waits on warp-svc. Commands also refresh every
+    // cached query afterwards.
+    void runWarpCommand(const QStringList &args, std::function<void(const WarpResult &)> done);
+    void runWarpQuery(const QStringList &args, std::function<void(const WarpResult &)> done);
+    void onWarpFinished(const QString &requestId, const WarpResult &result);
+    void setFieldLoading(QLabel *label);
+    void setFieldValue(QLabel *label, const QString &text);
+    // Replaces a "Loading..." placeholder after its query failed; fields that
+    // already show data keep it
+    void setFieldUnavailable(QLabel *label, const WarpResult &result);
+    void updateAccountStatus(const QString &regOutput);
     void updateConnectionPageVisibility();
     void updateConnectivityStatus();
-    bool isZeroTrustEnrolled();
+    // Uptime, drops and disconnect reasons from the connection log
+    void updateConnectionHistory();
+    void onProbeFinished(ProbeEngine::Probe probe, const ProbeEngine::Report &report);
+    void updatePerformance();
 
     QListWidget *m_sidebar;
     QStackedWidget *m_contentStack;
 
-    // General page widgets
-    QLabel *m_statusLabel;
-    QLabel *m_dnsProtocolLabel;
-    QLabel *m_coloLabel;
-    QLabel *m_connectionTypeLabel;
-    QLabel *m_publicIpLabel;
-    QLabel *m_deviceIdLabel;
+    // General page widgets. Each page's widgets stay null until it is built.
+    QLabel *m_statusLabel = nullptr;
+    QLabel *m_dnsProtocolLabel = nullptr;
+    QLabel *m_coloLabel = nullptr;
+    QLabel *m_connectionTypeLabel = nullptr;
+    QLabel *m_publicIpLabel = nullptr;
+    QLabel *m_deviceIdLabel = nullptr;
 
     // Connectivity page widgets
-    QLabel *m_apiConnectivityLabel;
-    QLabel *m_dnsConnectivityLabel;
-    QLabel *m_warpConnectivityLabel;
-    QLabel *m_coloConnectivityLabel;
-
+    QLabel *m_apiConnectivityLabel = nullptr;
+    QLabel *m_dnsConnectivityLabel = nullptr;
+    QLabel *m_warpConnectivityLabel = nullptr;
+    QLabel *m_coloConnectivityLabel = nullptr;
+    QTableWidget *m_historyTable = nullptr;
+    QLabel *m_mtbfLabel = nullptr;
+    QLabel *m_reasonsLabel = nullptr;
 
     // Connection page - Network exclusion (consumer only)
-    QWidget *m_networkExclusionWidget;
-    QListWidget *m_excludedNetworksList;
-    QPushButton *m_addNetworkBtn;
-    QPushButton *m_removeNetworkBtn;
-    QCheckBox *m_disableWifiCheck;
-    QCheckBox *m_disableEthernetCheck;
+    QWidget *m_networkExclusionWidget = nullptr;
+    QListWidget *m_excludedNetworksList = nullptr;
+    QPushButton *m_addNetworkBtn = nullptr;
+    QPushButton *m_removeNetworkBtn = nullptr;
+    QCheckBox *m_disableWifiCheck = nullptr;
+    QCheckBox *m_disableEthernetCheck = nullptr;
 
     // Connection page - Consumer only
-    QWidget *m_consumerDnsWidget;
-    QComboBox *m_familiesModeComboConnection;
+    QWidget *m_consumerDnsWidget = nullptr;
+    QComboBox *m_familiesModeComboConnection = nullptr;
 
     // Connection page - Zero Trust only
-    QWidget *m_zeroTrustDnsWidget;
-    QLineEdit *m_gatewayDohInput;
+    QWidget *m_zeroTrustDnsWidget = nullptr;
+    QLineEdit *m_gatewayDohInput = nullptr;
 
     // Split Tunnel page widgets
-    QTextEdit *m_excludedHostsText;
-    QTextEdit *m_excludedIpsText;
-    QPushButton *m_viewSplitTunnelBtn;
+    QTextEdit *m_excludedHostsText = nullptr;
+    QTextEdit *m_excludedIpsText = nullptr;
+    QPushButton *m_viewSplitTunnelBtn = nullptr;
 
     // Advanced page widgets
-    QCheckBox *m_autoConnectCheck;
-    QLabel *m_advancedInfoLabel;
+    QCheckBox *m_autoConnectCheck = nullptr;
+    QLabel *m_advancedInfoLabel = nullptr;
+
+    // Performance page widgets
+    QTableWidget *m_latencyTable = nullptr;
+    QLabel *m_spawnRateLabel = nullptr;
+    QLabel *m_pollLabel = nullptr;
+    QLabel *m_cacheHitLabel = nullptr;
+    QLabel *m_stallLabel = nullptr;
+    QLabel *m_rssLabel = nullptr;
+
+    std::array<QWidget *, PageCount> m_pages;
+    QTimer *m_idleTimer;
+    // Refreshes the Performance page while it is on screen
+    QTimer *m_performanceTimer;
+    // (time, spawn count) over the last minute, for the spawn rate
+    QQueue<QPair<qint64, quint64>> m_spawnSamples;
+    ProbeEngine *m_probes;
+    // Callbacks of runWarpCommand() and runWarpQuery() by request id
+    QHash<QString, std::function<void(const WarpResult &)>> m_warpCallbacks;
+    quint64 m_nextWarpRequest = 1;
 
-    QString m_currentSettings;
     bool m_isZeroTrust;
 };
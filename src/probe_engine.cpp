@@ -0,0 +1,288 @@
+#include "probe_engine.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSettings>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <QUrl>
+
+#include <memory>
+
+#include "dns_probe.h"
+#include "perf_counters.h"
+#include "warp_state_cache.h"
+
+namespace {
+
+PerfCounters::Series seriesFor(ProbeEngine::Probe probe) {
+    switch (probe) {
+    case ProbeEngine::Probe::Api:
+        return PerfCounters::Series::ProbeApi;
+    case ProbeEngine::Probe::Dns:
+        return PerfCounters::Series::ProbeDns;
+    case ProbeEngine::Probe::Warp:
+        return PerfCounters::Series::ProbeWarp;
+    case ProbeEngine::Probe::Trace:
+        return PerfCounters::Series::ProbeTrace;
+    }
+    return PerfCounters::Series::ProbeTrace;
+}
+
+// Shared by every engine and deliberately not owned by one, so closing the
+// dialog never waits for a probe that is still running
+class ProbePool : public QThreadPool {
+public:
+    ProbePool() { setMaxThreadCount(4); }
+};
+
+QThreadPool *probePool() {
+    static ProbePool pool;
+    return &pool;
+}
+
+constexpr int kHttpTimeoutMs = 3000;
+constexpr int kDnsTimeoutMs = 2000;
+constexpr int kWarpTimeoutMs = 5000;
+
+// Last successful report per probe, for request(). Engines live on the GUI
+// thread, so only that thread touches it.
+struct CachedReport {
+    ProbeEngine::Report report;
+    qint64 atMs = -1; // on WarpStateCache::clockMs()
+};
+
+QHash<ProbeEngine::Probe, CachedReport> &cachedReports() {
+    static QHash<ProbeEngine::Probe, CachedReport> reports;
+    return reports;
+}
+
+ProbeEngine::Report warpReport(const WarpStateCache &cache) {
+    const WarpResult result = cache.result(WarpStateCache::Entry::Status);
+    ProbeEngine::Report report;
+    report.ok = result.succeeded() && cache.isStatusValid();
+    report.detail = QString::fromUtf8(cache.status().status);
+    report.output = result.stdoutData;
+    report.error = result.stderrText();
+    return report;
+}
+
+} // namespace
+
+// Lets workers post results without racing the engine's destruction
+struct ProbeEngine::Inbox {
+    QMutex mutex;
+    ProbeEngine *engine = nullptr;
+};
+
+ProbeEngine::ProbeEngine(QObject *parent)
+    : QObject(parent),
+      m_pool(probePool()),
+      m_inbox(std::make_shared<Inbox>()),
+      m_nextGeneration(1) {
+    m_inbox->engine = this;
+}
+
+ProbeEngine::~ProbeEngine() {
+    QMutexLocker locker(&m_inbox->mutex);
+    m_inbox->engine = nullptr;
+}
+
+bool ProbeEngine::isRunning() const {
+    return !m_generations.isEmpty();
+}
+
+bool ProbeEngine::isRunning(Probe probe) const {
+    return m_generations.contains(probe);
+}
+
+void ProbeEngine::runAll() {
+    for (Probe probe : {Probe::Api, Probe::Dns, Probe::Warp, Probe::Trace}) {
+        run(probe);
+    }
+}
+
+void ProbeEngine::run(Probe probe) {
+    const quint64 generation = m_nextGeneration++;
+    m_generations.insert(probe, generation);
+    if (probe == Probe::Warp) {
+        runWarp(generation);
+        return;
+    }
+
+    const std::shared_ptr<Inbox> inbox = m_inbox;
+    m_pool->start([probe, generation, inbox]() {
+        const Report report = execute(probe);
+
+        QMutexLocker locker(&inbox->mutex);
+        if (ProbeEngine *engine = inbox->engine) {
+            QMetaObject::invokeMethod(engine, [engine, generation, probe, report]() {
+                engine->onRunFinished(generation, probe, report);
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+void ProbeEngine::request(Probe probe) {
+    const int ttl = ttlMs(probe);
+    const auto cached = cachedReports().constFind(probe);
+    if (ttl <= 0 || cached == cachedReports().constEnd() || WarpStateCache::clockMs() - cached->atMs > ttl) {
+        run(probe);
+        return;
+    }
+
+    // Keep delivery asynchronous, as for a real run
+    const quint64 generation = m_nextGeneration++;
+    m_generations.insert(probe, generation);
+    const Report report = cached->report;
+    QMetaObject::invokeMethod(this, [this, generation, probe, report]() {
+        deliver(generation, probe, report);
+    }, Qt::QueuedConnection);
+}
+
+int ProbeEngine::ttlMs(Probe probe) {
+    if (probe != Probe::Trace) {
+        return 0;
+    }
+    static const int traceTtlMs =
+        QSettings(QStringLiteral("warp-gui"), QStringLiteral("warp-gui"))
+            .value(QStringLiteral("probe/traceTtlMs"), 60000)
+            .toInt();
+    return traceTtlMs;
+}
+
+ProbeEngine::Report ProbeEngine::execute(Probe probe) {
+    Report report;
+
+    switch (probe) {
+    case Probe::Api: {
+        const HttpProbe::Result http =
+            HttpProbe::get(QUrl(QStringLiteral("https://api.cloudflare.com/client/v4/user/tokens/verify")),
+                           kHttpTimeoutMs);
+        // Any HTTP response means the API is reachable; auth errors are expected
+        const int code = http.statusCode;
+        report.ok = http.ok && ((code >= 200 && code < 300) || code == 400 || code == 401 || code == 403);
+        report.timing = http.timing;
+        report.error = http.error;
+        report.timedOut = !http.ok && http.timing.totalMs >= kHttpTimeoutMs;
+        break;
+    }
+    case Probe::Dns: {
+        const DnsProbe::Result dns =
+            DnsProbe::query(QStringLiteral("1.1.1.1"), QStringLiteral("cloudflare.com"), DnsProbe::A, kDnsTimeoutMs);
+        report.ok = dns.ok;
+        report.detail = dns.addresses.value(0);
+        report.timing.dnsMs = dns.latencyMs;
+        report.timing.totalMs = dns.latencyMs;
+        report.error = dns.error;
+        report.timedOut = !dns.ok && dns.rcode < 0 && dns.latencyMs >= kDnsTimeoutMs;
+        break;
+    }
+    case Probe::Warp:
+        // Answered on the GUI thread by runWarp()
+        break;
+    case Probe::Trace: {
+        const HttpProbe::Result http =
+            HttpProbe::get(QUrl(QStringLiteral("https://www.cloudflare.com/cdn-cgi/trace")), kHttpTimeoutMs);
+        report.fields = HttpProbe::parseKeyValues(http.body);
+        report.detail = QString::fromUtf8(report.fields.value("colo"));
+        report.ok = http.ok && http.statusCode == 200 && !report.detail.isEmpty();
+        report.timing = http.timing;
+        report.error = http.error;
+        report.timedOut = !http.ok && http.timing.totalMs >= kHttpTimeoutMs;
+        break;
+    }
+    }
+
+    if (report.timing.totalMs >= 0) {
+        PerfCounters::histogram(seriesFor(probe)).record(report.timing.totalMs * 1000);
+    }
+    return report;
+}
+
+void ProbeEngine::runWarp(quint64 generation) {
+    WarpStateCache *cache = WarpStateCache::instance();
+    if (cache->isFresh(WarpStateCache::Entry::Status)) {
+        // Nothing to measure; keep delivery asynchronous like the others
+        Report report = warpReport(*cache);
+        report.timing.totalMs = 0;
+        QMetaObject::invokeMethod(this, [this, generation, report]() {
+            deliver(generation, Probe::Warp, report);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    // Time the cache's round trip: refresh() through to the parsed status
+    // arriving here, folded into any identical fetch already running
+    auto *pending = new QObject(this);
+    auto clock = std::make_shared<QElapsedTimer>();
+    clock->start();
+    const auto finish = [this, pending, generation, clock](Report report) {
+        pending->deleteLater();
+        if (m_generations.value(Probe::Warp) != generation) {
+            return;
+        }
+        report.timing.totalMs = clock->elapsed();
+        PerfCounters::histogram(seriesFor(Probe::Warp)).record(report.timing.totalMs * 1000);
+        deliver(generation, Probe::Warp, report);
+    };
+
+    connect(cache, &WarpStateCache::updated, pending, [cache, finish](WarpStateCache::Entry entry) {
+        if (entry == WarpStateCache::Entry::Status) {
+            finish(warpReport(*cache));
+        }
+    });
+    connect(cache, &WarpStateCache::failed, pending,
+            [finish](WarpStateCache::Entry entry, const WarpResult &result) {
+                if (entry != WarpStateCache::Entry::Status) {
+                    return;
+                }
+                Report report;
+                report.timedOut = result.outcome == WarpResult::Outcome::TimedOut;
+                report.error = result.stderrText();
+                finish(report);
+            });
+    QTimer::singleShot(kWarpTimeoutMs, pending, [finish]() {
+        Report report;
+        report.timedOut = true;
+        finish(report);
+    });
+
+    cache->refresh(WarpStateCache::Entry::Status);
+}
+
+void ProbeEngine::onRunFinished(quint64 generation, Probe probe, const Report &report) {
+    // Any successful run, requested or not, renews what request() hands out
+    if (report.ok && ttlMs(probe) > 0) {
+        cachedReports().insert(probe, CachedReport{report, WarpStateCache::clockMs()});
+    }
+    deliver(generation, probe, report);
+}
+
+void ProbeEngine::deliver(quint64 generation, Probe probe, const Report &report) {
+    if (m_generations.value(probe) != generation) {
+        return;
+    }
+    m_generations.remove(probe);
+
+    emit probeFinished(probe, report);
+    if (m_generations.isEmpty()) {
+        emit allFinished();
+    }
+}
+
+QString ProbeEngine::describeTiming(const HttpProbe::Timing &timing) {
+    QStringList parts;
+    const auto add = [&parts](const QString &label, qint64 ms) {
+        if (ms >= 0) {
+            parts.append(QStringLiteral("%1 %2 ms").arg(label).arg(ms));
+        }
+    };
+    add(QStringLiteral("DNS"), timing.dnsMs);
+    add(QStringLiteral("connect"), timing.connectMs);
+    add(QStringLiteral("TLS"), timing.tlsMs);
+    add(QStringLiteral("first byte"), timing.firstByteMs);
+    add(QStringLiteral("total"), timing.totalMs);
+    return parts.join(QStringLiteral(", "));
+}
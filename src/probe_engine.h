@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+#include <memory>
+
+#include "http_probe.h"
+
+class QThreadPool;
+
+// Runs the Connectivity tab's checks in parallel on worker threads. Each
+// probe has its own deadline and reports back as soon as it finishes. The
+// Warp probe is the exception: it reads warp-cli status through
+// WarpStateCache, so it shares the cache's fetches instead of spawning.
+class ProbeEngine : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Probe {
+        Api,   // HTTPS request to the Cloudflare API
+        Dns,   // A query for cloudflare.com sent to 1.1.1.1
+        Warp,  // warp-cli status, through WarpStateCache
+        Trace, // cdn-cgi/trace for public IP and colocation center
+    };
+    Q_ENUM(Probe)
+
+    struct Report {
+        bool ok = false;
+        bool timedOut = false;
+        QString detail;                       // first resolved address, colo, status word, ...
+        QHash<QByteArray, QByteArray> fields; // parsed trace body
+        QByteArray output;                    // warp-cli -j status output for Probe::Warp
+        HttpProbe::Timing timing;             // dnsMs doubles as the DNS query time
+        QString error;
+    };
+
+    explicit ProbeEngine(QObject *parent = nullptr);
+    ~ProbeEngine() override;
+
+    // Starts every probe, or just one. Results of an earlier run of the same
+    // probe that are still in flight are discarded when they arrive.
+    void runAll();
+    void run(Probe probe);
+    // Like run(), but while the last successful report of probe is younger
+    // than its TTL that report is delivered instead. Only the trace has one
+    // (probe/traceTtlMs, default 60000); every other probe always runs.
+    void request(Probe probe);
+    bool isRunning() const;
+    bool isRunning(Probe probe) const;
+
+    // "DNS 3 ms, connect 12 ms, TLS 25 ms, first byte 40 ms"
+    static QString describeTiming(const HttpProbe::Timing &timing);
+
+signals:
+    void probeFinished(ProbeEngine::Probe probe, const ProbeEngine::Report &report);
+    void allFinished();
+
+private:
+    struct Inbox;
+
+    static Report execute(Probe probe);
+    void runWarp(quint64 generation);
+    void deliver(quint64 generation, Probe probe, const Report &report);
+    void onRunFinished(quint64 generation, Probe probe, const Report &report);
+    static int ttlMs(Probe probe);
+
+    QThreadPool *m_pool;
+    std::shared_ptr<Inbox> m_inbox;
+    QHash<Probe, quint64> m_generations;
+    quint64 m_nextGeneration;
+};
@@ -0,0 +1,58 @@
+#include "process_runner.h"
+
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QTimer>
+
+#include "child_process.h"
+#include "perf_counters.h"
+
+WarpResult ProcessRunner::runBlocking(const QString &program, const QStringList &args, int timeoutMs) {
+    // Plain QProcess: the spawn helper only serves its owner thread, and the
+    // blocking waits below run no event loop at all
+    PerfCounters::noteSpawn();
+    QElapsedTimer elapsed;
+    elapsed.start();
+    QProcess process;
+    process.start(program, args);
+
+    WarpResult result;
+    if (!process.waitForStarted(timeoutMs)) {
+        result.outcome = WarpResult::Outcome::FailedToStart;
+        result.stderrData = process.errorString().toUtf8();
+        return result;
+    }
+
+    const int remainingMs = static_cast<int>(qMax<qint64>(0, timeoutMs - elapsed.elapsed()));
+    if (!process.waitForFinished(remainingMs) && process.state() != QProcess::NotRunning) {
+        // Give the process kKillGraceMs to exit after SIGTERM, then SIGKILL
+        result.outcome = WarpResult::Outcome::TimedOut;
+        process.terminate();
+        if (!process.waitForFinished(kKillGraceMs)) {
+            process.kill();
+            process.waitForFinished(-1);
+        }
+    }
+
+    result.exitCode = process.exitCode();
+    result.stdoutData = process.readAllStandardOutput();
+    result.stderrData = process.readAllStandardError();
+    return result;
+}
+
+void ProcessRunner::terminate(ChildProcess *proc, int graceMs) {
+    QObject::connect(proc, &ChildProcess::finished, proc, &QObject::deleteLater);
+    QObject::connect(proc, &ChildProcess::failedToStart, proc, &QObject::deleteLater);
+
+    if (!proc->isRunning()) {
+        proc->deleteLater();
+        return;
+    }
+
+    proc->terminate();
+    QTimer::singleShot(graceMs, proc, [proc]() {
+        if (proc->isRunning()) {
+            proc->kill();
+        }
+    });
+}
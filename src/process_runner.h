@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+#include "warp_transport.h"
+
+class ChildProcess;
+
+// Deadline handling shared by every place that launches a helper process.
+class ProcessRunner {
+public:
+    static constexpr int kDefaultTimeoutMs = 5000;
+    static constexpr int kKillGraceMs = 2000;
+
+    // Runs program to completion or until timeoutMs passes, whichever comes
+    // first. A process that overruns is terminated and reported as TimedOut.
+    // Blocks the calling thread without running its event loop, for up to
+    // timeoutMs plus kKillGraceMs: worker threads only, never the GUI thread.
+    static WarpResult runBlocking(const QString &program, const QStringList &args,
+                                  int timeoutMs = kDefaultTimeoutMs);
+
+    // Sends SIGTERM and escalates to SIGKILL if the process is still alive
+    // after graceMs. The process deletes itself once it has exited.
+    static void terminate(ChildProcess *proc, int graceMs = kKillGraceMs);
+};
@@ -0,0 +1,43 @@
+#include "quit_signals.h"
+
+#include <QCoreApplication>
+#include <QSocketNotifier>
+
+#include <csignal>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+int s_signalFds[2] = {-1, -1};
+
+void onSignal(int signal) {
+    // Restore the default so a stuck shutdown can still be interrupted
+    std::signal(signal, SIG_DFL);
+    const char byte = static_cast<char>(signal);
+    [[maybe_unused]] const ssize_t n = ::write(s_signalFds[0], &byte, 1);
+}
+
+} // namespace
+
+void QuitSignals::install() {
+    if (s_signalFds[0] >= 0 || ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, s_signalFds) != 0) {
+        return;
+    }
+
+    // The handler only writes a byte; quitting happens on the main thread
+    auto *notifier = new QSocketNotifier(s_signalFds[1], QSocketNotifier::Read, QCoreApplication::instance());
+    QObject::connect(notifier, &QSocketNotifier::activated, notifier, []() {
+        char byte;
+        [[maybe_unused]] const ssize_t n = ::read(s_signalFds[1], &byte, 1);
+        QCoreApplication::quit();
+    });
+
+    struct sigaction action {};
+    action.sa_handler = onSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGINT, &action, nullptr);
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// Turns SIGTERM and SIGINT into a normal QCoreApplication::quit(), so the
+// tray is torn down as on Quit: the connection log records the stop, the
+// status page and sockets are removed. A second signal while quitting
+// falls back to the default action.
+class QuitSignals {
+public:
+    // Needs a running application
+    static void install();
+};
@@ -29,44 +29,14 @@ SettingsMenu::SettingsMenu(QWidget *parent)
     // Add separator
     m_separator = new QWidget(this);
     m_separator->setFixedHeight(1);
-    m_separator->setStyleSheet(QStringLiteral("background-color: #3a3a3a;"));
+    m_separator->setObjectName(QStringLiteral("menuSeparator"));
     layout->addWidget(m_separator);
 
     layout->addWidget(m_preferencesBtn);
     layout->addWidget(m_aboutBtn);
     layout->addWidget(m_exitBtn);
 
-    // Style the menu
-    setStyleSheet(QStringLiteral(
-        "SettingsMenu {"
-        "  background-color: #2a2a2a;"
-        "  border: 1px solid #3a3a3a;"
-        "  border-radius: 8px;"
-        "}"
-        "QLabel {"
-        "  background: transparent;"
-        "  color: #ffffff;"
-        "  font-size: 13px;"
-        "}"
-        "QPushButton {"
-        "  background: transparent;"
-        "  border: none;"
-        "  color: #ffffff;"
-        "  padding: 10px 20px;"
-        "  text-align: left;"
-        "  font-size: 13px;"
-        "}"
-        "QPushButton:hover {"
-        "  background-color: #3a3a3a;"
-        "}"
-        "QPushButton:disabled {"
-        "  color: #666666;"
-        "}"
-        "QPushButton:last-child {"
-        "  border-bottom-left-radius: 8px;"
-        "  border-bottom-right-radius: 8px;"
-        "}"
-    ));
+    // Styled by the application theme; see theme.cpp
 
     connect(m_warpBtn, &QPushButton::clicked, this, [this]() {
         emit modeChangeRequested(QStringLiteral("warp"));
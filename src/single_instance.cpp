@@ -0,0 +1,147 @@
+#include "single_instance.h"
+
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QThread>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include "state_server.h"
+
+namespace {
+
+constexpr int kForwardTimeoutMs = 3000;
+
+// Held open until exit; closing it would release the lock
+int s_lockFd = -1;
+
+std::string lockPath() {
+    const char *dir = std::getenv("XDG_RUNTIME_DIR");
+    if (dir && *dir) {
+        return std::string(dir) + "/warp-gui.lock";
+    }
+    return "/tmp/warp-gui-" + std::to_string(::getuid()) + ".lock";
+}
+
+} // namespace
+
+bool SingleInstance::acquire() {
+    if (s_lockFd >= 0) {
+        return true;
+    }
+
+    const std::string path = lockPath();
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        std::fprintf(stderr, "warp-gui: cannot open %s: %s; not checking for other instances\n", path.c_str(),
+                     std::strerror(errno));
+        return true;
+    }
+
+    int result;
+    do {
+        result = ::flock(fd, LOCK_EX | LOCK_NB);
+    } while (result != 0 && errno == EINTR);
+
+    if (result != 0) {
+        const bool held = errno == EWOULDBLOCK;
+        if (!held) {
+            std::fprintf(stderr, "warp-gui: cannot lock %s: %s; not checking for other instances\n", path.c_str(),
+                         std::strerror(errno));
+        }
+        ::close(fd);
+        return !held;
+    }
+
+    s_lockFd = fd;
+    return true;
+}
+
+SingleInstance::Command SingleInstance::commandFromArguments(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--popup") == 0) {
+            return Command::ShowPopup;
+        }
+        if (std::strcmp(argv[i], "--preferences") == 0) {
+            return Command::OpenPreferences;
+        }
+        if (std::strcmp(argv[i], "--connect") == 0) {
+            return Command::Connect;
+        }
+        if (std::strcmp(argv[i], "--disconnect") == 0) {
+            return Command::Disconnect;
+        }
+    }
+    return Command::None;
+}
+
+QByteArray SingleInstance::requestName(Command command) {
+    switch (command) {
+    case Command::ShowPopup:
+        return QByteArrayLiteral("popup");
+    case Command::OpenPreferences:
+        return QByteArrayLiteral("preferences");
+    case Command::Connect:
+        return QByteArrayLiteral("connect");
+    case Command::Disconnect:
+        return QByteArrayLiteral("disconnect");
+    case Command::None:
+        break;
+    }
+    return QByteArray();
+}
+
+SingleInstance::Command SingleInstance::commandFromRequest(const QByteArray &request) {
+    for (Command command : {Command::ShowPopup, Command::OpenPreferences, Command::Connect, Command::Disconnect}) {
+        if (request == requestName(command)) {
+            return command;
+        }
+    }
+    return Command::None;
+}
+
+int SingleInstance::forward(Command command) {
+    // A plain second launch most likely means "show me warp-gui"
+    if (command == Command::None) {
+        command = Command::ShowPopup;
+    }
+
+    const QString path = StateServer::socketPath();
+    if (path.isEmpty()) {
+        std::fputs("warp-gui is already running, but there is no runtime directory to reach it\n", stderr);
+        return 1;
+    }
+
+    QLocalSocket socket;
+    QElapsedTimer clock;
+    clock.start();
+
+    // The primary may have just taken the lock and not be listening yet
+    for (;;) {
+        socket.connectToServer(path);
+        if (socket.waitForConnected(500)) {
+            break;
+        }
+        if (clock.elapsed() >= kForwardTimeoutMs) {
+            std::fputs("warp-gui is already running but does not answer\n", stderr);
+            return 1;
+        }
+        QThread::msleep(50);
+    }
+
+    socket.write(requestName(command) + '\n');
+    if (!socket.waitForBytesWritten(kForwardTimeoutMs) ||
+        (!socket.canReadLine() && !socket.waitForReadyRead(kForwardTimeoutMs))) {
+        std::fputs("warp-gui did not accept the request\n", stderr);
+        return 1;
+    }
+    return socket.readLine().trimmed() == QByteArrayLiteral("{\"ok\":true}") ? 0 : 1;
+}
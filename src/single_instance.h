@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QByteArray>
+
+// Keeps one warp-gui per user. The primary instance holds an flock on
+// $XDG_RUNTIME_DIR/warp-gui.lock for its whole life; the kernel drops it
+// when the process exits or crashes, so a stale lock cannot outlive its
+// owner. Later launches forward what they were asked to do to the primary
+// over StateServer's socket and exit.
+class SingleInstance {
+public:
+    enum class Command {
+        None,
+        ShowPopup,       // --popup, and a plain second launch
+        OpenPreferences, // --preferences
+        Connect,         // --connect
+        Disconnect,      // --disconnect
+    };
+
+    // Plain POSIX, safe to call before the spawn helper is forked. Returns
+    // false when another instance holds the lock. If the lock file cannot
+    // be created this instance carries on as the primary.
+    static bool acquire();
+
+    static Command commandFromArguments(int argc, char **argv);
+
+    // Request line understood by StateServer, e.g. "preferences"
+    static QByteArray requestName(Command command);
+    static Command commandFromRequest(const QByteArray &request);
+
+    // Sends command to the primary instance. Needs a QCoreApplication.
+    // Waits briefly for the primary's socket, which it opens only after
+    // taking the lock. Returns the process exit code.
+    static int forward(Command command);
+};
@@ -0,0 +1,214 @@
+#include "spawn_helper.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QSocketNotifier>
+#include <QThread>
+
+#include <atomic>
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "spawn_helper_server.h"
+
+namespace {
+int s_helperFd = -1;
+std::atomic<SpawnHelper *> s_instance{nullptr};
+std::atomic<QThread *> s_ownerThread{nullptr};
+
+bool writeAll(int fd, const char *data, qsizetype size) {
+    while (size > 0) {
+        const ssize_t n = ::write(fd, data, static_cast<size_t>(size));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+} // namespace
+
+void SpawnHelper::launch() {
+    if (s_helperFd >= 0 || qEnvironmentVariableIntValue("WARP_GUI_NO_SPAWN_HELPER") != 0) {
+        return;
+    }
+
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+        return;
+    }
+
+    const pid_t pid = ::fork();
+    if (pid < 0) {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        return;
+    }
+
+    if (pid == 0) {
+        ::close(fds[0]);
+        ::_exit(runSpawnHelperServer(fds[1]));
+    }
+
+    ::close(fds[1]);
+    s_helperFd = fds[0];
+}
+
+SpawnHelper *SpawnHelper::instance() {
+    // The client is created on the owner thread; other threads only look
+    SpawnHelper *helper = s_instance.load();
+    const QCoreApplication *app = QCoreApplication::instance();
+    QThread *owner = s_ownerThread.load();
+    if (!owner && app) {
+        owner = app->thread();
+    }
+    if (!helper && s_helperFd >= 0 && owner && QThread::currentThread() == owner) {
+        helper = new SpawnHelper(s_helperFd);
+        s_instance.store(helper);
+    }
+    return helper;
+}
+
+void SpawnHelper::setOwnerThread(QThread *thread) {
+    s_ownerThread.store(thread);
+}
+
+SpawnHelper::SpawnHelper(int fd, QObject *parent)
+    : QObject(parent),
+      m_notifier(new QSocketNotifier(fd, QSocketNotifier::Read, this)),
+      m_fd(fd),
+      m_nextId(1) {
+    connect(m_notifier, &QSocketNotifier::activated, this, &SpawnHelper::onReadable);
+}
+
+bool SpawnHelper::isAvailable() const {
+    return m_fd >= 0;
+}
+
+quint32 SpawnHelper::spawn(const QString &program, const QStringList &args) {
+    const quint32 id = m_nextId++;
+
+    QByteArray payload = program.toLocal8Bit();
+    for (const QString &arg : args) {
+        payload += '\0';
+        payload += arg.toLocal8Bit();
+    }
+
+    m_outstanding.insert(id);
+    if (!sendFrame(SpawnProtocol::Spawn, id, payload)) {
+        // Report asynchronously so the caller has recorded the id first
+        QMetaObject::invokeMethod(this, [this]() { onHelperLost(); }, Qt::QueuedConnection);
+    }
+    return id;
+}
+
+void SpawnHelper::sendSignal(quint32 id, int signal) {
+    const qint32 value = signal;
+    sendFrame(SpawnProtocol::Signal, id, QByteArray(reinterpret_cast<const char *>(&value), sizeof(value)));
+}
+
+bool SpawnHelper::sendFrame(quint8 type, quint32 id, const QByteArray &payload) {
+    if (m_fd < 0) {
+        return false;
+    }
+
+    SpawnProtocol::FrameHeader header{};
+    header.length = static_cast<std::uint32_t>(payload.size());
+    header.id = id;
+    header.type = type;
+    return writeAll(m_fd, reinterpret_cast<const char *>(&header), sizeof(header)) &&
+           writeAll(m_fd, payload.constData(), payload.size());
+}
+
+void SpawnHelper::onReadable() {
+    char chunk[65536];
+    for (;;) {
+        const ssize_t n = ::recv(m_fd, chunk, sizeof(chunk), MSG_DONTWAIT);
+        if (n > 0) {
+            m_buffer.append(chunk, n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            onHelperLost();
+            return;
+        }
+        break;
+    }
+
+    const qsizetype headerSize = sizeof(SpawnProtocol::FrameHeader);
+    qsizetype offset = 0;
+    while (m_buffer.size() - offset >= headerSize) {
+        SpawnProtocol::FrameHeader header;
+        std::memcpy(&header, m_buffer.constData() + offset, sizeof(header));
+        if (m_buffer.size() - offset - headerSize < static_cast<qsizetype>(header.length)) {
+            break;
+        }
+        const QByteArray payload = m_buffer.mid(offset + headerSize, header.length);
+        offset += headerSize + header.length;
+        handleFrame(header.type, header.id, payload);
+    }
+    m_buffer.remove(0, offset);
+}
+
+void SpawnHelper::handleFrame(quint8 type, quint32 id, const QByteArray &payload) {
+    qint32 value = 0;
+    if (payload.size() >= static_cast<qsizetype>(sizeof(value))) {
+        std::memcpy(&value, payload.constData(), sizeof(value));
+    }
+
+    switch (type) {
+    case SpawnProtocol::Started:
+        emit started(id, value);
+        break;
+    case SpawnProtocol::Stdout:
+        emit output(id, StandardOutput, payload);
+        break;
+    case SpawnProtocol::Stderr:
+        emit output(id, StandardError, payload);
+        break;
+    case SpawnProtocol::Exited:
+        m_outstanding.remove(id);
+        if (WIFEXITED(value)) {
+            emit exited(id, WEXITSTATUS(value), false);
+        } else {
+            emit exited(id, -1, true);
+        }
+        break;
+    case SpawnProtocol::Failed:
+        m_outstanding.remove(id);
+        emit failed(id, QString::fromLocal8Bit(std::strerror(value)));
+        break;
+    default:
+        break;
+    }
+}
+
+void SpawnHelper::onHelperLost() {
+    if (m_fd < 0) {
+        return;
+    }
+
+    qWarning() << "Spawn helper exited; falling back to QProcess";
+    m_notifier->setEnabled(false);
+    ::close(m_fd);
+    m_fd = -1;
+    s_helperFd = -1;
+
+    const QSet<quint32> lost = m_outstanding;
+    m_outstanding.clear();
+    for (quint32 id : lost) {
+        emit exited(id, -1, true);
+    }
+}
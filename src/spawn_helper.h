@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+class QSocketNotifier;
+class QThread;
+
+// Client for a small helper process forked at startup, before Qt and the
+// Wayland connection exist. Children are posix_spawn'ed by the helper, so
+// launching warp-cli never forks the full GUI process.
+class SpawnHelper : public QObject {
+    Q_OBJECT
+
+public:
+    enum Channel { StandardOutput, StandardError };
+
+    // Forks the helper. Must run at the very top of main(), before any
+    // threads or Qt objects exist. Set WARP_GUI_NO_SPAWN_HELPER=1 to skip.
+    static void launch();
+
+    // Client bound to the launched helper, or nullptr if none is running.
+    // Created on first use from the owner thread and only usable there.
+    static SpawnHelper *instance();
+
+    // Thread that owns the client; the GUI thread unless set before first
+    // use. Children started on any other thread go through QProcess.
+    static void setOwnerThread(QThread *thread);
+
+    bool isAvailable() const;
+
+    quint32 spawn(const QString &program, const QStringList &args);
+    void sendSignal(quint32 id, int signal);
+
+signals:
+    void started(quint32 id, qint64 pid);
+    void output(quint32 id, int channel, const QByteArray &data);
+    void exited(quint32 id, int exitCode, bool crashed);
+    void failed(quint32 id, const QString &error);
+
+private:
+    explicit SpawnHelper(int fd, QObject *parent = nullptr);
+
+    bool sendFrame(quint8 type, quint32 id, const QByteArray &payload);
+    void onReadable();
+    void handleFrame(quint8 type, quint32 id, const QByteArray &payload);
+    void onHelperLost();
+
+    QSocketNotifier *m_notifier;
+    int m_fd;
+    QByteArray m_buffer;
+    QSet<quint32> m_outstanding;
+    quint32 m_nextId;
+};
@@ -0,0 +1,255 @@
+#include "spawn_helper_server.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+namespace {
+
+using SpawnProtocol::FrameHeader;
+
+struct Job {
+    std::uint32_t id;
+    pid_t pid;
+    int outFd;
+    int errFd;
+};
+
+bool writeAll(int fd, const void *data, size_t size) {
+    const char *p = static_cast<const char *>(data);
+    while (size > 0) {
+        const ssize_t n = ::write(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool sendFrame(int fd, std::uint8_t type, std::uint32_t id, const void *payload, std::uint32_t length) {
+    FrameHeader header{};
+    header.length = length;
+    header.id = id;
+    header.type = type;
+    return writeAll(fd, &header, sizeof(header)) && (length == 0 || writeAll(fd, payload, length));
+}
+
+bool sendInt(int fd, std::uint8_t type, std::uint32_t id, std::int32_t value) {
+    return sendFrame(fd, type, id, &value, sizeof(value));
+}
+
+void closeFd(int &fd) {
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+}
+
+void startJob(int controlFd, std::uint32_t id, const std::string &payload, std::vector<Job> &jobs) {
+    // payload is program\0arg1\0...; argv[0] is the program itself
+    std::vector<char *> argv;
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (start < payload.size()) {
+        const size_t end = payload.find('\0', start);
+        const size_t stop = end == std::string::npos ? payload.size() : end;
+        parts.emplace_back(payload, start, stop - start);
+        start = stop + 1;
+    }
+    if (parts.empty()) {
+        sendInt(controlFd, SpawnProtocol::Failed, id, EINVAL);
+        return;
+    }
+    for (std::string &part : parts) {
+        argv.push_back(&part[0]);
+    }
+    argv.push_back(nullptr);
+
+    int outPipe[2];
+    int errPipe[2];
+    if (::pipe2(outPipe, O_CLOEXEC) != 0) {
+        sendInt(controlFd, SpawnProtocol::Failed, id, errno);
+        return;
+    }
+    if (::pipe2(errPipe, O_CLOEXEC) != 0) {
+        const int error = errno;
+        ::close(outPipe[0]);
+        ::close(outPipe[1]);
+        sendInt(controlFd, SpawnProtocol::Failed, id, error);
+        return;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, errPipe[1], STDERR_FILENO);
+
+    // The helper ignores SIGPIPE; children must start with default handling
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t defaults;
+    sigemptyset(&defaults);
+    sigaddset(&defaults, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attr, &defaults);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+
+    pid_t pid = -1;
+    const int error = posix_spawnp(&pid, argv[0], &actions, &attr, argv.data(), environ);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(outPipe[1]);
+    ::close(errPipe[1]);
+
+    if (error != 0) {
+        ::close(outPipe[0]);
+        ::close(errPipe[0]);
+        sendInt(controlFd, SpawnProtocol::Failed, id, error);
+        return;
+    }
+
+    jobs.push_back(Job{id, pid, outPipe[0], errPipe[0]});
+    sendInt(controlFd, SpawnProtocol::Started, id, static_cast<std::int32_t>(pid));
+}
+
+void signalJob(std::uint32_t id, const std::string &payload, std::vector<Job> &jobs) {
+    if (payload.size() < sizeof(std::int32_t)) {
+        return;
+    }
+    std::int32_t sig = 0;
+    std::memcpy(&sig, payload.data(), sizeof(sig));
+    for (const Job &job : jobs) {
+        if (job.id == id) {
+            ::kill(job.pid, sig);
+            return;
+        }
+    }
+}
+
+// Handles every complete frame in buffer and keeps any partial tail
+void handleRequests(int controlFd, std::string &buffer, std::vector<Job> &jobs) {
+    size_t offset = 0;
+    while (buffer.size() - offset >= sizeof(FrameHeader)) {
+        FrameHeader header;
+        std::memcpy(&header, buffer.data() + offset, sizeof(header));
+        if (buffer.size() - offset - sizeof(header) < header.length) {
+            break;
+        }
+        const std::string payload = buffer.substr(offset + sizeof(header), header.length);
+        offset += sizeof(header) + header.length;
+
+        if (header.type == SpawnProtocol::Spawn) {
+            startJob(controlFd, header.id, payload, jobs);
+        } else if (header.type == SpawnProtocol::Signal) {
+            signalJob(header.id, payload, jobs);
+        }
+    }
+    buffer.erase(0, offset);
+}
+
+void forwardOutput(int controlFd, Job &job, int &fd, std::uint8_t type) {
+    char chunk[65536];
+    const ssize_t n = ::read(fd, chunk, sizeof(chunk));
+    if (n > 0) {
+        sendFrame(controlFd, type, job.id, chunk, static_cast<std::uint32_t>(n));
+    } else if (n == 0 || errno != EINTR) {
+        closeFd(fd);
+    }
+}
+
+} // namespace
+
+int runSpawnHelperServer(int controlFd) {
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::vector<Job> jobs;
+    std::string buffer;
+
+    for (;;) {
+        // pollfd slot -> (job index, stderr?) for the pipes
+        std::vector<pollfd> fds;
+        std::vector<std::pair<size_t, bool>> owners;
+        fds.push_back(pollfd{controlFd, POLLIN, 0});
+        bool awaitingExit = false;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            if (jobs[i].outFd >= 0) {
+                fds.push_back(pollfd{jobs[i].outFd, POLLIN, 0});
+                owners.emplace_back(i, false);
+            }
+            if (jobs[i].errFd >= 0) {
+                fds.push_back(pollfd{jobs[i].errFd, POLLIN, 0});
+                owners.emplace_back(i, true);
+            }
+            if (jobs[i].outFd < 0 && jobs[i].errFd < 0) {
+                awaitingExit = true;
+            }
+        }
+
+        // Children that closed their pipes but have not exited yet are
+        // re-checked on a short timer instead of blocking in waitpid
+        const int ready = ::poll(fds.data(), fds.size(), awaitingExit ? 20 : -1);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+
+        for (size_t slot = 1; ready > 0 && slot < fds.size(); ++slot) {
+            if (fds[slot].revents == 0) {
+                continue;
+            }
+            Job &job = jobs[owners[slot - 1].first];
+            if (owners[slot - 1].second) {
+                forwardOutput(controlFd, job, job.errFd, SpawnProtocol::Stderr);
+            } else {
+                forwardOutput(controlFd, job, job.outFd, SpawnProtocol::Stdout);
+            }
+        }
+
+        if (ready > 0 && fds[0].revents != 0) {
+            char chunk[4096];
+            const ssize_t n = ::read(controlFd, chunk, sizeof(chunk));
+            if (n == 0 || (n < 0 && errno != EINTR && errno != EAGAIN)) {
+                break; // GUI went away
+            }
+            if (n > 0) {
+                buffer.append(chunk, static_cast<size_t>(n));
+                handleRequests(controlFd, buffer, jobs);
+            }
+        }
+
+        // Report exits only after all output has been forwarded
+        for (size_t i = 0; i < jobs.size();) {
+            Job &job = jobs[i];
+            int status = 0;
+            if (job.outFd < 0 && job.errFd < 0 && ::waitpid(job.pid, &status, WNOHANG) == job.pid) {
+                sendInt(controlFd, SpawnProtocol::Exited, job.id, status);
+                jobs.erase(jobs.begin() + static_cast<std::ptrdiff_t>(i));
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    for (Job &job : jobs) {
+        ::kill(job.pid, SIGTERM);
+        closeFd(job.outFd);
+        closeFd(job.errFd);
+    }
+    ::close(controlFd);
+    return 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+// Wire format between the GUI and the spawn helper process. Both ends are the
+// same binary on the same machine, so headers are sent as raw structs.
+namespace SpawnProtocol {
+
+enum FrameType : std::uint8_t {
+    // GUI -> helper
+    Spawn = 1,  // payload: program\0arg1\0arg2\0...
+    Signal = 2, // payload: int32 signal number
+
+    // helper -> GUI
+    Started = 16, // payload: int32 pid
+    Stdout = 17,  // payload: raw bytes
+    Stderr = 18,  // payload: raw bytes
+    Exited = 19,  // payload: int32 wait status
+    Failed = 20,  // payload: int32 errno
+};
+
+struct FrameHeader {
+    std::uint32_t length; // payload bytes following the header
+    std::uint32_t id;     // spawn id chosen by the GUI
+    std::uint8_t type;
+    std::uint8_t reserved[3];
+};
+
+} // namespace SpawnProtocol
+
+// Serves spawn requests on controlFd until the GUI end closes. Runs in the
+// forked helper process, so it uses plain POSIX and no Qt.
+int runSpawnHelperServer(int controlFd);
@@ -0,0 +1,67 @@
+#include "state_client.h"
+
+#include <QByteArray>
+#include <QLocalSocket>
+
+#include <cstdio>
+#include <cstring>
+
+#include "state_server.h"
+
+std::optional<StateClient::Mode> StateClient::modeFromArguments(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--status") == 0) {
+            return Mode::Status;
+        }
+        if (std::strcmp(argv[i], "--watch") == 0) {
+            return Mode::Watch;
+        }
+    }
+    return std::nullopt;
+}
+
+int StateClient::run(Mode mode) {
+    const QString path = StateServer::socketPath();
+    QLocalSocket socket;
+    if (!path.isEmpty()) {
+        socket.connectToServer(path);
+    }
+    if (path.isEmpty() || !socket.waitForConnected(1000)) {
+        std::fputs("warp-gui is not running\n", stderr);
+        return 1;
+    }
+
+    socket.write(mode == Mode::Watch ? QByteArrayLiteral("watch\n") : QByteArrayLiteral("status\n"));
+    if (!socket.waitForBytesWritten(1000)) {
+        std::fputs("warp-gui did not accept the request\n", stderr);
+        return 1;
+    }
+
+    // Lines are passed through as they arrive; flush each so pipes see them
+    // right away
+    bool received = false;
+    const auto drain = [&socket, &received]() {
+        while (socket.canReadLine()) {
+            const QByteArray line = socket.readLine();
+            std::fwrite(line.constData(), 1, static_cast<size_t>(line.size()), stdout);
+            std::fflush(stdout);
+            received = true;
+        }
+    };
+
+    // A status reply comes straight away; a watch may stay quiet for hours
+    // and ends when the connection closes
+    const int timeoutMs = mode == Mode::Watch ? -1 : 2000;
+    drain();
+    while (!(mode == Mode::Status && received) && socket.waitForReadyRead(timeoutMs)) {
+        drain();
+    }
+    drain();
+
+    if (!received) {
+        std::fputs("warp-gui sent no state\n", stderr);
+        return 1;
+    }
+    // The watch only ends when the instance goes away
+    return mode == Mode::Watch ? 1 : 0;
+}
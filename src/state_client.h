@@ -0,0 +1,23 @@
+#pragma once
+
+#include <optional>
+
+// `warp-gui --status` and `warp-gui --watch`: ask the running instance for
+// its state over StateServer's socket and print it as newline-delimited
+// JSON. Needs only QtCore and QtNetwork; no widgets, no Wayland, no spawn
+// helper.
+class StateClient {
+public:
+    enum class Mode {
+        Status, // print the current state once
+        Watch,  // print the current state, then every change
+    };
+
+    // Client mode requested on the command line, if any. Runs before any
+    // application object exists.
+    static std::optional<Mode> modeFromArguments(int argc, char **argv);
+
+    // Needs a QCoreApplication. Returns the process exit code: 0 on success,
+    // 1 when no instance is running or the connection was lost.
+    static int run(Mode mode);
+};
@@ -0,0 +1,159 @@
+#include "state_server.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSettings>
+#include <QStandardPaths>
+
+#include "tray_app.h"
+
+namespace {
+
+constexpr int kMaxRequestBytes = 64;
+
+QString stateName(StatusSnapshot::State state) {
+    switch (state) {
+    case StatusSnapshot::State::Disconnected:
+        return QStringLiteral("disconnected");
+    case StatusSnapshot::State::Connecting:
+        return QStringLiteral("connecting");
+    case StatusSnapshot::State::Connected:
+        return QStringLiteral("connected");
+    case StatusSnapshot::State::Unknown:
+        break;
+    }
+    return QStringLiteral("unknown");
+}
+
+} // namespace
+
+StateServer::StateServer(TrayApp *tray)
+    : QObject(tray),
+      m_tray(tray),
+      m_server(new QLocalServer(this)),
+      m_maxWatcherBacklogBytes(kDefaultMaxWatcherBacklogBytes),
+      m_state(currentState()),
+      m_changedAtMs(QDateTime::currentMSecsSinceEpoch()) {
+    QSettings settings(QStringLiteral("warp-gui"), QStringLiteral("warp-gui"));
+    m_maxWatcherBacklogBytes =
+        qMax<qint64>(1024, settings.value(QStringLiteral("stateServer/maxWatcherBacklogBytes"),
+                                          kDefaultMaxWatcherBacklogBytes)
+                               .toLongLong());
+
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &StateServer::onNewConnection);
+    connect(m_tray, &TrayApp::stateChanged, this, &StateServer::onStateChanged);
+}
+
+QString StateServer::socketPath() {
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (dir.isEmpty()) {
+        return QString();
+    }
+    return dir + QStringLiteral("/warp-gui.sock");
+}
+
+bool StateServer::listen() {
+    const QString path = socketPath();
+    if (path.isEmpty()) {
+        qWarning() << "No runtime directory; --status and --watch are unavailable";
+        return false;
+    }
+
+    // Holding the instance lock means whatever is at path is stale
+    QLocalServer::removeServer(path);
+    if (!m_server->listen(path)) {
+        qWarning() << "Could not listen on" << path << ":" << m_server->errorString();
+        return false;
+    }
+    return true;
+}
+
+QJsonObject StateServer::currentState() const {
+    QJsonObject state;
+    state.insert(QStringLiteral("state"), stateName(m_tray->state()));
+    state.insert(QStringLiteral("status"), m_tray->statusText());
+    state.insert(QStringLiteral("reason"), m_tray->statusReason());
+    state.insert(QStringLiteral("mode"), m_tray->mode());
+    state.insert(QStringLiteral("colo"), m_tray->colo());
+    state.insert(QStringLiteral("zeroTrust"), m_tray->isZeroTrust());
+    state.insert(QStringLiteral("busy"), m_tray->isBusy());
+    return state;
+}
+
+QByteArray StateServer::stateLine() const {
+    QJsonObject state = m_state;
+    state.insert(QStringLiteral("updatedMs"), m_changedAtMs);
+    return QJsonDocument(state).toJson(QJsonDocument::Compact) + '\n';
+}
+
+void StateServer::onNewConnection() {
+    while (QLocalSocket *socket = m_server->nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            m_watchers.removeOne(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void StateServer::onReadyRead(QLocalSocket *socket) {
+    if (m_watchers.contains(socket)) {
+        // Watchers have nothing more to say
+        socket->readAll();
+        return;
+    }
+    if (!socket->canReadLine()) {
+        if (socket->bytesAvailable() > kMaxRequestBytes) {
+            socket->abort();
+        }
+        return;
+    }
+
+    const QByteArray request = socket->readLine().trimmed();
+    if (request == "status") {
+        socket->write(stateLine());
+        socket->disconnectFromServer();
+    } else if (request == "watch") {
+        m_watchers.append(socket);
+        socket->write(stateLine());
+    } else if (const SingleInstance::Command command = SingleInstance::commandFromRequest(request);
+               command != SingleInstance::Command::None) {
+        socket->write(QByteArrayLiteral("{\"ok\":true}\n"));
+        socket->disconnectFromServer();
+        emit commandReceived(command);
+    } else {
+        socket->write(QByteArrayLiteral("{\"error\":\"unknown request\"}\n"));
+        socket->disconnectFromServer();
+    }
+}
+
+void StateServer::onStateChanged() {
+    // The tray re-applies its state far more often than it changes
+    QJsonObject state = currentState();
+    if (state == m_state) {
+        return;
+    }
+    m_state = std::move(state);
+    m_changedAtMs = QDateTime::currentMSecsSinceEpoch();
+
+    if (m_watchers.isEmpty()) {
+        return;
+    }
+    const QByteArray line = stateLine();
+    // abort() removes the watcher through disconnected(); walk a copy
+    const QList<QLocalSocket *> watchers = m_watchers;
+    for (QLocalSocket *socket : watchers) {
+        if (socket->bytesToWrite() + line.size() > m_maxWatcherBacklogBytes) {
+            qWarning() << "Dropping a --watch client that stopped reading," << socket->bytesToWrite()
+                       << "bytes queued";
+            m_watchers.removeOne(socket);
+            socket->abort();
+            continue;
+        }
+        socket->write(line);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QString>
+
+#include "single_instance.h"
+
+class QLocalServer;
+class QLocalSocket;
+class TrayApp;
+
+// Serves the tray's state on a local socket for `warp-gui --status` and
+// `warp-gui --watch`. A client sends one request line:
+//
+//   status   one JSON object, then the server closes the connection
+//   watch    the current state, then one line per change until either side
+//            disconnects
+//
+// Every reply line is a compact JSON object (newline-delimited JSON). The
+// requests named by SingleInstance::requestName() are commands forwarded
+// by a second launch; they are answered with {"ok":true}.
+//
+// A watcher that stops reading is disconnected once more than
+// stateServer/maxWatcherBacklogBytes of updates are queued for it, so a
+// stuck `--watch` pipe cannot grow the tray's memory without bound.
+class StateServer : public QObject {
+    Q_OBJECT
+
+public:
+    static constexpr qint64 kDefaultMaxWatcherBacklogBytes = 64 * 1024;
+
+    explicit StateServer(TrayApp *tray);
+
+    // Starts listening, replacing any socket a crashed instance left
+    // behind. Only the instance holding the SingleInstance lock calls this.
+    bool listen();
+
+    // $XDG_RUNTIME_DIR/warp-gui.sock, or empty without a runtime directory
+    static QString socketPath();
+
+signals:
+    void commandReceived(SingleInstance::Command command);
+
+private:
+    QJsonObject currentState() const;
+    QByteArray stateLine() const;
+    void onNewConnection();
+    void onReadyRead(QLocalSocket *socket);
+    void onStateChanged();
+
+    TrayApp *m_tray;
+    QLocalServer *m_server;
+    QList<QLocalSocket *> m_watchers;
+    qint64 m_maxWatcherBacklogBytes;
+
+    // State last sent to watchers, without the timestamp
+    QJsonObject m_state;
+    qint64 m_changedAtMs;
+};
@@ -0,0 +1,158 @@
+#include "status_page.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QStandardPaths>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "tray_app.h"
+#include "warp_status_page.h"
+
+static_assert(static_cast<int>(StatusSnapshot::State::Disconnected) == WARP_STATUS_DISCONNECTED &&
+                  static_cast<int>(StatusSnapshot::State::Connecting) == WARP_STATUS_CONNECTING &&
+                  static_cast<int>(StatusSnapshot::State::Connected) == WARP_STATUS_CONNECTED,
+              "StatusSnapshot::State is written to the page as is");
+
+namespace {
+
+// Copies as much of value as fits and NUL-terminates it, never splitting a
+// UTF-8 sequence
+template <size_t N>
+void copyField(char (&field)[N], const QByteArray &value) {
+    qsizetype size = qMin<qsizetype>(value.size(), N - 1);
+    if (size < value.size()) {
+        while (size > 0 && (static_cast<unsigned char>(value.at(size)) & 0xC0) == 0x80) {
+            --size;
+        }
+    }
+    std::memcpy(field, value.constData(), static_cast<size_t>(size));
+    std::memset(field + size, 0, N - static_cast<size_t>(size));
+}
+
+} // namespace
+
+StatusPage::StatusPage(TrayApp *tray) : QObject(tray), m_tray(tray), m_page(nullptr) {
+    connect(m_tray, &TrayApp::stateChanged, this, &StatusPage::onStateChanged);
+}
+
+StatusPage::~StatusPage() {
+    if (!m_page) {
+        return;
+    }
+
+    Fields stopped;
+    stopped.status = QByteArrayLiteral("Not running");
+    write(stopped, 0);
+    ::munmap(m_page, sizeof(warp_status_page));
+}
+
+QString StatusPage::path() {
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (dir.isEmpty()) {
+        return QString();
+    }
+    return dir + QLatin1Char('/') + QLatin1String(WARP_STATUS_FILE_NAME);
+}
+
+bool StatusPage::open() {
+    if (m_page) {
+        return true;
+    }
+
+    const QString file = path();
+    if (file.isEmpty()) {
+        qWarning() << "No runtime directory; status page disabled";
+        return false;
+    }
+
+    // Reopen rather than replace, so readers that mapped the file during an
+    // earlier run keep seeing updates
+    const int fd = ::open(QFile::encodeName(file).constData(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        qWarning() << "Could not open status page" << file << ":" << std::strerror(errno);
+        return false;
+    }
+    if (::ftruncate(fd, sizeof(warp_status_page)) != 0) {
+        qWarning() << "Could not size status page" << file << ":" << std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    void *mapped = ::mmap(nullptr, sizeof(warp_status_page), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        qWarning() << "Could not map status page" << file << ":" << std::strerror(errno);
+        return false;
+    }
+
+    m_page = static_cast<warp_status_page *>(mapped);
+    if (m_page->magic != WARP_STATUS_MAGIC || m_page->version != WARP_STATUS_VERSION) {
+        // New or foreign file: readers reject it until the magic is set
+        std::memset(m_page, 0, sizeof(warp_status_page));
+        m_page->version = WARP_STATUS_VERSION;
+        __atomic_store_n(&m_page->magic, WARP_STATUS_MAGIC, __ATOMIC_RELEASE);
+    } else if (m_page->sequence & 1u) {
+        // An earlier run died halfway through an update
+        __atomic_store_n(&m_page->sequence, m_page->sequence + 1, __ATOMIC_RELEASE);
+    }
+
+    m_published = current();
+    write(m_published, static_cast<qint32>(::getpid()));
+    return true;
+}
+
+StatusPage::Fields StatusPage::current() const {
+    Fields fields;
+    fields.state = m_tray->state();
+    fields.status = m_tray->statusText().toUtf8();
+    fields.reason = m_tray->statusReason().toUtf8();
+    fields.mode = m_tray->mode().toUtf8();
+    fields.colo = m_tray->colo().toUtf8();
+    fields.zeroTrust = m_tray->isZeroTrust();
+    return fields;
+}
+
+void StatusPage::onStateChanged() {
+    if (!m_page) {
+        return;
+    }
+
+    // The tray re-applies its state far more often than it changes
+    Fields fields = current();
+    if (fields == m_published) {
+        return;
+    }
+    write(fields, static_cast<qint32>(::getpid()));
+    m_published = std::move(fields);
+}
+
+void StatusPage::write(const Fields &fields, qint32 pid) {
+    // Odd sequence first, then the fields, then even again. Readers that
+    // overlap with this see the sequence move and retry.
+    const quint32 sequence = m_page->sequence;
+    __atomic_store_n(&m_page->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    m_page->state = static_cast<quint32>(fields.state);
+    m_page->updated_ms = QDateTime::currentMSecsSinceEpoch();
+    m_page->writer_pid = pid;
+    m_page->zero_trust = fields.zeroTrust ? 1 : 0;
+    copyField(m_page->status, fields.status);
+    copyField(m_page->reason, fields.reason);
+    copyField(m_page->mode, fields.mode);
+    copyField(m_page->colo, fields.colo);
+
+    __atomic_store_n(&m_page->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+bool StatusPage::Fields::operator==(const Fields &other) const {
+    return state == other.state && status == other.status && reason == other.reason && mode == other.mode &&
+           colo == other.colo && zeroTrust == other.zeroTrust;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+#include "status_snapshot.h"
+
+struct warp_status_page;
+class TrayApp;
+
+// Mirrors the tray's state into a small shared-memory file under
+// $XDG_RUNTIME_DIR (layout in warp_status_page.h), so prompts and status
+// bars can read it without running anything. Updates go through a seqlock;
+// the page is only rewritten when a field actually changes.
+class StatusPage : public QObject {
+    Q_OBJECT
+
+public:
+    explicit StatusPage(TrayApp *tray);
+    // Leaves the page in place, marked as not running
+    ~StatusPage() override;
+
+    // Creates or reopens the file and maps it. Fails when XDG_RUNTIME_DIR
+    // is unset or the file cannot be created.
+    bool open();
+
+    static QString path();
+
+private:
+    struct Fields {
+        StatusSnapshot::State state = StatusSnapshot::State::Unknown;
+        QByteArray status;
+        QByteArray reason;
+        QByteArray mode;
+        QByteArray colo;
+        bool zeroTrust = false;
+
+        bool operator==(const Fields &other) const;
+    };
+
+    Fields current() const;
+    void onStateChanged();
+    void write(const Fields &fields, qint32 pid);
+
+    TrayApp *m_tray;
+    warp_status_page *m_page;
+    Fields m_published;
+};
@@ -0,0 +1,352 @@
+#include "status_snapshot.h"
+
+#include <cstring>
+#include <string>
+
+namespace {
+
+struct Span {
+    const char *data = nullptr;
+    qsizetype size = 0;
+    bool escaped = false;
+};
+
+bool spanEquals(const Span &span, const char *literal) {
+    const qsizetype length = static_cast<qsizetype>(std::strlen(literal));
+    return !span.escaped && span.size == length && std::memcmp(span.data, literal, length) == 0;
+}
+
+bool equalsIgnoreCase(const QByteArray &value, const char *literal) {
+    const qsizetype length = static_cast<qsizetype>(std::strlen(literal));
+    if (value.size() != length) {
+        return false;
+    }
+    const char *data = value.constData();
+    for (qsizetype i = 0; i < length; ++i) {
+        char c = data[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != literal[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Minimal forward-only JSON scanner. It never copies: strings come back as
+// spans into the input and are only decoded when they contain escapes.
+class Scanner {
+public:
+    Scanner(const char *begin, const char *end) : m_pos(begin), m_end(end) {}
+
+    char peek() const { return m_pos < m_end ? *m_pos : '\0'; }
+
+    void skipSpace() {
+        while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\n' || *m_pos == '\r')) {
+            ++m_pos;
+        }
+    }
+
+    bool consume(char c) {
+        skipSpace();
+        if (m_pos < m_end && *m_pos == c) {
+            ++m_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool readString(Span *out) {
+        skipSpace();
+        if (peek() != '"') {
+            return false;
+        }
+        ++m_pos;
+        const char *start = m_pos;
+        bool escaped = false;
+        while (m_pos < m_end && *m_pos != '"') {
+            if (*m_pos == '\\') {
+                escaped = true;
+                ++m_pos;
+            }
+            ++m_pos;
+        }
+        if (m_pos >= m_end) {
+            return false;
+        }
+        out->data = start;
+        out->size = m_pos - start;
+        out->escaped = escaped;
+        ++m_pos; // closing quote
+        return true;
+    }
+
+    bool skipValue() {
+        skipSpace();
+        const char c = peek();
+        if (c == '"') {
+            Span ignored;
+            return readString(&ignored);
+        }
+        if (c == '{' || c == '[') {
+            int depth = 0;
+            while (m_pos < m_end) {
+                const char ch = *m_pos;
+                if (ch == '"') {
+                    Span ignored;
+                    if (!readString(&ignored)) {
+                        return false;
+                    }
+                    continue;
+                }
+                ++m_pos;
+                if (ch == '{' || ch == '[') {
+                    ++depth;
+                } else if (ch == '}' || ch == ']') {
+                    if (--depth == 0) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // Number, true, false or null
+        const char *start = m_pos;
+        while (m_pos < m_end && !std::strchr(",}] \t\r\n", *m_pos)) {
+            ++m_pos;
+        }
+        return m_pos > start;
+    }
+
+    // Skips the remaining "key": value pairs of an object whose first member
+    // has already been read, including the closing brace.
+    bool finishObject() {
+        while (consume(',')) {
+            Span key;
+            if (!readString(&key) || !consume(':') || !skipValue()) {
+                return false;
+            }
+        }
+        return consume('}');
+    }
+
+private:
+    const char *m_pos;
+    const char *m_end;
+};
+
+void appendUtf8(std::string &out, unsigned int cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+unsigned int readHex4(const char *p) {
+    unsigned int value = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char c = p[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') {
+            value |= static_cast<unsigned int>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            value |= static_cast<unsigned int>(c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            value |= static_cast<unsigned int>(c - 'A' + 10);
+        }
+    }
+    return value;
+}
+
+// Decodes JSON escapes. Only used for the rare strings that contain them.
+Span decode(const Span &span, std::string &storage) {
+    if (!span.escaped) {
+        return span;
+    }
+
+    storage.clear();
+    const char *p = span.data;
+    const char *end = span.data + span.size;
+    while (p < end) {
+        if (*p != '\\' || p + 1 >= end) {
+            storage += *p++;
+            continue;
+        }
+        const char e = p[1];
+        p += 2;
+        switch (e) {
+        case 'n': storage += '\n'; break;
+        case 't': storage += '\t'; break;
+        case 'r': storage += '\r'; break;
+        case 'b': storage += '\b'; break;
+        case 'f': storage += '\f'; break;
+        case 'u':
+            if (end - p >= 4) {
+                unsigned int cp = readHex4(p);
+                p += 4;
+                if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                    const unsigned int low = readHex4(p + 2);
+                    if (low >= 0xDC00 && low < 0xE000) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        p += 6;
+                    }
+                }
+                appendUtf8(storage, cp);
+            }
+            break;
+        default: storage += e; break;
+        }
+    }
+
+    Span decoded;
+    decoded.data = storage.data();
+    decoded.size = static_cast<qsizetype>(storage.size());
+    return decoded;
+}
+
+// Writes the concatenation of parts into target unless it already holds
+// exactly that content. Returns true when target changed.
+bool assignParts(QByteArray &target, const Span *parts, int count) {
+    qsizetype total = 0;
+    for (int i = 0; i < count; ++i) {
+        total += parts[i].size;
+    }
+
+    if (target.size() == total) {
+        const char *existing = target.constData();
+        bool same = true;
+        for (int i = 0; i < count && same; ++i) {
+            same = parts[i].size == 0 || std::memcmp(existing, parts[i].data, parts[i].size) == 0;
+            existing += parts[i].size;
+        }
+        if (same) {
+            return false;
+        }
+    }
+
+    target.resize(total);
+    char *out = target.data();
+    for (int i = 0; i < count; ++i) {
+        if (parts[i].size == 0) {
+            continue;
+        }
+        std::memcpy(out, parts[i].data, parts[i].size);
+        out += parts[i].size;
+    }
+    return true;
+}
+
+Span literal(const char *text) {
+    Span span;
+    span.data = text;
+    span.size = static_cast<qsizetype>(std::strlen(text));
+    return span;
+}
+
+} // namespace
+
+StatusSnapshot::ParseResult StatusSnapshot::parseJson(const QByteArray &json) {
+    Scanner scanner(json.constData(), json.constData() + json.size());
+    if (!scanner.consume('{')) {
+        return ParseResult::Invalid;
+    }
+
+    Span statusValue = literal("Unknown");
+    Span reasonKey;
+    Span reasonValue;
+    bool reasonIsObject = false;
+
+    if (!scanner.consume('}')) {
+        do {
+            Span key;
+            if (!scanner.readString(&key) || !scanner.consume(':')) {
+                return ParseResult::Invalid;
+            }
+            scanner.skipSpace();
+
+            if (spanEquals(key, "status") && scanner.peek() == '"') {
+                scanner.readString(&statusValue);
+            } else if (spanEquals(key, "reason") && scanner.peek() == '"') {
+                scanner.readString(&reasonValue);
+            } else if (spanEquals(key, "reason") && scanner.peek() == '{') {
+                // {"reason": {"Key": "value"}} is shown as "Key: value"
+                scanner.consume('{');
+                if (!scanner.consume('}')) {
+                    if (!scanner.readString(&reasonKey) || !scanner.consume(':')) {
+                        return ParseResult::Invalid;
+                    }
+                    reasonIsObject = true;
+                    scanner.skipSpace();
+                    if (scanner.peek() == '"') {
+                        scanner.readString(&reasonValue);
+                    } else if (!scanner.skipValue()) {
+                        return ParseResult::Invalid;
+                    }
+                    if (!scanner.finishObject()) {
+                        return ParseResult::Invalid;
+                    }
+                }
+            } else if (!scanner.skipValue()) {
+                return ParseResult::Invalid;
+            }
+        } while (scanner.consume(','));
+
+        if (!scanner.consume('}')) {
+            return ParseResult::Invalid;
+        }
+    }
+
+    std::string statusStorage;
+    std::string keyStorage;
+    std::string valueStorage;
+    const Span statusParts[] = {decode(statusValue, statusStorage)};
+    bool changed = assignParts(status, statusParts, 1);
+
+    if (reasonIsObject) {
+        const Span reasonParts[] = {decode(reasonKey, keyStorage), literal(": "), decode(reasonValue, valueStorage)};
+        changed |= assignParts(reason, reasonParts, 3);
+    } else {
+        const Span reasonParts[] = {decode(reasonValue, valueStorage)};
+        changed |= assignParts(reason, reasonParts, 1);
+    }
+
+    state = stateFromStatus(status);
+    return changed ? ParseResult::Changed : ParseResult::Unchanged;
+}
+
+StatusSnapshot::ParseResult StatusSnapshot::assign(const QByteArray &newStatus, const QByteArray &newReason) {
+    if (status == newStatus && reason == newReason) {
+        return ParseResult::Unchanged;
+    }
+
+    status = newStatus;
+    reason = newReason;
+    state = stateFromStatus(status);
+    return ParseResult::Changed;
+}
+
+StatusSnapshot::State StatusSnapshot::stateFromStatus(const QByteArray &status) {
+    if (equalsIgnoreCase(status, "connected")) {
+        return State::Connected;
+    }
+    if (equalsIgnoreCase(status, "connecting")) {
+        return State::Connecting;
+    }
+    if (equalsIgnoreCase(status, "disconnected")) {
+        return State::Disconnected;
+    }
+    return State::Unknown;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QByteArray>
+
+// Compact view of `warp-cli -j status`, parsed straight from the raw bytes.
+struct StatusSnapshot {
+    enum class State : quint8 {
+        Unknown,
+        Disconnected,
+        Connecting,
+        Connected,
+    };
+
+    enum class ParseResult {
+        Invalid,
+        Unchanged,
+        Changed,
+    };
+
+    State state = State::Unknown;
+    QByteArray status; // e.g. "Connected"
+    QByteArray reason; // "Key: value" for object reasons, empty when none
+
+    // Updates this snapshot in place. Buffers are only rewritten when their
+    // content differs, so re-parsing an identical status allocates nothing.
+    ParseResult parseJson(const QByteArray &json);
+
+    // Applies a status pushed by the watch channel. Never returns Invalid.
+    ParseResult assign(const QByteArray &newStatus, const QByteArray &newReason);
+
+    static State stateFromStatus(const QByteArray &status);
+};
@@ -0,0 +1,132 @@
+#include "status_watch.h"
+
+#include <QTimer>
+
+#include "child_process.h"
+#include "process_runner.h"
+
+namespace {
+constexpr int kInitialBackoffMs = 1000;
+constexpr int kMaxBackoffMs = 60000;
+} // namespace
+
+StatusWatch::StatusWatch(QObject *parent)
+    : QObject(parent),
+      m_process(nullptr),
+      m_restart(new QTimer(this)),
+      m_wanted(false),
+      m_live(false),
+      m_backoffMs(kInitialBackoffMs) {
+    m_restart->setSingleShot(true);
+    connect(m_restart, &QTimer::timeout, this, &StatusWatch::launch);
+}
+
+void StatusWatch::start() {
+    if (m_wanted) {
+        return;
+    }
+    m_wanted = true;
+    m_backoffMs = kInitialBackoffMs;
+    launch();
+}
+
+void StatusWatch::stop() {
+    m_wanted = false;
+    m_restart->stop();
+    if (m_process) {
+        ChildProcess *process = m_process;
+        m_process = nullptr;
+        disconnect(process, nullptr, this, nullptr);
+        ProcessRunner::terminate(process);
+    }
+    setLive(false);
+}
+
+void StatusWatch::restart() {
+    if (!m_process) {
+        return;
+    }
+    ChildProcess *process = m_process;
+    m_process = nullptr;
+    disconnect(process, nullptr, this, nullptr);
+    ProcessRunner::terminate(process);
+    relaunchLater();
+}
+
+bool StatusWatch::isLive() const {
+    return m_live;
+}
+
+void StatusWatch::launch() {
+    if (!m_wanted || m_process) {
+        return;
+    }
+
+    m_buffer.clear();
+    m_process = new ChildProcess(this);
+    connect(m_process, &ChildProcess::readyReadStandardOutput, this, &StatusWatch::onOutput);
+    connect(m_process, &ChildProcess::finished, this, &StatusWatch::onExited);
+    connect(m_process, &ChildProcess::failedToStart, this, &StatusWatch::onExited);
+    m_process->start(QStringLiteral("warp-cli"),
+                     {QStringLiteral("--accept-tos"), QStringLiteral("--listen"), QStringLiteral("status")});
+}
+
+void StatusWatch::onOutput() {
+    m_buffer += m_process->readAllStandardOutput();
+
+    const QByteArray previousStatus = m_status;
+    const QByteArray previousReason = m_reason;
+
+    qsizetype start = 0;
+    qsizetype newline;
+    while ((newline = m_buffer.indexOf('\n', start)) >= 0) {
+        handleLine(m_buffer.mid(start, newline - start).trimmed());
+        start = newline + 1;
+    }
+    m_buffer.remove(0, start);
+
+    // One event per chunk, so a status and its reason arrive together
+    if (!m_status.isEmpty() && (m_status != previousStatus || m_reason != previousReason)) {
+        setLive(true);
+        m_backoffMs = kInitialBackoffMs;
+        emit statusUpdate(m_status);
+    }
+}
+
+void StatusWatch::handleLine(const QByteArray &line) {
+    static const QByteArray statusPrefix("Status update:");
+    static const QByteArray reasonPrefix("Reason:");
+
+    if (line.startsWith(statusPrefix)) {
+        m_status = line.mid(statusPrefix.size()).trimmed();
+        m_reason.clear();
+    } else if (line.startsWith(reasonPrefix) && !m_status.isEmpty()) {
+        m_reason = line.mid(reasonPrefix.size()).trimmed();
+    }
+}
+
+void StatusWatch::onExited() {
+    m_process->deleteLater();
+    m_process = nullptr;
+    relaunchLater();
+}
+
+void StatusWatch::relaunchLater() {
+    m_status.clear();
+    m_reason.clear();
+    setLive(false);
+
+    if (m_wanted) {
+        // warp-svc restarts and warp-cli builds without --listen both end
+        // up here; back off so neither turns into a spawn loop
+        m_restart->start(m_backoffMs);
+        m_backoffMs = qMin(m_backoffMs * 2, kMaxBackoffMs);
+    }
+}
+
+void StatusWatch::setLive(bool live) {
+    if (m_live != live) {
+        m_live = live;
+        emit liveChanged(live);
+    }
+}
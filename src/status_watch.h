@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+
+class ChildProcess;
+class QTimer;
+
+// Keeps `warp-cli --listen status` running and turns its "Status update:"
+// lines into events. Restarts the channel with backoff when it exits.
+// The text "Reason:" lines are worded differently from the reasons in
+// `warp-cli -j status`, so they only mark a change; the reason itself is
+// left to the JSON status.
+class StatusWatch : public QObject {
+    Q_OBJECT
+
+public:
+    explicit StatusWatch(QObject *parent = nullptr);
+
+    void start();
+    void stop();
+    // Drops a channel that may have stalled; it comes back after the usual
+    // backoff and counts as not live until it reports again
+    void restart();
+
+    // True once the channel has delivered a status and is still running
+    bool isLive() const;
+
+signals:
+    // The status word or its reason changed
+    void statusUpdate(const QByteArray &status);
+    void liveChanged(bool live);
+
+private:
+    void launch();
+    void onOutput();
+    void onExited();
+    void relaunchLater();
+    void handleLine(const QByteArray &line);
+    void setLive(bool live);
+
+    ChildProcess *m_process;
+    QTimer *m_restart;
+    QByteArray m_buffer;
+    QByteArray m_status;
+    QByteArray m_reason;
+    bool m_wanted;
+    bool m_live;
+    int m_backoffMs;
+};
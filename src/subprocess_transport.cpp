@@ -0,0 +1,64 @@
+#include "subprocess_transport.h"
+
+#include "child_process.h"
+#include "process_runner.h"
+#include "trace.h"
+
+#include <memory>
+
+SubprocessTransport::SubprocessTransport(QObject *parent) : WarpTransport(parent) {}
+
+QString SubprocessTransport::name() const {
+    return QStringLiteral("subprocess");
+}
+
+bool SubprocessTransport::isAvailable() const {
+    return true;
+}
+
+void SubprocessTransport::submit(quint64 ticket, const QStringList &args) {
+    auto *proc = new ChildProcess(this);
+    m_processes.insert(ticket, proc);
+
+    connect(proc, &ChildProcess::finished, this, [this, ticket, proc](int exitCode, bool) {
+        WarpResult result;
+        result.exitCode = exitCode;
+        result.stdoutData = proc->readAllStandardOutput();
+        result.stderrData = proc->readAllStandardError();
+
+        // Aborted processes were already removed and must not report back
+        if (m_processes.remove(ticket)) {
+            emit completed(ticket, result);
+        }
+
+        proc->deleteLater();
+    });
+    connect(proc, &ChildProcess::failedToStart, this, [this, ticket, proc]() {
+        WarpResult result = WarpResult::withOutcome(WarpResult::Outcome::FailedToStart);
+        result.stderrData = proc->errorString().toUtf8();
+
+        if (m_processes.remove(ticket)) {
+            emit completed(ticket, result);
+        }
+
+        proc->deleteLater();
+    });
+
+    if (Trace::isEnabled()) {
+        // Marks the first output on the request's warp-cli span
+        auto firstOutput = std::make_shared<QMetaObject::Connection>();
+        *firstOutput = connect(proc, &ChildProcess::readyReadStandardOutput, this, [ticket, firstOutput]() {
+            Trace::asyncInstant("warp-cli", "first byte", ticket);
+            QObject::disconnect(*firstOutput);
+        });
+    }
+
+    proc->start(QStringLiteral("warp-cli"), args);
+}
+
+void SubprocessTransport::abort(quint64 ticket) {
+    ChildProcess *proc = m_processes.take(ticket);
+    if (proc) {
+        ProcessRunner::terminate(proc);
+    }
+}
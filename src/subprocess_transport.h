@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QHash>
+
+#include "warp_transport.h"
+
+class ChildProcess;
+
+// Runs every request as its own warp-cli process. Always available, used as
+// the fallback when no daemon connection exists.
+class SubprocessTransport : public WarpTransport {
+    Q_OBJECT
+
+public:
+    explicit SubprocessTransport(QObject *parent = nullptr);
+
+    QString name() const override;
+    bool isAvailable() const override;
+    void submit(quint64 ticket, const QStringList &args) override;
+    void abort(quint64 ticket) override;
+
+private:
+    QHash<quint64, ChildProcess *> m_processes;
+};
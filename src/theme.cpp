@@ -0,0 +1,230 @@
+#include "theme.h"
+
+#include <QApplication>
+#include <QStyle>
+#include <QWidget>
+
+namespace {
+
+// Palette roles shared by every window
+#define THEME_BACKGROUND "#1e1e1e"
+#define THEME_SURFACE "#2a2a2a"
+#define THEME_BORDER "#3a3a3a"
+#define THEME_TEXT "#ffffff"
+#define THEME_ACCENT "#ff6a00"
+#define THEME_ACCENT_HOVER "#ff8533"
+#define THEME_ACCENT_PRESSED "#cc5500"
+#define THEME_ZERO_TRUST "#0A64BC"
+
+// Concatenated at compile time so nothing is formatted at runtime
+const char kPopupStyle[] =
+    "WarpPopup {"
+    "  background-color: transparent;" // Transparent for rounded corners
+    "}"
+    "WarpPopup #contentWidget {"
+    "  background-color: " THEME_BACKGROUND ";"
+    "  border: 1px solid " THEME_BORDER ";"
+    "  border-radius: 12px;"
+    "}"
+    "WarpPopup QLabel { color: " THEME_TEXT "; background: transparent; }"
+    "WarpPopup QLabel#dragHandle { color: #666666; }"
+    // Zero Trust uses blue, WARP and 1.1.1.1 use orange
+    "WarpPopup QLabel#popupTitle { color: " THEME_ACCENT "; font-weight: bold; }"
+    "WarpPopup QLabel#popupTitle[accent=\"zeroTrust\"] { color: " THEME_ZERO_TRUST "; }"
+    "WarpPopup QPushButton {"
+    "  background: transparent;"
+    "  border: none;"
+    "  color: #999999;"
+    "  font-size: 18px;"
+    "  padding: 0px;"
+    "}"
+    "WarpPopup QPushButton:hover { color: " THEME_TEXT "; }"
+    "WarpPopup #bottomBar {"
+    "  background-color: " THEME_SURFACE ";"
+    "  border-top: 1px solid " THEME_BORDER ";"
+    "  border-bottom-left-radius: 12px;"
+    "  border-bottom-right-radius: 12px;"
+    "}"
+    "WarpPopup QLabel#brandingLabel { color: #888888; font-weight: bold; }";
+
+const char kSettingsMenuStyle[] =
+    "SettingsMenu {"
+    "  background-color: " THEME_SURFACE ";"
+    "  border: 1px solid " THEME_BORDER ";"
+    "  border-radius: 8px;"
+    "}"
+    "SettingsMenu #menuSeparator { background-color: " THEME_BORDER "; }"
+    "SettingsMenu QLabel {"
+    "  background: transparent;"
+    "  color: " THEME_TEXT ";"
+    "  font-size: 13px;"
+    "}"
+    "SettingsMenu QPushButton {"
+    "  background: transparent;"
+    "  border: none;"
+    "  color: " THEME_TEXT ";"
+    "  padding: 10px 20px;"
+    "  text-align: left;"
+    "  font-size: 13px;"
+    "}"
+    "SettingsMenu QPushButton:hover {"
+    "  background-color: " THEME_BORDER ";"
+    "}"
+    "SettingsMenu QPushButton:disabled {"
+    "  color: #666666;"
+    "}"
+    "SettingsMenu QPushButton:last-child {"
+    "  border-bottom-left-radius: 8px;"
+    "  border-bottom-right-radius: 8px;"
+    "}";
+
+// Message boxes and input dialogs opened from Preferences match it too
+const char kPreferencesStyle[] =
+    "PreferencesDialog, PreferencesDialog QDialog {"
+    "  background-color: " THEME_BACKGROUND ";"
+    "  color: " THEME_TEXT ";"
+    "}"
+    "PreferencesDialog QListWidget {"
+    "  background-color: " THEME_SURFACE ";"
+    "  border: none;"
+    "  border-right: 1px solid " THEME_BORDER ";"
+    "  outline: none;"
+    "}"
+    "PreferencesDialog QListWidget::item {"
+    "  padding: 12px 20px;"
+    "  border: none;"
+    "  color: " THEME_TEXT ";"
+    "}"
+    "PreferencesDialog QListWidget::item:selected {"
+    "  background-color: " THEME_ACCENT ";"
+    "  color: " THEME_TEXT ";"
+    "}"
+    "PreferencesDialog QListWidget::item:hover {"
+    "  background-color: " THEME_BORDER ";"
+    "}"
+    "PreferencesDialog QLabel {"
+    "  color: " THEME_TEXT ";"
+    "  background: transparent;"
+    "}"
+    "PreferencesDialog QLabel[loading=\"true\"] {"
+    "  color: #888888;"
+    "  font-style: italic;"
+    "}"
+    "PreferencesDialog QLabel[role=\"description\"] {"
+    "  color: #999;"
+    "  font-size: 11px;"
+    "}"
+    "PreferencesDialog QLabel[role=\"groupDescription\"] {"
+    "  color: #999;"
+    "  font-size: 11px;"
+    "  margin-bottom: 5px;"
+    "}"
+    "PreferencesDialog QLabel[role=\"infoBox\"] {"
+    "  background: " THEME_SURFACE ";"
+    "  padding: 10px;"
+    "  border-radius: 5px;"
+    "  border: 1px solid " THEME_BORDER ";"
+    "}"
+    "PreferencesDialog QGroupBox {"
+    "  color: " THEME_TEXT ";"
+    "  font-weight: bold;"
+    "  border: 1px solid " THEME_BORDER ";"
+    "  border-radius: 5px;"
+    "  margin-top: 10px;"
+    "  padding-top: 10px;"
+    "  background-color: " THEME_SURFACE ";"
+    "}"
+    "PreferencesDialog QGroupBox::title {"
+    "  subcontrol-origin: margin;"
+    "  left: 10px;"
+    "  padding: 0 5px;"
+    "  color: " THEME_ACCENT ";"
+    "}"
+    "PreferencesDialog QPushButton {"
+    "  background-color: " THEME_ACCENT ";"
+    "  color: " THEME_TEXT ";"
+    "  border: none;"
+    "  padding: 8px 16px;"
+    "  border-radius: 4px;"
+    "  font-weight: bold;"
+    "}"
+    "PreferencesDialog QPushButton:hover {"
+    "  background-color: " THEME_ACCENT_HOVER ";"
+    "}"
+    "PreferencesDialog QPushButton:pressed {"
+    "  background-color: " THEME_ACCENT_PRESSED ";"
+    "}"
+    "PreferencesDialog QPushButton:disabled {"
+    "  background-color: " THEME_BORDER ";"
+    "  color: #666666;"
+    "}"
+    "PreferencesDialog QComboBox {"
+    "  background-color: " THEME_SURFACE ";"
+    "  color: " THEME_TEXT ";"
+    "  padding: 5px;"
+    "  border: 1px solid " THEME_BORDER ";"
+    "  border-radius: 3px;"
+    "}"
+    "PreferencesDialog QComboBox::drop-down {"
+    "  border: none;"
+    "  background-color: " THEME_BORDER ";"
+    "}"
+    "PreferencesDialog QComboBox::down-arrow {"
+    "  image: none;"
+    "  border-left: 4px solid transparent;"
+    "  border-right: 4px solid transparent;"
+    "  border-top: 6px solid " THEME_TEXT ";"
+    "  width: 0;"
+    "  height: 0;"
+    "}"
+    "PreferencesDialog QComboBox QAbstractItemView {"
+    "  background-color: " THEME_SURFACE ";"
+    "  color: " THEME_TEXT ";"
+    "  selection-background-color: " THEME_ACCENT ";"
+    "  border: 1px solid " THEME_BORDER ";"
+    "}"
+    "PreferencesDialog QTextEdit {"
+    "  background-color: " THEME_SURFACE ";"
+    "  color: " THEME_TEXT ";"
+    "  border: 1px solid " THEME_BORDER ";"
+    "  border-radius: 3px;"
+    "}"
+    "PreferencesDialog QCheckBox {"
+    "  color: " THEME_TEXT ";"
+    "  spacing: 8px;"
+    "}"
+    "PreferencesDialog QCheckBox::indicator {"
+    "  width: 18px;"
+    "  height: 18px;"
+    "  border: 1px solid " THEME_BORDER ";"
+    "  border-radius: 3px;"
+    "  background-color: " THEME_SURFACE ";"
+    "}"
+    "PreferencesDialog QCheckBox::indicator:checked {"
+    "  background-color: " THEME_ACCENT ";"
+    "  border-color: " THEME_ACCENT ";"
+    "}"
+    "PreferencesDialog QCheckBox::indicator:hover {"
+    "  border-color: " THEME_ACCENT ";"
+    "}";
+
+} // namespace
+
+void Theme::install(QApplication &app) {
+    app.setStyleSheet(QString::fromLatin1(kPopupStyle) + QLatin1String(kSettingsMenuStyle) +
+                      QLatin1String(kPreferencesStyle));
+}
+
+void Theme::setState(QWidget *widget, const char *name, const QVariant &value) {
+    if (!widget || widget->property(name) == value) {
+        return;
+    }
+    widget->setProperty(name, value);
+
+    // Property selectors are only re-evaluated on polish. Widgets that have
+    // not been shown yet pick the value up when they are first polished.
+    if (widget->testAttribute(Qt::WA_WState_Polished)) {
+        widget->style()->unpolish(widget);
+        widget->style()->polish(widget);
+    }
+}
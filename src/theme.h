@@ -0,0 +1,19 @@
+#pragma once
+
+#include <QVariant>
+
+class QApplication;
+class QWidget;
+
+// One application-wide stylesheet covering the popup, the settings menu and
+// the preferences dialog. It is built and parsed once at startup; widgets
+// change appearance by switching dynamic properties instead of installing
+// stylesheets of their own.
+class Theme {
+public:
+    static void install(QApplication &app);
+
+    // Sets a styled dynamic property, e.g. role="description" or
+    // loading=true. The widget is only repolished when the value changes.
+    static void setState(QWidget *widget, const char *name, const QVariant &value);
+};
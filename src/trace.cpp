@@ -0,0 +1,280 @@
+#include "trace.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSettings>
+#include <QSocketNotifier>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <csignal>
+#include <ctime>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+std::atomic<bool> Trace::s_enabled{false};
+
+namespace {
+
+struct Event {
+    const char *category = nullptr;
+    const char *name = nullptr;
+    char phase = 'X'; // X complete, b/n/e async begin/instant/end
+    qint64 startNs = 0;
+    qint64 durationNs = 0;
+    quint64 id = 0;
+    int tid = 0;
+    QString detail;
+};
+
+struct Buffer {
+    QMutex mutex;
+    std::vector<Event> events; // ring, oldest at next once wrapped
+    size_t next = 0;
+    bool wrapped = false;
+    QHash<int, QString> threadNames;
+    int nextTid = 1;
+};
+
+Buffer &buffer() {
+    static Buffer instance;
+    return instance;
+}
+
+thread_local int t_tid = 0;
+int s_signalFds[2] = {-1, -1};
+
+// Small stable ids read better in Perfetto than pthread handles
+int currentTid(Buffer &b) {
+    if (t_tid == 0) {
+        t_tid = b.nextTid++;
+        QThread *thread = QThread::currentThread();
+        QString name = thread ? thread->objectName() : QString();
+        if (name.isEmpty()) {
+            const QCoreApplication *app = QCoreApplication::instance();
+            name = app && thread == app->thread() ? QStringLiteral("main") : QStringLiteral("thread %1").arg(t_tid);
+        }
+        b.threadNames.insert(t_tid, name);
+    }
+    return t_tid;
+}
+
+void record(Event &&event) {
+    Buffer &b = buffer();
+    QMutexLocker locker(&b.mutex);
+    if (b.events.empty()) {
+        return;
+    }
+    event.tid = currentTid(b);
+    b.events[b.next] = std::move(event);
+    if (++b.next == b.events.size()) {
+        b.next = 0;
+        b.wrapped = true;
+    }
+}
+
+QByteArray jsonString(const QString &text) {
+    const QByteArray utf8 = text.toUtf8();
+    QByteArray out;
+    out.reserve(utf8.size() + 2);
+    out += '"';
+    for (const char c : utf8) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += "\\u00" + QByteArray::number(static_cast<int>(c), 16).rightJustified(2, '0');
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+QByteArray toJson(const Event &event) {
+    // Chrome trace timestamps are microseconds
+    QByteArray line("{\"ph\":\"");
+    line += event.phase;
+    line += "\",\"cat\":\"";
+    line += event.category;
+    line += "\",\"name\":\"";
+    line += event.name;
+    line += "\",\"pid\":" + QByteArray::number(QCoreApplication::applicationPid());
+    line += ",\"tid\":" + QByteArray::number(event.tid);
+    line += ",\"ts\":" + QByteArray::number(static_cast<double>(event.startNs) / 1000.0, 'f', 3);
+    if (event.phase == 'X') {
+        line += ",\"dur\":" + QByteArray::number(static_cast<double>(event.durationNs) / 1000.0, 'f', 3);
+    } else {
+        line += ",\"id\":\"0x" + QByteArray::number(event.id, 16) + '"';
+    }
+    if (!event.detail.isEmpty()) {
+        line += ",\"args\":{\"detail\":" + jsonString(event.detail) + '}';
+    }
+    line += '}';
+    return line;
+}
+
+void onSignal(int) {
+    const char byte = 1;
+    // Nothing useful to do on failure inside a signal handler
+    [[maybe_unused]] const ssize_t n = ::write(s_signalFds[0], &byte, 1);
+}
+
+} // namespace
+
+void Trace::configure() {
+    QSettings settings(QStringLiteral("warp-gui"), QStringLiteral("warp-gui"));
+    const bool enabled = qEnvironmentVariableIntValue("WARP_GUI_TRACE") != 0 ||
+                         settings.value(QStringLiteral("trace/enabled"), false).toBool();
+    if (!enabled) {
+        return;
+    }
+
+    const int capacity = qMax(1024, settings.value(QStringLiteral("trace/bufferEvents"), 65536).toInt());
+    Buffer &b = buffer();
+    {
+        QMutexLocker locker(&b.mutex);
+        b.events.assign(static_cast<size_t>(capacity), Event());
+        b.next = 0;
+        b.wrapped = false;
+    }
+    s_enabled.store(true, std::memory_order_relaxed);
+}
+
+qint64 Trace::now() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<qint64>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void Trace::complete(const char *category, const char *name, qint64 startNs, qint64 endNs, const QString &detail) {
+    if (!isEnabled()) {
+        return;
+    }
+    Event event;
+    event.category = category;
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+    event.detail = detail;
+    record(std::move(event));
+}
+
+void Trace::asyncBegin(const char *category, const char *name, quint64 id, const QString &detail) {
+    if (!isEnabled()) {
+        return;
+    }
+    Event event;
+    event.category = category;
+    event.name = name;
+    event.phase = 'b';
+    event.startNs = now();
+    event.id = id;
+    event.detail = detail;
+    record(std::move(event));
+}
+
+void Trace::asyncInstant(const char *category, const char *name, quint64 id) {
+    if (!isEnabled()) {
+        return;
+    }
+    Event event;
+    event.category = category;
+    event.name = name;
+    event.phase = 'n';
+    event.startNs = now();
+    event.id = id;
+    record(std::move(event));
+}
+
+void Trace::asyncEnd(const char *category, const char *name, quint64 id, const QString &detail) {
+    if (!isEnabled()) {
+        return;
+    }
+    Event event;
+    event.category = category;
+    event.name = name;
+    event.phase = 'e';
+    event.startNs = now();
+    event.id = id;
+    event.detail = detail;
+    record(std::move(event));
+}
+
+bool Trace::dump(const QString &path) {
+    // Copy under the lock, format without it
+    std::vector<Event> events;
+    QHash<int, QString> threadNames;
+    {
+        Buffer &b = buffer();
+        QMutexLocker locker(&b.mutex);
+        if (b.wrapped) {
+            events.insert(events.end(), b.events.begin() + static_cast<std::ptrdiff_t>(b.next), b.events.end());
+        }
+        events.insert(events.end(), b.events.begin(), b.events.begin() + static_cast<std::ptrdiff_t>(b.next));
+        threadNames = b.threadNames;
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    file.write("{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" + pid + ",\"args\":{\"name\":\"warp-gui\"}}");
+    for (auto it = threadNames.cbegin(); it != threadNames.cend(); ++it) {
+        file.write(",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" + pid + ",\"tid\":" +
+                   QByteArray::number(it.key()) + ",\"args\":{\"name\":" + jsonString(it.value()) + "}}");
+    }
+    for (const Event &event : events) {
+        file.write(",\n" + toJson(event));
+    }
+    file.write("\n]}\n");
+    return file.commit();
+}
+
+QString Trace::defaultDumpPath() {
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::TempLocation);
+    return QDir(dir).filePath(QStringLiteral("warp-gui-trace-%1-%2.json")
+                                  .arg(QCoreApplication::applicationPid())
+                                  .arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-hhmmss"))));
+}
+
+void Trace::installSignalHandler() {
+    if (s_signalFds[0] >= 0 || ::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, s_signalFds) != 0) {
+        return;
+    }
+
+    // The handler only writes a byte; the dump runs on the main thread
+    auto *notifier = new QSocketNotifier(s_signalFds[1], QSocketNotifier::Read, QCoreApplication::instance());
+    QObject::connect(notifier, &QSocketNotifier::activated, notifier, []() {
+        char byte;
+        [[maybe_unused]] const ssize_t n = ::read(s_signalFds[1], &byte, 1);
+        if (!isEnabled()) {
+            qWarning() << "SIGUSR1: tracing is disabled; set WARP_GUI_TRACE=1";
+            return;
+        }
+        const QString path = defaultDumpPath();
+        if (dump(path)) {
+            qInfo().noquote() << "Trace written to" << path;
+        } else {
+            qWarning().noquote() << "Could not write trace to" << path;
+        }
+    });
+
+    struct sigaction action {};
+    action.sa_handler = onSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+
+// Built-in span recorder. Events go to a fixed-size ring buffer and can be
+// written out as Chrome trace JSON, which Perfetto and chrome://tracing
+// open. Enable with WARP_GUI_TRACE=1 or trace/enabled=true; while disabled
+// every call returns after one relaxed atomic load.
+class Trace {
+public:
+    // Reads the environment and trace/* settings. Call once from main().
+    static void configure();
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    // Monotonic nanoseconds, the time base of every event
+    static qint64 now();
+
+    // A finished span on the calling thread
+    static void complete(const char *category, const char *name, qint64 startNs, qint64 endNs,
+                         const QString &detail = QString());
+
+    // Spans that cross threads or event loop turns, matched by category and
+    // id. Instants mark milestones inside the span.
+    static void asyncBegin(const char *category, const char *name, quint64 id, const QString &detail = QString());
+    static void asyncInstant(const char *category, const char *name, quint64 id);
+    static void asyncEnd(const char *category, const char *name, quint64 id, const QString &detail = QString());
+
+    // Writes the buffered events; the buffer is kept
+    static bool dump(const QString &path);
+    static QString defaultDumpPath();
+
+    // Dumps to defaultDumpPath() on SIGUSR1. Needs a running application.
+    static void installSignalHandler();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// Records the lifetime of a scope as one span
+class TraceScope {
+public:
+    TraceScope(const char *category, const char *name)
+        : m_category(category), m_name(name), m_startNs(Trace::isEnabled() ? Trace::now() : -1) {}
+    ~TraceScope() { finish(); }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+    // False while tracing is disabled; guard building a detail with it
+    bool isActive() const { return m_startNs >= 0; }
+    void setDetail(const QString &detail) { m_detail = detail; }
+
+    // Ends the span early
+    void finish() {
+        if (m_startNs >= 0) {
+            Trace::complete(m_category, m_name, m_startNs, Trace::now(), m_detail);
+            m_startNs = -1;
+        }
+    }
+
+private:
+    const char *m_category;
+    const char *m_name;
+    qint64 m_startNs;
+    QString m_detail;
+};
@@ -8,14 +8,8 @@
 #include <QFile>
 #include <QGuiApplication>
 #include <QIcon>
-#include <QJsonDocument>
-#include <QJsonObject>
 #include <QMenu>
 #include <QMessageBox>
-#include <QPainter>
-#include <QPainterPath>
-#include <QPixmap>
-#include <QProcess>
 #include <QScreen>
 #include <QSettings>
 #include <QStandardPaths>
@@ -24,31 +18,52 @@
 #include <QWindow>
 #include <QWidgetAction>
 
+#include "connection_log.h"
+#include "dbus_service.h"
+#include "poll_scheduler.h"
 #include "popup_widget.h"
 #include "preferences_dialog.h"
 #include "settings_menu.h"
+#include "state_server.h"
+#include "status_page.h"
+#include "trace.h"
+#include "tray_icon_cache.h"
 #include "wayland_popup_helper.h"
 
 TrayApp::TrayApp(QObject *parent)
     : QObject(parent),
-      m_warp(this),
+      m_cache(WarpStateCache::instance()),
       m_tray(new QSystemTrayIcon(this)),
       m_menu(new QMenu()),
+      m_trayIcons(new TrayIconCache(this)),
+      m_trayIconKey(0),
       m_statusAction(new QAction(QStringLiteral("Status: …"), m_menu)),
       m_connectAction(new QAction(QStringLiteral("Connect"), m_menu)),
       m_disconnectAction(new QAction(QStringLiteral("Disconnect"), m_menu)),
       m_preferencesAction(new QAction(QStringLiteral("Preferences…"), m_menu)),
       m_quitAction(new QAction(QStringLiteral("Quit"), m_menu)),
-      m_poll(new QTimer(this)),
+      m_pollScheduler(new PollScheduler(this)),
       m_popup(new WarpPopup()),
       m_settingsMenu(new SettingsMenu()),
+      m_preferences(nullptr),
+      m_dbus(nullptr),
+      m_statusPage(nullptr),
+      m_stateServer(nullptr),
+      m_connectionLog(nullptr),
+      m_probes(nullptr),
       m_currentStatus(QStringLiteral("…")),
       m_currentMode(QStringLiteral("warp")),
       m_busy(false),
       m_isZeroTrust(false),
+      m_coloWanted(false),
       m_lastCursorPos(0, 0),
       m_popupOffset(0, 0) {
-    connect(&m_warp, &WarpCli::finished, this, &TrayApp::onWarpFinished);
+    connect(m_cache, &WarpStateCache::finished, this, &TrayApp::onWarpFinished);
+    connect(m_cache, &WarpStateCache::statusChanged, this, &TrayApp::onStatusChanged);
+    connect(m_cache, &WarpStateCache::statusSubscriptionChanged, this, &TrayApp::onStatusSubscriptionChanged);
+    connect(m_cache, &WarpStateCache::updated, this, &TrayApp::onStateUpdated);
+    connect(m_cache, &WarpStateCache::failed, this, &TrayApp::onStateFailed);
+    connect(m_trayIcons, &TrayIconCache::invalidated, this, &TrayApp::applyUiState);
     
     // Load saved popup offset
     m_popupOffset = loadPopupOffset();
@@ -66,6 +81,9 @@ TrayApp::TrayApp(QObject *parent)
     m_menu->addAction(m_disconnectAction);
     m_menu->addSeparator();
     m_menu->addAction(m_preferencesAction);
+    if (Trace::isEnabled()) {
+        m_menu->addAction(QStringLiteral("Save Trace"), this, &TrayApp::saveTrace);
+    }
     m_menu->addSeparator();
     m_menu->addAction(m_quitAction);
 
@@ -73,16 +91,12 @@ TrayApp::TrayApp(QObject *parent)
 
     connect(m_connectAction, &QAction::triggered, this, &TrayApp::connectWarp);
     connect(m_disconnectAction, &QAction::triggered, this, &TrayApp::disconnectWarp);
-    connect(m_preferencesAction, &QAction::triggered, this, [this]() {
-        auto *prefs = new PreferencesDialog();
-        connect(prefs, &PreferencesDialog::settingsChanged, this, &TrayApp::refreshSettings);
-        prefs->setAttribute(Qt::WA_DeleteOnClose);
-        prefs->show();
-    });
+    connect(m_preferencesAction, &QAction::triggered, this, &TrayApp::showPreferences);
     connect(m_quitAction, &QAction::triggered, qApp, &QApplication::quit);
 
-    m_poll->setInterval(5000);
-    connect(m_poll, &QTimer::timeout, this, &TrayApp::refreshStatus);
+    // Only polls while the status watch channel is down
+    m_pollScheduler->setConfig(PollScheduler::Config::load());
+    connect(m_pollScheduler, &PollScheduler::pollRequested, this, &TrayApp::refreshStatus);
 
     connect(m_popup, &WarpPopup::requestConnect, this, &TrayApp::connectWarp);
     connect(m_popup, &WarpPopup::requestDisconnect, this, &TrayApp::disconnectWarp);
@@ -99,21 +113,13 @@ TrayApp::TrayApp(QObject *parent)
     });
 
     // Connect settings menu signals
-    connect(m_settingsMenu, &SettingsMenu::preferencesRequested, this, [this]() {
-        auto *prefs = new PreferencesDialog();
-        connect(prefs, &PreferencesDialog::settingsChanged, this, &TrayApp::refreshSettings);
-        prefs->setAttribute(Qt::WA_DeleteOnClose);
-        prefs->show();
-    });
+    connect(m_settingsMenu, &SettingsMenu::preferencesRequested, this, &TrayApp::showPreferences);
     connect(m_settingsMenu, &SettingsMenu::aboutRequested, this, [this]() {
         QMessageBox::about(nullptr, QStringLiteral("About Cloudflare WARP"),
                           QStringLiteral("Cloudflare WARP GUI\nUnofficial Qt-based GUI for warp-cli"));
     });
     connect(m_settingsMenu, &SettingsMenu::exitRequested, qApp, &QApplication::quit);
-    connect(m_settingsMenu, &SettingsMenu::modeChangeRequested, this, [this](const QString &targetMode) {
-        m_warp.run(QStringLiteral("set_mode"), QStringList{QStringLiteral("mode"), targetMode});
-        setBusy(true);
-    });
+    connect(m_settingsMenu, &SettingsMenu::modeChangeRequested, this, &TrayApp::setMode);
 
     // Setup popup window
     m_popup->setWindowFlags(Qt::Window | Qt::FramelessWindowHint | Qt::WindowStaysOnTopHint);
@@ -127,32 +133,119 @@ void TrayApp::start() {
     m_tray->show();
     refreshStatus();
     refreshSettings();
-    m_poll->start();
+    m_pollScheduler->start();
+    m_cache->subscribeStatus();
+
+    // Lets other tools follow this state instead of polling warp-cli
+    m_dbus = new DBusService(this);
+    m_dbus->registerService();
+
+    // Same state for prompts and status bars, readable without a round trip
+    m_statusPage = new StatusPage(this);
+    m_statusPage->open();
+
+    // Event-driven updates for `warp-gui --status` and `warp-gui --watch`
+    m_stateServer = new StateServer(this);
+    connect(m_stateServer, &StateServer::commandReceived, this, &TrayApp::handleCommand);
+    m_stateServer->listen();
+
+    // History of transitions for the uptime figures in Preferences
+    m_connectionLog = new ConnectionLog(this);
+    m_connectionLog->open();
+}
+
+void TrayApp::handleCommand(SingleInstance::Command command) {
+    switch (command) {
+    case SingleInstance::Command::None:
+        break;
+    case SingleInstance::Command::ShowPopup:
+        // showPopup() toggles; a launch should never hide it
+        if (m_popup->isVisible()) {
+            m_popup->raise();
+            m_popup->activateWindow();
+        } else {
+            showPopup();
+        }
+        break;
+    case SingleInstance::Command::OpenPreferences:
+        showPreferences();
+        break;
+    case SingleInstance::Command::Connect:
+        connectWarp();
+        break;
+    case SingleInstance::Command::Disconnect:
+        disconnectWarp();
+        break;
+    }
+}
+
+StatusSnapshot::State TrayApp::state() const {
+    return m_status.state;
+}
+
+QString TrayApp::statusText() const {
+    return m_currentStatus;
+}
+
+QString TrayApp::statusReason() const {
+    return m_currentReason;
+}
+
+QString TrayApp::mode() const {
+    return m_currentMode;
+}
+
+bool TrayApp::isBusy() const {
+    return m_busy;
+}
+
+bool TrayApp::isZeroTrust() const {
+    return m_isZeroTrust;
+}
+
+QString TrayApp::colo() const {
+    return m_colo;
+}
+
+void TrayApp::saveTrace() {
+    const QString path = Trace::defaultDumpPath();
+    if (Trace::dump(path)) {
+        m_tray->showMessage(QStringLiteral("WARP"), QStringLiteral("Trace saved to %1").arg(path));
+    } else {
+        m_tray->showMessage(QStringLiteral("WARP"), QStringLiteral("Could not write %1").arg(path),
+                            QSystemTrayIcon::Warning);
+    }
 }
 
 void TrayApp::refreshStatus() {
-    m_warp.runJson(QStringLiteral("status"), QStringList{QStringLiteral("status")});
+    // The scheduler decides when a poll is due, so bypass the TTL
+    m_cache->refresh(WarpStateCache::Entry::Status);
 }
 
 void TrayApp::refreshSettings() {
     // Fetch both settings and status to update mode and Zero Trust status
-    m_warp.run(QStringLiteral("settings"), QStringList{QStringLiteral("settings")});
-    m_warp.runJson(QStringLiteral("status"), QStringList{QStringLiteral("status")});
+    m_cache->refresh(WarpStateCache::Entry::Settings);
+    m_cache->refresh(WarpStateCache::Entry::Status);
     updateZeroTrustStatus();
 }
 
 void TrayApp::updateZeroTrustStatus() {
-    // Immediately check and update Zero Trust status
-    QProcess regProcess;
-    regProcess.start(QStringLiteral("warp-cli"), {QStringLiteral("registration"), QStringLiteral("show")});
-    regProcess.waitForFinished();
-    QString regOutput = QString::fromUtf8(regProcess.readAllStandardOutput());
-
-    m_isZeroTrust = regOutput.contains(QStringLiteral("Account type: Team"), Qt::CaseInsensitive) ||
-                    regOutput.contains(QStringLiteral("Organization:"), Qt::CaseInsensitive);
-    
-    // Immediately update UI
-    applyUiState();
+    // Only spawns when the cached registration has expired; the result
+    // arrives in onStateUpdated, which updates the UI
+    m_cache->request(WarpStateCache::Entry::Registration);
+}
+
+void TrayApp::showPreferences() {
+    // One dialog for the whole session; it builds its pages on demand
+    if (!m_preferences) {
+        m_preferences = new PreferencesDialog();
+        connect(m_preferences, &PreferencesDialog::settingsChanged, this, &TrayApp::refreshSettings);
+    }
+
+    m_preferences->show();
+    m_preferences->raise();
+    m_preferences->activateWindow();
+    m_pollScheduler->noteVisible();
 }
 
 void TrayApp::onTrayActivated(QSystemTrayIcon::ActivationReason reason) {
@@ -165,6 +258,7 @@ void TrayApp::onTrayActivated(QSystemTrayIcon::ActivationReason reason) {
 }
 
 void TrayApp::showPopup() {
+    TraceScope trace("ui", "TrayApp::showPopup");
     if (!m_popup) {
         return;
     }
@@ -304,6 +398,7 @@ void TrayApp::showPopup() {
 
     m_popup->show();
     m_popup->raise();
+    m_pollScheduler->noteVisible();
     m_popup->activateWindow();
 }
 
@@ -338,47 +433,90 @@ void TrayApp::hidePopup() {
 }
 
 void TrayApp::connectWarp() {
-    m_warp.run(QStringLiteral("connect"), QStringList{QStringLiteral("connect")});
-    setBusy(true);
+    runUserCommand(QStringLiteral("connect"), QStringList{QStringLiteral("connect")});
 }
 
 void TrayApp::disconnectWarp() {
-    m_warp.run(QStringLiteral("disconnect"), QStringList{QStringLiteral("disconnect")});
-    setBusy(true);
+    runUserCommand(QStringLiteral("disconnect"), QStringList{QStringLiteral("disconnect")});
 }
 
+void TrayApp::setMode(const QString &mode) {
+    runUserCommand(QStringLiteral("set_mode"), QStringList{QStringLiteral("mode"), mode});
+}
 
-void TrayApp::onWarpFinished(const QString &requestId, const WarpResult &result) {
-    if (requestId == QStringLiteral("status")) {
-        const QByteArray jsonBytes = result.stdoutText.toUtf8();
-        updateFromStatusJson(jsonBytes);
-        applyUiState();
-        return;
+void TrayApp::runUserCommand(const QString &requestId, const QStringList &args) {
+    m_cache->runCommand(requestId, args);
+    m_pollScheduler->noteUserAction();
+    // The transition this causes is not a dropped connection
+    if (m_connectionLog) {
+        m_connectionLog->noteUserAction();
     }
+    setBusy(true);
+}
+
 
-    if (requestId == QStringLiteral("settings")) {
-        if (result.exitCode == 0) {
-            updateFromSettingsText(result.stdoutText);
+void TrayApp::onStateUpdated(WarpStateCache::Entry entry) {
+    switch (entry) {
+    case WarpStateCache::Entry::Status:
+        // Identical output on the steady-state poll leaves nothing to update
+        if (updateFromStatus()) {
             applyUiState();
         }
+        break;
+    case WarpStateCache::Entry::Settings:
+        if (m_cache->result(entry).succeeded()) {
+            updateFromSettings(m_cache->settings());
+            applyUiState();
+        }
+        break;
+    case WarpStateCache::Entry::Registration:
+        if (m_cache->result(entry).succeeded()) {
+            m_isZeroTrust = m_cache->isZeroTrust();
+            applyUiState();
+        }
+        break;
+    case WarpStateCache::Entry::TunnelStats:
+    case WarpStateCache::Entry::Network:
+        break;
+    }
+}
+
+void TrayApp::onStateFailed(WarpStateCache::Entry entry, const WarpResult &result) {
+    if (entry == WarpStateCache::Entry::Status) {
+        updateFromStatusFailure(result.outcome);
+        applyUiState();
+    }
+}
+
+void TrayApp::onWarpFinished(const QString &requestId, const WarpResult &result) {
+    // Cache fetches and other views share the engine's WarpCli; only handle our own
+    static const QStringList ownCommands{QStringLiteral("connect"), QStringLiteral("disconnect"),
+                                         QStringLiteral("set_mode"), QStringLiteral("registration_new"),
+                                         QStringLiteral("license")};
+    if (result.outcome == WarpResult::Outcome::Cancelled || !ownCommands.contains(requestId)) {
         return;
     }
 
     // Only show error dialogs for registration/license commands
     // Connect/disconnect/set-mode should be silent and show status in popup
-    if (result.exitCode != 0 &&
+    const QString stdoutText = result.stdoutText().trimmed();
+    const QString stderrText = result.stderrText().trimmed();
+    if (!result.succeeded() &&
         (requestId == QStringLiteral("registration_new") ||
          requestId == QStringLiteral("license"))) {
-        const QString msg = !result.stderrText.trimmed().isEmpty()
-                                ? result.stderrText.trimmed()
-                                : (!result.stdoutText.trimmed().isEmpty() ? result.stdoutText.trimmed()
-                                                                          : QStringLiteral("warp-cli failed"));
+        QString msg = !stderrText.isEmpty()
+                          ? stderrText
+                          : (!stdoutText.isEmpty() ? stdoutText
+                                                   : QStringLiteral("warp-cli failed"));
+        if (result.outcome == WarpResult::Outcome::TimedOut) {
+            msg = QStringLiteral("warp-cli did not respond in time");
+        }
         QMessageBox::critical(nullptr, QStringLiteral("WARP"), msg);
-    } else if (result.exitCode == 0 &&
+    } else if (result.succeeded() &&
                (requestId == QStringLiteral("registration_new") ||
                 requestId == QStringLiteral("license"))) {
-        const QString msg = !result.stdoutText.trimmed().isEmpty() ? result.stdoutText.trimmed()
-                                                                   : QStringLiteral("Command completed");
+        const QString msg = !stdoutText.isEmpty() ? stdoutText
+                                                  : QStringLiteral("Command completed");
         QMessageBox::information(nullptr, QStringLiteral("WARP"), msg);
     }
 
@@ -391,57 +529,70 @@ void TrayApp::onWarpFinished(const QString &requestId, const WarpResult &result)
     }
 }
 
-void TrayApp::updateFromStatusJson(const QByteArray &jsonBytes) {
-    const auto doc = QJsonDocument::fromJson(jsonBytes);
-    if (!doc.isObject()) {
+void TrayApp::onStatusChanged(const QByteArray &status) {
+    // The pushed reason is worded differently from the JSON one; fetch the
+    // JSON status so the reason reads the same whichever path delivered it
+    refreshStatus();
+
+    if (status == m_status.status) {
+        return;
+    }
+    m_status.assign(status, QByteArray());
+
+    m_currentStatus = QString::fromUtf8(m_status.status);
+    m_currentReason = QString::fromUtf8(m_status.reason);
+    applyUiState();
+}
+
+void TrayApp::onStatusSubscriptionChanged(bool live) {
+    // A slow verification poll keeps running while live
+    m_pollScheduler->setSuspended(live);
+
+    // Catch up on anything missed while the channel was down
+    if (!live) {
+        refreshStatus();
+    }
+}
+
+bool TrayApp::updateFromStatus() {
+    // The engine thread already parsed the JSON; only copy what changed
+    if (!m_cache->isStatusValid()) {
+        // Forget the last snapshot so the next valid status is applied
+        m_status = StatusSnapshot();
         m_currentStatus = QStringLiteral("Error");
         m_currentReason = QStringLiteral("Invalid JSON from warp-cli");
-        return;
+        return true;
     }
 
-    const QJsonObject obj = doc.object();
-    m_currentStatus = obj.value(QStringLiteral("status")).toString(QStringLiteral("Unknown"));
+    const StatusSnapshot &status = m_cache->status();
+    if (m_status.assign(status.status, status.reason) == StatusSnapshot::ParseResult::Unchanged) {
+        return false;
+    }
 
-    const auto reasonVal = obj.value(QStringLiteral("reason"));
-    if (reasonVal.isObject()) {
-        const QJsonObject r = reasonVal.toObject();
-        if (!r.isEmpty()) {
-            const QString key = r.keys().first();
-            m_currentReason = key + QStringLiteral(": ") + r.value(key).toString();
-        } else {
-            m_currentReason.clear();
-        }
-    } else if (reasonVal.isString()) {
-        m_currentReason = reasonVal.toString();
+    m_currentStatus = QString::fromUtf8(m_status.status);
+    m_currentReason = QString::fromUtf8(m_status.reason);
+    return true;
+}
+
+void TrayApp::updateFromStatusFailure(WarpResult::Outcome outcome) {
+    m_status = StatusSnapshot();
+    if (outcome == WarpResult::Outcome::TimedOut) {
+        m_currentStatus = QStringLiteral("Not responding");
+        m_currentReason = QStringLiteral("warp-svc did not answer in time");
     } else {
-        m_currentReason.clear();
-    }
-}
-
-void TrayApp::updateFromSettingsText(const QString &settingsText) {
-    // Parse the mode from settings output
-    // Looking for lines like "(default)	Mode: Warp" or "(override)	Mode: Doh"
-    const QStringList lines = settingsText.split(QLatin1Char('\n'));
-    for (const QString &line : lines) {
-        if (line.contains(QStringLiteral("Mode:"), Qt::CaseInsensitive)) {
-            // Extract the mode value after "Mode: "
-            const int modeIndex = line.indexOf(QStringLiteral("Mode:"), 0, Qt::CaseInsensitive);
-            if (modeIndex >= 0) {
-                QString mode = line.mid(modeIndex + 5).trimmed();
-                m_currentMode = mode.toLower();
-                break;
-            }
-        }
+        m_currentStatus = QStringLiteral("Error");
+        m_currentReason = QStringLiteral("warp-cli could not be started");
     }
+}
 
-    // Check if enrolled in Zero Trust by checking account type
-    QProcess regProcess;
-    regProcess.start(QStringLiteral("warp-cli"), {QStringLiteral("registration"), QStringLiteral("show")});
-    regProcess.waitForFinished();
-    QString regOutput = QString::fromUtf8(regProcess.readAllStandardOutput());
+void TrayApp::updateFromSettings(const WarpSettings &settings) {
+    // "(default)	Mode: Warp" or "(override)	Mode: Doh"
+    if (!settings.mode.isEmpty()) {
+        m_currentMode = settings.mode.toLower();
+    }
 
-    m_isZeroTrust = regOutput.contains(QStringLiteral("Account type: Team"), Qt::CaseInsensitive) ||
-                    regOutput.contains(QStringLiteral("Organization:"), Qt::CaseInsensitive);
+    // Check if enrolled in Zero Trust by checking account type
+    updateZeroTrustStatus();
 }
 
 void TrayApp::setBusy(bool busy) {
@@ -454,6 +605,9 @@ QString TrayApp::normalizeStatus(const QString &status) {
 }
 
 void TrayApp::applyUiState() {
+    TraceScope trace("ui", "TrayApp::applyUiState");
+    m_pollScheduler->setState(m_status.state);
+
     QString tooltip = QStringLiteral("WARP\nStatus: ") + m_currentStatus;
     if (!m_currentReason.isEmpty()) {
         tooltip += QStringLiteral("\n") + m_currentReason;
@@ -491,75 +645,49 @@ void TrayApp::applyUiState() {
     }
 
     if (connected) {
-        m_tray->setIcon(createTrayIcon(QStringLiteral("connected")));
+        applyTrayIcon(StatusSnapshot::State::Connected);
     } else if (connecting) {
-        m_tray->setIcon(createTrayIcon(QStringLiteral("connecting")));
+        applyTrayIcon(StatusSnapshot::State::Connecting);
     } else {
-        m_tray->setIcon(createTrayIcon(QStringLiteral("disconnected")));
+        applyTrayIcon(StatusSnapshot::State::Disconnected);
     }
+
+    updateColo(connected);
+    emit stateChanged();
 }
 
-QIcon TrayApp::createTrayIcon(const QString &state) {
-    // Load the base icon from theme
-    QIcon baseIcon;
-    if (state == QStringLiteral("disconnected")) {
-        baseIcon = QIcon::fromTheme(QStringLiteral("network-vpn-disconnected"));
-        if (baseIcon.isNull()) {
-            baseIcon = QIcon::fromTheme(QStringLiteral("network-offline"));
-        }
-        if (baseIcon.isNull()) {
-            baseIcon = QIcon::fromTheme(QStringLiteral("network-vpn"));
-        }
-    } else {
-        // Use network-vpn for both connected and connecting
-        baseIcon = QIcon::fromTheme(QStringLiteral("network-vpn"));
+void TrayApp::updateColo(bool connected) {
+    if (connected == m_coloWanted) {
+        return;
     }
-
-    if (baseIcon.isNull()) {
-        return baseIcon;
+    m_coloWanted = connected;
+    m_colo.clear();
+    if (!connected) {
+        return;
     }
 
-    QPixmap pixmap = baseIcon.pixmap(64, 64);
-    QPainter painter(&pixmap);
-    painter.setRenderHint(QPainter::Antialiasing);
-
-    if (state == QStringLiteral("connected")) {
-        // Draw a small lock in the bottom-right corner
-        QColor orange(0xff, 0x6a, 0x00);
-
-        // Lock background circle
-        painter.setPen(Qt::NoPen);
-        painter.setBrush(orange);
-        painter.drawEllipse(QPointF(50, 50), 10, 10);
-
-        // Lock symbol
-        painter.setPen(QPen(Qt::white, 1.5));
-        painter.setBrush(Qt::white);
-
-        // Lock body
-        QRectF lockBody(47, 51, 6, 6);
-        painter.drawRoundedRect(lockBody, 0.5, 0.5);
-
-        // Lock shackle
-        painter.setBrush(Qt::NoBrush);
-        painter.drawArc(48, 47, 4, 4, 0, 180 * 16);
-
-    } else if (state == QStringLiteral("connecting")) {
-        // Draw animated dots in bottom-right corner
-        QColor orange(0xff, 0x6a, 0x00);
-
-        // Orange circle background
-        painter.setPen(Qt::NoPen);
-        painter.setBrush(orange);
-        painter.drawEllipse(QPointF(50, 50), 10, 10);
+    // One in-process cdn-cgi/trace request per connection
+    if (!m_probes) {
+        m_probes = new ProbeEngine(this);
+        connect(m_probes, &ProbeEngine::probeFinished, this, &TrayApp::onProbeFinished);
+    }
+    m_probes->run(ProbeEngine::Probe::Trace);
+}
 
-        // Three white dots
-        painter.setBrush(Qt::white);
-        painter.drawEllipse(QPointF(44, 50), 2, 2);
-        painter.drawEllipse(QPointF(50, 50), 2, 2);
-        painter.drawEllipse(QPointF(56, 50), 2, 2);
+void TrayApp::onProbeFinished(ProbeEngine::Probe probe, const ProbeEngine::Report &report) {
+    if (probe != ProbeEngine::Probe::Trace || !m_coloWanted || !report.ok) {
+        return;
     }
+    m_colo = report.detail;
+    emit stateChanged();
+}
 
-    painter.end();
-    return QIcon(pixmap);
+void TrayApp::applyTrayIcon(StatusSnapshot::State state) {
+    // Most updates leave the state unchanged; skip the tray round-trip then
+    const QIcon icon = m_trayIcons->icon(state);
+    if (icon.isNull() || icon.cacheKey() == m_trayIconKey) {
+        return;
+    }
+    m_trayIconKey = icon.cacheKey();
+    m_tray->setIcon(icon);
 }
@@ -3,17 +3,27 @@
 #include <QObject>
 #include <QSystemTrayIcon>
 #include <QString>
+#include <QStringList>
 
 class QAction;
 class QMenu;
-class QTimer;
 class QWidgetAction;
 class QWidget;
 
+class ConnectionLog;
+class DBusService;
+class PollScheduler;
+class StateServer;
+class StatusPage;
+class PreferencesDialog;
 class WarpPopup;
 class SettingsMenu;
+class TrayIconCache;
 
-#include "warp_cli.h"
+#include "probe_engine.h"
+#include "single_instance.h"
+#include "status_snapshot.h"
+#include "warp_state_cache.h"
 
 class TrayApp : public QObject {
     Q_OBJECT
@@ -22,6 +32,28 @@ public:
     explicit TrayApp(QObject *parent = nullptr);
     void start();
 
+    // What the tray currently shows; also published on D-Bus and in the
+    // status page
+    StatusSnapshot::State state() const;
+    QString statusText() const;
+    QString statusReason() const;
+    QString mode() const;
+    bool isBusy() const;
+    bool isZeroTrust() const;
+    // Cloudflare colocation center while connected, empty until known
+    QString colo() const;
+
+public slots:
+    void connectWarp();
+    void disconnectWarp();
+    void setMode(const QString &mode);
+    // From the command line, or forwarded by a second launch
+    void handleCommand(SingleInstance::Command command);
+
+signals:
+    // The shown state was re-applied and may differ from before
+    void stateChanged();
+
 private slots:
     void refreshStatus();
     void refreshSettings();
@@ -29,25 +61,34 @@ private slots:
     void onTrayActivated(QSystemTrayIcon::ActivationReason reason);
     void showPopup();
     void hidePopup();
+    void showPreferences();
+    void saveTrace();
 
 private:
-    void connectWarp();
-    void disconnectWarp();
-
+    void runUserCommand(const QString &requestId, const QStringList &args);
     void onWarpFinished(const QString &requestId, const WarpResult &result);
-
-    void updateFromStatusJson(const QByteArray &jsonBytes);
-    void updateFromSettingsText(const QString &settingsText);
+    void onStateUpdated(WarpStateCache::Entry entry);
+    void onStateFailed(WarpStateCache::Entry entry, const WarpResult &result);
+    void onStatusChanged(const QByteArray &status);
+    void onStatusSubscriptionChanged(bool live);
+
+    bool updateFromStatus();
+    void updateFromStatusFailure(WarpResult::Outcome outcome);
+    void updateFromSettings(const WarpSettings &settings);
     void setBusy(bool busy);
     void applyUiState();
+    void applyTrayIcon(StatusSnapshot::State state);
+    void updateColo(bool connected);
+    void onProbeFinished(ProbeEngine::Probe probe, const ProbeEngine::Report &report);
 
     static QString normalizeStatus(const QString &status);
-    static QIcon createTrayIcon(const QString &state);
 
-    WarpCli m_warp;
+    WarpStateCache *m_cache;
 
     QSystemTrayIcon *m_tray;
     QMenu *m_menu;
+    TrayIconCache *m_trayIcons;
+    qint64 m_trayIconKey;
 
     QAction *m_statusAction;
     QAction *m_connectAction;
@@ -55,16 +96,25 @@ private:
     QAction *m_preferencesAction;
     QAction *m_quitAction;
 
-    QTimer *m_poll;
+    PollScheduler *m_pollScheduler;
 
     WarpPopup *m_popup;
     SettingsMenu *m_settingsMenu;
-
+    PreferencesDialog *m_preferences;
+    DBusService *m_dbus;
+    StatusPage *m_statusPage;
+    StateServer *m_stateServer;
+    ConnectionLog *m_connectionLog;
+    ProbeEngine *m_probes; // created on the first connect, for the colo
+
+    StatusSnapshot m_status;
     QString m_currentStatus;
     QString m_currentReason;
     QString m_currentMode;
     bool m_busy;
     bool m_isZeroTrust;
+    QString m_colo;
+    bool m_coloWanted;
     QPoint m_lastCursorPos; // Store cursor position when tray is clicked
     QPoint m_popupOffset; // User's custom popup position offset
     
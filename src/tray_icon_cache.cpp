@@ -0,0 +1,144 @@
+#include "tray_icon_cache.h"
+
+#include <QEvent>
+#include <QGuiApplication>
+#include <QPainter>
+#include <QPixmap>
+#include <QScreen>
+
+#include "trace.h"
+
+namespace {
+
+// Sizes trays commonly ask for; the badge is drawn on a 64 px design grid
+constexpr int kIconSizes[] = {16, 22, 24, 32, 48, 64};
+constexpr qreal kDesignSize = 64.0;
+
+QIcon themeIcon(StatusSnapshot::State state) {
+    QIcon icon;
+    if (state != StatusSnapshot::State::Connected && state != StatusSnapshot::State::Connecting) {
+        icon = QIcon::fromTheme(QStringLiteral("network-vpn-disconnected"));
+        if (icon.isNull()) {
+            icon = QIcon::fromTheme(QStringLiteral("network-offline"));
+        }
+    }
+    if (icon.isNull()) {
+        // Use network-vpn for both connected and connecting
+        icon = QIcon::fromTheme(QStringLiteral("network-vpn"));
+    }
+    return icon;
+}
+
+void paintBadge(QPainter &painter, StatusSnapshot::State state) {
+    const QColor orange(0xff, 0x6a, 0x00);
+
+    if (state == StatusSnapshot::State::Connected) {
+        // Draw a small lock in the bottom-right corner
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(orange);
+        painter.drawEllipse(QPointF(50, 50), 10, 10);
+
+        painter.setPen(QPen(Qt::white, 1.5));
+        painter.setBrush(Qt::white);
+
+        // Lock body
+        painter.drawRoundedRect(QRectF(47, 51, 6, 6), 0.5, 0.5);
+
+        // Lock shackle
+        painter.setBrush(Qt::NoBrush);
+        painter.drawArc(QRectF(48, 47, 4, 4), 0, 180 * 16);
+    } else if (state == StatusSnapshot::State::Connecting) {
+        // Orange circle with three white dots
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(orange);
+        painter.drawEllipse(QPointF(50, 50), 10, 10);
+
+        painter.setBrush(Qt::white);
+        painter.drawEllipse(QPointF(44, 50), 2, 2);
+        painter.drawEllipse(QPointF(50, 50), 2, 2);
+        painter.drawEllipse(QPointF(56, 50), 2, 2);
+    }
+}
+
+} // namespace
+
+TrayIconCache::TrayIconCache(QObject *parent)
+    : QObject(parent),
+      m_themeName(QIcon::themeName()),
+      m_devicePixelRatio(qApp->devicePixelRatio()) {
+    // Theme changes are delivered to windows, not to us, so watch them all
+    qApp->installEventFilter(this);
+
+    for (QScreen *screen : QGuiApplication::screens()) {
+        watchScreen(screen);
+    }
+    connect(qApp, &QGuiApplication::screenAdded, this, [this](QScreen *screen) {
+        watchScreen(screen);
+        checkEnvironment();
+    });
+    connect(qApp, &QGuiApplication::screenRemoved, this, &TrayIconCache::checkEnvironment);
+}
+
+QIcon TrayIconCache::icon(StatusSnapshot::State state) {
+    if (state != StatusSnapshot::State::Connected && state != StatusSnapshot::State::Connecting) {
+        state = StatusSnapshot::State::Disconnected;
+    }
+
+    auto it = m_icons.find(state);
+    if (it == m_icons.end()) {
+        it = m_icons.insert(state, render(state, m_devicePixelRatio));
+    }
+    return it.value();
+}
+
+void TrayIconCache::invalidate() {
+    m_icons.clear();
+    m_themeName = QIcon::themeName();
+    m_devicePixelRatio = qApp->devicePixelRatio();
+    emit invalidated();
+}
+
+bool TrayIconCache::eventFilter(QObject *watched, QEvent *event) {
+    if (event->type() == QEvent::ThemeChange) {
+        checkEnvironment();
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+void TrayIconCache::watchScreen(QScreen *screen) {
+    connect(screen, &QScreen::logicalDotsPerInchChanged, this, &TrayIconCache::checkEnvironment);
+    connect(screen, &QScreen::physicalDotsPerInchChanged, this, &TrayIconCache::checkEnvironment);
+}
+
+void TrayIconCache::checkEnvironment() {
+    // Every top-level window gets its own ThemeChange, so only act once
+    if (QIcon::themeName() != m_themeName || !qFuzzyCompare(qApp->devicePixelRatio(), m_devicePixelRatio)) {
+        invalidate();
+    }
+}
+
+QIcon TrayIconCache::render(StatusSnapshot::State state, qreal devicePixelRatio) {
+    TraceScope trace("ui", "TrayIconCache::render");
+    const QIcon base = themeIcon(state);
+    if (base.isNull()) {
+        return base;
+    }
+
+    QIcon icon;
+    for (int size : kIconSizes) {
+        QPixmap pixmap = base.pixmap(QSize(size, size), devicePixelRatio);
+        if (pixmap.isNull()) {
+            continue;
+        }
+        pixmap.setDevicePixelRatio(devicePixelRatio);
+
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.scale(size / kDesignSize, size / kDesignSize);
+        paintBadge(painter, state);
+        painter.end();
+
+        icon.addPixmap(pixmap);
+    }
+    return icon;
+}
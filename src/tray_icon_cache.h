@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QHash>
+#include <QIcon>
+#include <QObject>
+#include <QString>
+
+#include "status_snapshot.h"
+
+class QScreen;
+
+// Rendered tray icons, one per connection state. Each icon is painted once
+// at every tray size for the current theme and device pixel ratio, then
+// reused until the icon theme or a screen's scale changes.
+class TrayIconCache : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TrayIconCache(QObject *parent = nullptr);
+
+    // Connecting shows a dots badge, Connected a lock; anything else is plain
+    QIcon icon(StatusSnapshot::State state);
+
+    void invalidate();
+
+signals:
+    // Cached icons were dropped; callers should fetch theirs again
+    void invalidated();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    static QIcon render(StatusSnapshot::State state, qreal devicePixelRatio);
+    void watchScreen(QScreen *screen);
+    void checkEnvironment();
+
+    QHash<StatusSnapshot::State, QIcon> m_icons;
+    QString m_themeName;
+    qreal m_devicePixelRatio;
+};
@@ -1,44 +1,303 @@
 #include "warp_cli.h"
 
-#include <QProcess>
+#include "daemon_transport.h"
+#include "perf_counters.h"
+#include "status_watch.h"
+#include "subprocess_transport.h"
+#include "trace.h"
 
-WarpCli::WarpCli(QObject *parent) : QObject(parent) {}
+#include <QTimer>
+
+WarpCli::WarpCli(QObject *parent)
+    : QObject(parent),
+      m_subprocess(new SubprocessTransport(this)),
+      m_daemon(nullptr),
+      m_watch(new StatusWatch(this)),
+      m_nextTicket(1),
+      m_freshnessMs(0),
+      m_backgroundLimit(2),
+      m_defaultTimeoutMs(kDefaultTimeoutMs) {
+    m_clock.start();
+    connect(m_subprocess, &WarpTransport::completed, this, &WarpCli::onTransportCompleted);
+    connect(m_watch, &StatusWatch::statusUpdate, this, &WarpCli::onStatusUpdate);
+    connect(m_watch, &StatusWatch::liveChanged, this, &WarpCli::statusSubscriptionChanged);
+
+    const QString socketPath = DaemonTransport::configuredSocketPath();
+    if (!socketPath.isEmpty()) {
+        m_daemon = new DaemonTransport(socketPath, this);
+        connect(m_daemon, &WarpTransport::completed, this, &WarpCli::onTransportCompleted);
+        connect(m_daemon, &WarpTransport::dropped, this, &WarpCli::onTransportDropped);
+    }
+}
 
 bool WarpCli::isRunning(const QString &requestId) const {
-    auto *proc = m_running.value(requestId, nullptr);
-    return proc != nullptr && proc->state() != QProcess::NotRunning;
+    for (const Pending &pending : m_pending) {
+        if (pending.waiters.contains(requestId)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void WarpCli::run(const QString &requestId, const QStringList &args, int timeoutMs) {
+    startProcess(requestId, args, timeoutMs, Kind::Query);
+}
+
+void WarpCli::runJson(const QString &requestId, const QStringList &args, int timeoutMs) {
+    run(requestId, QStringList{QStringLiteral("-j")} + args, timeoutMs);
+}
+
+void WarpCli::runCommand(const QString &requestId, const QStringList &args, int timeoutMs) {
+    startProcess(requestId, args, timeoutMs, Kind::Command);
+}
+
+bool WarpCli::cancel(const QString &requestId) {
+    for (auto it = m_pending.begin(); it != m_pending.end(); ++it) {
+        if (!it->waiters.contains(requestId)) {
+            continue;
+        }
+
+        const quint64 ticket = it.key();
+        const WarpResult cancelled = WarpResult::withOutcome(WarpResult::Outcome::Cancelled);
+        if (it->waiters.size() > 1) {
+            // Others still want this result; only detach this caller
+            it->waiters.removeAll(requestId);
+            emit finished(requestId, cancelled);
+        } else {
+            finishPending(ticket, cancelled, true);
+        }
+        return true;
+    }
+    return false;
+}
+
+void WarpCli::setDefaultTimeout(int ms) {
+    m_defaultTimeoutMs = qMax(1, ms);
+}
+
+int WarpCli::defaultTimeout() const {
+    return m_defaultTimeoutMs;
+}
+
+QString WarpCli::queryTransportName() const {
+    return transportFor(Kind::Query)->name();
+}
+
+void WarpCli::setFreshnessWindow(int ms) {
+    m_freshnessMs = qMax(0, ms);
+    if (m_freshnessMs == 0) {
+        m_recent.clear();
+    }
+}
+
+int WarpCli::freshnessWindow() const {
+    return m_freshnessMs;
+}
+
+void WarpCli::setBackgroundConcurrency(int limit) {
+    m_backgroundLimit = qMax(1, limit);
+    pumpBackgroundQueue();
+}
+
+int WarpCli::backgroundConcurrency() const {
+    return m_backgroundLimit;
+}
+
+WarpCli::LaneStats WarpCli::laneStats(Lane lane) const {
+    return lane == Lane::Interactive ? m_interactiveStats : m_backgroundStats;
+}
+
+WarpCli::LaneStats &WarpCli::statsFor(Lane lane) {
+    return lane == Lane::Interactive ? m_interactiveStats : m_backgroundStats;
+}
+
+void WarpCli::subscribeStatus() {
+    m_watch->start();
+}
+
+void WarpCli::unsubscribeStatus() {
+    m_watch->stop();
+}
+
+bool WarpCli::isStatusSubscriptionLive() const {
+    return m_watch->isLive();
+}
+
+void WarpCli::restartStatusSubscription() {
+    if (m_watch->isLive()) {
+        m_watch->restart();
+    }
 }
 
-void WarpCli::run(const QString &requestId, const QStringList &args) {
-    startProcess(requestId, QStringList{QStringLiteral("--accept-tos"), QStringLiteral("--no-paginate")} + args);
+void WarpCli::onStatusUpdate(const QByteArray &status) {
+    // A pushed change makes any cached status output stale
+    m_recent.clear();
+    emit statusChanged(status);
 }
 
-void WarpCli::runJson(const QString &requestId, const QStringList &args) {
-    run(requestId, QStringList{QStringLiteral("-j")} + args);
+WarpCli::Lane WarpCli::laneFor(Kind kind) {
+    // A user action must never wait behind polling
+    return kind == Kind::Command ? Lane::Interactive : Lane::Background;
 }
 
-void WarpCli::startProcess(const QString &requestId, const QStringList &args) {
-    if (isRunning(requestId)) {
+void WarpCli::startProcess(const QString &requestId, const QStringList &commandArgs, int timeoutMs, Kind kind) {
+    const QStringList args =
+        QStringList{QStringLiteral("--accept-tos"), QStringLiteral("--no-paginate")} + commandArgs;
+    if (timeoutMs < 0) {
+        timeoutMs = m_defaultTimeoutMs;
+    }
+    const QString key = commandKey(kind, args);
+
+    if (kind == Kind::Query && m_freshnessMs > 0) {
+        const auto recent = m_recent.constFind(key);
+        if (recent != m_recent.constEnd() &&
+            m_clock.elapsed() - recent->completedAtMs <= m_freshnessMs) {
+            PerfCounters::noteCacheHit();
+            deliverRecent(requestId, recent->result);
+            return;
+        }
+    }
+
+    // Attach to an identical command that is already running
+    const auto running = m_inFlight.constFind(key);
+    if (running != m_inFlight.constEnd()) {
+        Pending &pending = m_pending[running.value()];
+        PerfCounters::noteCacheHit();
+        if (!pending.waiters.contains(requestId)) {
+            pending.waiters.append(requestId);
+        }
         return;
     }
 
-    auto *proc = new QProcess(this);
-    m_running.insert(requestId, proc);
+    PerfCounters::noteCacheMiss();
+    const quint64 ticket = m_nextTicket++;
+    const Lane lane = laneFor(kind);
+    m_pending.insert(ticket, Pending{key, args, QStringList{requestId}, kind, lane, m_clock.elapsed(), timeoutMs,
+                                     nullptr, nullptr});
+    m_inFlight.insert(key, ticket);
+    if (Trace::isEnabled()) {
+        Trace::asyncBegin("warp-cli", "warp-cli", ticket, args.join(QLatin1Char(' ')));
+    }
 
-    proc->setProgram(QStringLiteral("warp-cli"));
-    proc->setArguments(args);
+    if (lane == Lane::Interactive) {
+        dispatch(ticket);
+        return;
+    }
 
-    connect(proc, &QProcess::finished, this, [this, requestId, proc](int exitCode, QProcess::ExitStatus) {
-        WarpResult result;
-        result.exitCode = exitCode;
-        result.stdoutText = QString::fromUtf8(proc->readAllStandardOutput());
-        result.stderrText = QString::fromUtf8(proc->readAllStandardError());
+    m_backgroundQueue.enqueue(ticket);
+    m_backgroundStats.queued = m_backgroundQueue.size();
+    pumpBackgroundQueue();
+}
 
-        m_running.remove(requestId);
-        emit finished(requestId, result);
+void WarpCli::dispatch(quint64 ticket) {
+    Pending &pending = m_pending[ticket];
+
+    LaneStats &stats = statsFor(pending.lane);
+    const qint64 waited = m_clock.elapsed() - pending.queuedAtMs;
+    stats.running++;
+    stats.started++;
+    stats.lastWaitMs = waited;
+    stats.maxWaitMs = qMax(stats.maxWaitMs, waited);
+    stats.totalWaitMs += waited;
 
-        proc->deleteLater();
+    // The deadline covers execution only, not time spent waiting in the queue
+    pending.deadline = new QTimer(this);
+    pending.deadline->setSingleShot(true);
+    connect(pending.deadline, &QTimer::timeout, this, [this, ticket]() { onDeadline(ticket); });
+    pending.deadline->start(pending.timeoutMs);
+
+    pending.transport = transportFor(pending.kind);
+    pending.dispatchedAtNs = m_clock.nsecsElapsed();
+    Trace::asyncInstant("warp-cli", "spawned", ticket);
+    pending.transport->submit(ticket, pending.args);
+}
+
+void WarpCli::onDeadline(quint64 ticket) {
+    if (m_pending.contains(ticket)) {
+        finishPending(ticket, WarpResult::withOutcome(WarpResult::Outcome::TimedOut), true);
+    }
+}
+
+void WarpCli::pumpBackgroundQueue() {
+    while (!m_backgroundQueue.isEmpty() && m_backgroundStats.running < m_backgroundLimit) {
+        dispatch(m_backgroundQueue.dequeue());
+    }
+    m_backgroundStats.queued = m_backgroundQueue.size();
+}
+
+void WarpCli::deliverRecent(const QString &requestId, const WarpResult &result) {
+    // Keep delivery asynchronous so callers see the same ordering as a real run
+    QTimer::singleShot(0, this, [this, requestId, result]() {
+        emit finished(requestId, result);
     });
+}
+
+void WarpCli::onTransportCompleted(quint64 ticket, const WarpResult &result) {
+    if (m_pending.contains(ticket)) {
+        finishPending(ticket, result, false);
+    }
+}
+
+void WarpCli::finishPending(quint64 ticket, const WarpResult &result, bool abortTransport) {
+    const Pending pending = m_pending.take(ticket);
+    m_inFlight.remove(pending.key);
+    if (Trace::isEnabled()) {
+        Trace::asyncEnd("warp-cli", "warp-cli", ticket, QStringLiteral("outcome %1, exit code %2")
+                                                             .arg(static_cast<int>(result.outcome))
+                                                             .arg(result.exitCode));
+    }
+
+    const bool dispatched = pending.transport != nullptr;
+    if (dispatched) {
+        statsFor(pending.lane).running--;
+        if (result.outcome != WarpResult::Outcome::Cancelled) {
+            PerfCounters::histogram(PerfCounters::seriesForCommand(pending.args))
+                .record((m_clock.nsecsElapsed() - pending.dispatchedAtNs) / 1000);
+        }
+        // May be the timer whose timeout got us here, so defer deletion
+        pending.deadline->stop();
+        pending.deadline->deleteLater();
+        if (abortTransport) {
+            pending.transport->abort(ticket);
+        }
+    } else {
+        m_backgroundQueue.removeAll(ticket);
+        m_backgroundStats.queued = m_backgroundQueue.size();
+    }
+
+    if (pending.kind == Kind::Command) {
+        // A state-changing command invalidates every cached query, even when
+        // it timed out or was cancelled: warp-svc may have applied it anyway
+        m_recent.clear();
+    } else if (result.outcome == WarpResult::Outcome::Finished && m_freshnessMs > 0) {
+        m_recent.insert(pending.key, Recent{result, m_clock.elapsed()});
+    }
+
+    for (const QString &requestId : pending.waiters) {
+        emit finished(requestId, result);
+    }
+
+    pumpBackgroundQueue();
+}
+
+void WarpCli::onTransportDropped(quint64 ticket) {
+    // The daemon connection went away mid-request; rerun it as a process
+    const auto it = m_pending.find(ticket);
+    if (it != m_pending.end()) {
+        it->transport = m_subprocess;
+        m_subprocess->submit(ticket, it->args);
+    }
+}
+
+WarpTransport *WarpCli::transportFor(Kind kind) const {
+    if (m_daemon && m_daemon->isAvailable() && kind == Kind::Query) {
+        return m_daemon;
+    }
+    return m_subprocess;
+}
 
-    proc->start();
+QString WarpCli::commandKey(Kind kind, const QStringList &args) {
+    // A command never shares a run with a query that happens to match it
+    const QChar tag = kind == Kind::Query ? QLatin1Char('q') : QLatin1Char('c');
+    return tag + args.join(QChar(0x1f));
 }
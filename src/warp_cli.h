@@ -1,34 +1,145 @@
 #pragma once
 
 #include <QObject>
+#include <QElapsedTimer>
 #include <QHash>
+#include <QQueue>
 #include <QString>
 #include <QStringList>
 
-class QProcess;
+#include "warp_transport.h"
 
-struct WarpResult {
-    int exitCode;
-    QString stdoutText;
-    QString stderrText;
-};
+class DaemonTransport;
+class QTimer;
+class StatusWatch;
+class SubprocessTransport;
 
 class WarpCli : public QObject {
     Q_OBJECT
 
 public:
+    // Commands (connect, registration, Preferences changes and anything
+    // else submitted through runCommand) always start right away. Queries
+    // run in the background lane, which is capped.
+    enum class Lane { Interactive, Background };
+
+    // Set by the caller: queries only read, so their results may be reused
+    // and sent over the daemon socket; a command may change state, so its
+    // completion drops every reusable query result.
+    enum class Kind { Query, Command };
+
+    struct LaneStats {
+        int queued = 0;
+        int running = 0;
+        quint64 started = 0;
+        qint64 lastWaitMs = 0;
+        qint64 maxWaitMs = 0;
+        qint64 totalWaitMs = 0;
+
+        qint64 averageWaitMs() const { return started ? totalWaitMs / static_cast<qint64>(started) : 0; }
+    };
+
+    static constexpr int kDefaultTimeoutMs = 15000;
+
     explicit WarpCli(QObject *parent = nullptr);
 
     bool isRunning(const QString &requestId) const;
 
-    void run(const QString &requestId, const QStringList &args);
-    void runJson(const QString &requestId, const QStringList &args);
+    // timeoutMs < 0 uses defaultTimeout(). A command that overruns its
+    // deadline is killed and reported with Outcome::TimedOut.
+    // run and runJson are for read-only queries.
+    void run(const QString &requestId, const QStringList &args, int timeoutMs = -1);
+    void runJson(const QString &requestId, const QStringList &args, int timeoutMs = -1);
+    // Anything that may change warp-svc's state
+    void runCommand(const QString &requestId, const QStringList &args, int timeoutMs = -1);
+
+    // Withdraws requestId. Its caller receives Outcome::Cancelled; the command
+    // itself is stopped once no other caller is waiting on it.
+    bool cancel(const QString &requestId);
+
+    void setDefaultTimeout(int ms);
+    int defaultTimeout() const;
+
+    // Name of the transport that currently answers read-only queries
+    QString queryTransportName() const;
+
+    // Queries issued within this many milliseconds of an identical completed
+    // query reuse its result instead of running again. 0 disables reuse.
+    void setFreshnessWindow(int ms);
+    int freshnessWindow() const;
+
+    // Maximum number of background commands running at once (at least 1)
+    void setBackgroundConcurrency(int limit);
+    int backgroundConcurrency() const;
+
+    LaneStats laneStats(Lane lane) const;
+    static Lane laneFor(Kind kind);
+
+    // Keeps a status watch channel open and reports changes through
+    // statusChanged. Callers should poll only slowly, to verify, while it is
+    // live.
+    void subscribeStatus();
+    void unsubscribeStatus();
+    bool isStatusSubscriptionLive() const;
+    // A status query failed while the channel claimed to be live
+    void restartStatusSubscription();
 
 signals:
     void finished(const QString &requestId, const WarpResult &result);
+    // Only the status word; fetch the JSON status for the reason
+    void statusChanged(const QByteArray &status);
+    void statusSubscriptionChanged(bool live);
 
 private:
-    void startProcess(const QString &requestId, const QStringList &args);
+    // One running command; every caller that asked for it while it was in
+    // flight is listed in waiters and receives the same result.
+    struct Pending {
+        QString key;
+        QStringList args;
+        QStringList waiters;
+        Kind kind;
+        Lane lane;
+        qint64 queuedAtMs;
+        int timeoutMs;
+        WarpTransport *transport;
+        QTimer *deadline;
+        qint64 dispatchedAtNs = -1;
+    };
+
+    struct Recent {
+        WarpResult result;
+        qint64 completedAtMs; // on m_clock
+    };
+
+    void startProcess(const QString &requestId, const QStringList &args, int timeoutMs, Kind kind);
+    void deliverRecent(const QString &requestId, const WarpResult &result);
+    void dispatch(quint64 ticket);
+    void pumpBackgroundQueue();
+    void onDeadline(quint64 ticket);
+    // Removes ticket, stopping its command if it was dispatched, and hands
+    // result to every waiter.
+    void finishPending(quint64 ticket, const WarpResult &result, bool abortTransport);
+    void onTransportCompleted(quint64 ticket, const WarpResult &result);
+    void onTransportDropped(quint64 ticket);
+    void onStatusUpdate(const QByteArray &status);
+    WarpTransport *transportFor(Kind kind) const;
+
+    static QString commandKey(Kind kind, const QStringList &args);
+    LaneStats &statsFor(Lane lane);
+
+    SubprocessTransport *m_subprocess;
+    DaemonTransport *m_daemon;
+    StatusWatch *m_watch;
 
-    QHash<QString, QProcess *> m_running;
+    QHash<quint64, Pending> m_pending;
+    QHash<QString, quint64> m_inFlight;
+    QHash<QString, Recent> m_recent;
+    QQueue<quint64> m_backgroundQueue;
+    LaneStats m_interactiveStats;
+    LaneStats m_backgroundStats;
+    QElapsedTimer m_clock;
+    quint64 m_nextTicket;
+    int m_freshnessMs;
+    int m_backgroundLimit;
+    int m_defaultTimeoutMs;
 };
@@ -0,0 +1,172 @@
+#include "warp_engine.h"
+
+#include <atomic>
+
+#include "perf_counters.h"
+#include "warp_cli.h"
+
+WarpEngine::WarpEngine(QObject *parent)
+    : QObject(parent),
+      m_cli(nullptr) {
+    m_queries[static_cast<size_t>(Entry::Status)] = Query{QStringLiteral("cache:status"), {QStringLiteral("status")}, true};
+    m_queries[static_cast<size_t>(Entry::Settings)] = Query{QStringLiteral("cache:settings"), {QStringLiteral("settings")}, false};
+    m_queries[static_cast<size_t>(Entry::Registration)] =
+        Query{QStringLiteral("cache:registration"), {QStringLiteral("registration"), QStringLiteral("show")}, false};
+    m_queries[static_cast<size_t>(Entry::TunnelStats)] =
+        Query{QStringLiteral("cache:tunnel-stats"), {QStringLiteral("tunnel"), QStringLiteral("stats")}, false};
+    m_queries[static_cast<size_t>(Entry::Network)] =
+        Query{QStringLiteral("cache:network"), {QStringLiteral("debug"), QStringLiteral("network")}, false};
+
+    state(Entry::Status).ttlMs = 1000;
+    state(Entry::Settings).ttlMs = 30000;
+    state(Entry::Registration).ttlMs = 60000;
+    state(Entry::TunnelStats).ttlMs = 5000;
+    state(Entry::Network).ttlMs = 30000;
+    m_published = std::make_shared<const Snapshot>(m_working);
+}
+
+void WarpEngine::initialize() {
+    m_cli = new WarpCli(this);
+
+    // Opening Preferences fetches settings, registration, tunnel stats and
+    // debug network together; let them all run at once
+    m_cli->setBackgroundConcurrency(4);
+
+    connect(m_cli, &WarpCli::finished, this, &WarpEngine::onFinished);
+    // A pushed status means the stored JSON no longer matches the daemon
+    connect(m_cli, &WarpCli::statusChanged, this, [this]() { invalidate(Entry::Status); });
+}
+
+WarpCli *WarpEngine::cli() const {
+    return m_cli;
+}
+
+std::shared_ptr<const WarpEngine::Snapshot> WarpEngine::current() const {
+    return std::atomic_load(&m_published);
+}
+
+WarpStateCache::EntryState &WarpEngine::state(Entry entry) {
+    return m_working.entries[static_cast<size_t>(entry)];
+}
+
+bool WarpEngine::isFresh(Entry entry) const {
+    return m_working.at(entry).isFresh(WarpStateCache::clockMs());
+}
+
+void WarpEngine::request(Entry entry) {
+    if (isFresh(entry)) {
+        PerfCounters::noteCacheHit();
+    } else {
+        refresh(entry);
+    }
+}
+
+void WarpEngine::refresh(Entry entry) {
+    // WarpCli folds this into an identical fetch that is already running
+    const Query &query = m_queries[static_cast<size_t>(entry)];
+    if (query.json) {
+        m_cli->runJson(query.requestId, query.args);
+    } else {
+        m_cli->run(query.requestId, query.args);
+    }
+}
+
+void WarpEngine::invalidate(Entry entry) {
+    if (!state(entry).stale) {
+        state(entry).stale = true;
+        publish(entry, Event::Invalidated);
+    }
+}
+
+void WarpEngine::invalidateAll() {
+    for (int i = 0; i < WarpStateCache::kEntryCount; ++i) {
+        invalidate(static_cast<Entry>(i));
+    }
+}
+
+void WarpEngine::setTtl(Entry entry, int ms) {
+    state(entry).ttlMs = qMax(0, ms);
+    publish(entry, Event::Invalidated);
+}
+
+void WarpEngine::runCommand(const QString &requestId, const QStringList &args) {
+    m_commands.insert(requestId);
+    m_cli->runCommand(requestId, args);
+}
+
+void WarpEngine::onFinished(const QString &requestId, const WarpResult &result) {
+    if (m_commands.remove(requestId)) {
+        invalidateAll();
+        return;
+    }
+
+    for (size_t i = 0; i < m_queries.size(); ++i) {
+        if (m_queries[i].requestId != requestId) {
+            continue;
+        }
+
+        const Entry entry = static_cast<Entry>(i);
+        WarpStateCache::EntryState &s = state(entry);
+        if (result.outcome == WarpResult::Outcome::Cancelled) {
+            return;
+        }
+        if (result.outcome != WarpResult::Outcome::Finished) {
+            if (entry == Entry::Status) {
+                // The daemon is not answering, so a live watch channel is
+                // most likely stuck as well; fall back to polling
+                m_cli->restartStatusSubscription();
+            }
+            s.lastFailure = result;
+            publish(entry, Event::Failed);
+            return;
+        }
+
+        const bool isChanged = s.fetchedAtMs < 0 || s.result.stdoutData != result.stdoutData;
+        s.result = result;
+        s.fetchedAtMs = WarpStateCache::clockMs();
+        s.stale = false;
+        if (isChanged) {
+            s.version++;
+            parse(entry);
+        }
+
+        publish(entry, isChanged ? Event::Changed : Event::Updated);
+        return;
+    }
+}
+
+void WarpEngine::parse(Entry entry) {
+    const QByteArray &output = state(entry).result.stdoutData;
+
+    switch (entry) {
+    case Entry::Status:
+        if (m_status.parseJson(output) == StatusSnapshot::ParseResult::Invalid) {
+            // Forget the last snapshot so the next valid status is applied
+            m_status = StatusSnapshot();
+            m_working.statusValid = false;
+        } else {
+            m_working.statusValid = true;
+        }
+        m_working.status = m_status;
+        break;
+    case Entry::Settings:
+        m_working.settings = std::make_shared<const WarpSettings>(WarpSettings::parse(output));
+        break;
+    case Entry::Registration: {
+        const QString registration = QString::fromUtf8(output);
+        m_working.zeroTrust = registration.contains(QStringLiteral("Account type: Team"), Qt::CaseInsensitive) ||
+                              registration.contains(QStringLiteral("Organization:"), Qt::CaseInsensitive);
+        break;
+    }
+    case Entry::TunnelStats:
+    case Entry::Network:
+        break;
+    }
+}
+
+void WarpEngine::publish(Entry entry, Event event) {
+    // Readers keep whatever snapshot they hold; this only swaps the pointer
+    auto next = std::make_shared<const Snapshot>(m_working);
+    std::atomic_store(&m_published, next);
+    emit published(std::move(next), entry, event);
+}
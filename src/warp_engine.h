@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <array>
+#include <memory>
+
+#include "status_snapshot.h"
+#include "warp_state_cache.h"
+
+class WarpCli;
+
+// Worker behind WarpStateCache. Lives on its own thread together with the
+// WarpCli it owns, so launching warp-cli, reading its output and parsing
+// it never run on the GUI thread. Each change is published as a new
+// immutable snapshot; nothing already published is ever modified.
+class WarpEngine : public QObject {
+    Q_OBJECT
+
+public:
+    using Entry = WarpStateCache::Entry;
+    using Event = WarpStateCache::Event;
+    using Snapshot = WarpStateCache::Snapshot;
+
+    explicit WarpEngine(QObject *parent = nullptr);
+
+    // Creates the WarpCli. Must run on the engine thread.
+    void initialize();
+    WarpCli *cli() const;
+
+    // Latest published snapshot. Safe to call from any thread.
+    std::shared_ptr<const Snapshot> current() const;
+
+    // Engine thread only; WarpStateCache posts these
+    void request(Entry entry);
+    void refresh(Entry entry);
+    void invalidate(Entry entry);
+    void invalidateAll();
+    void setTtl(Entry entry, int ms);
+    void runCommand(const QString &requestId, const QStringList &args);
+
+signals:
+    void published(std::shared_ptr<const WarpStateCache::Snapshot> snapshot, WarpStateCache::Entry entry,
+                   WarpStateCache::Event event);
+
+private:
+    struct Query {
+        QString requestId;
+        QStringList args;
+        bool json = false;
+    };
+
+    WarpStateCache::EntryState &state(Entry entry);
+    bool isFresh(Entry entry) const;
+    void onFinished(const QString &requestId, const WarpResult &result);
+    void parse(Entry entry);
+    void publish(Entry entry, Event event);
+
+    WarpCli *m_cli;
+    std::array<Query, WarpStateCache::kEntryCount> m_queries;
+    Snapshot m_working; // the engine's private copy, published by value
+    std::shared_ptr<const Snapshot> m_published;
+    StatusSnapshot m_status;
+    QSet<QString> m_commands;
+};
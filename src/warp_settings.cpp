@@ -0,0 +1,217 @@
+#include "warp_settings.h"
+
+#include <cstring>
+
+namespace {
+
+enum class Section {
+    None,
+    Exclude,
+    Include,
+    Fallback,
+    TrustedSsids,
+};
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// [begin, end) with surrounding whitespace removed
+void trim(const char *&begin, const char *&end) {
+    while (begin < end && isSpace(*begin)) {
+        ++begin;
+    }
+    while (end > begin && isSpace(end[-1])) {
+        --end;
+    }
+}
+
+bool keyEquals(const char *begin, const char *end, const char *literal) {
+    const size_t length = std::strlen(literal);
+    if (static_cast<size_t>(end - begin) != length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; ++i) {
+        char c = begin[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != literal[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool keyStartsWith(const char *begin, const char *end, const char *literal) {
+    const size_t length = std::strlen(literal);
+    return static_cast<size_t>(end - begin) >= length && keyEquals(begin, begin + length, literal);
+}
+
+QString toString(const char *begin, const char *end) {
+    return QString::fromUtf8(begin, static_cast<qsizetype>(end - begin));
+}
+
+std::optional<bool> toBool(const char *begin, const char *end) {
+    if (keyEquals(begin, end, "true")) {
+        return true;
+    }
+    if (keyEquals(begin, end, "false")) {
+        return false;
+    }
+    return std::nullopt;
+}
+
+QString normalizeFamilies(const char *begin, const char *end) {
+    const QString value = toString(begin, end).toLower();
+    if (value.contains(QStringLiteral("adult")) || value == QStringLiteral("full")) {
+        return QStringLiteral("full");
+    }
+    if (value.contains(QStringLiteral("malware"))) {
+        return QStringLiteral("malware");
+    }
+    return value;
+}
+
+// Appends the comma separated items of an inline "[a, b]" value
+void appendInlineList(QStringList &target, const char *begin, const char *end) {
+    if (begin < end && *begin == '[') {
+        ++begin;
+    }
+    if (end > begin && end[-1] == ']') {
+        --end;
+    }
+    while (begin < end) {
+        const char *comma = static_cast<const char *>(std::memchr(begin, ',', static_cast<size_t>(end - begin)));
+        const char *itemEnd = comma ? comma : end;
+        const char *itemBegin = begin;
+        trim(itemBegin, itemEnd);
+        if (itemBegin < itemEnd) {
+            target.append(toString(itemBegin, itemEnd));
+        }
+        begin = comma ? comma + 1 : end;
+    }
+}
+
+void appendSplitTunnel(WarpSettings::SplitTunnel &target, const char *begin, const char *end) {
+    const QByteArray entry = QByteArray::fromRawData(begin, static_cast<qsizetype>(end - begin));
+    (WarpSettings::isAddress(entry) ? target.addresses : target.hosts).append(toString(begin, end));
+}
+
+} // namespace
+
+WarpSettings WarpSettings::parse(const QByteArray &text) {
+    WarpSettings settings;
+    Section section = Section::None;
+
+    const char *pos = text.constData();
+    const char *const textEnd = pos + text.size();
+    while (pos < textEnd) {
+        const char *newline = static_cast<const char *>(std::memchr(pos, '\n', static_cast<size_t>(textEnd - pos)));
+        const char *lineEnd = newline ? newline : textEnd;
+        const char *line = pos;
+        pos = newline ? newline + 1 : textEnd;
+
+        const bool indented = line < lineEnd && isSpace(*line);
+        trim(line, lineEnd);
+        if (line == lineEnd) {
+            continue;
+        }
+
+        // Indented lines belong to the list opened by the previous setting
+        if (indented && *line != '(') {
+            switch (section) {
+            case Section::Exclude:
+                appendSplitTunnel(settings.exclude, line, lineEnd);
+                break;
+            case Section::Include:
+                appendSplitTunnel(settings.include, line, lineEnd);
+                break;
+            case Section::Fallback:
+                settings.fallbackDomains.append(toString(line, lineEnd));
+                break;
+            case Section::TrustedSsids:
+                settings.trustedSsids.append(toString(line, lineEnd));
+                break;
+            case Section::None:
+                break;
+            }
+            continue;
+        }
+
+        section = Section::None;
+        if (*line != '(') {
+            // Headings such as "Merged configuration:"
+            continue;
+        }
+
+        const char *closing = static_cast<const char *>(std::memchr(line, ')', static_cast<size_t>(lineEnd - line)));
+        const char *colon = closing
+            ? static_cast<const char *>(std::memchr(closing, ':', static_cast<size_t>(lineEnd - closing)))
+            : nullptr;
+        if (!colon) {
+            continue;
+        }
+
+        const char *key = closing + 1;
+        const char *keyEnd = colon;
+        const char *value = colon + 1;
+        const char *valueEnd = lineEnd;
+        trim(key, keyEnd);
+        trim(value, valueEnd);
+
+        if (keyEquals(key, keyEnd, "mode")) {
+            settings.mode = toString(value, valueEnd);
+        } else if (keyStartsWith(key, keyEnd, "exclude mode")) {
+            section = Section::Exclude;
+        } else if (keyStartsWith(key, keyEnd, "include mode")) {
+            section = Section::Include;
+        } else if (keyEquals(key, keyEnd, "fallback domains")) {
+            section = Section::Fallback;
+        } else if (keyEquals(key, keyEnd, "trusted ssids")) {
+            section = Section::TrustedSsids;
+            appendInlineList(settings.trustedSsids, value, valueEnd);
+        } else if (keyEquals(key, keyEnd, "disabled for wifi")) {
+            settings.disabledForWifi = toBool(value, valueEnd);
+        } else if (keyEquals(key, keyEnd, "disabled for ethernet")) {
+            settings.disabledForEthernet = toBool(value, valueEnd);
+        } else if (keyEquals(key, keyEnd, "gateway id")) {
+            settings.gatewayId = toString(value, valueEnd);
+        } else if (keyEquals(key, keyEnd, "organization")) {
+            settings.organization = toString(value, valueEnd);
+        } else if (keyStartsWith(key, keyEnd, "families") || keyStartsWith(key, keyEnd, "dns families")) {
+            settings.familiesMode = normalizeFamilies(value, valueEnd);
+        }
+    }
+
+    return settings;
+}
+
+bool WarpSettings::isAddress(const QByteArray &entry) {
+    if (entry.contains('/') || entry.contains(':')) {
+        return true;
+    }
+
+    // Dotted quad: four groups of digits
+    const char *p = entry.constData();
+    const char *end = p + entry.size();
+    for (int group = 0; group < 4; ++group) {
+        if (p == end || !isDigit(*p)) {
+            return false;
+        }
+        while (p < end && isDigit(*p)) {
+            ++p;
+        }
+        if (group < 3) {
+            if (p == end || *p != '.') {
+                return false;
+            }
+            ++p;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include <optional>
+
+// Typed view of `warp-cli settings`, built in one pass over the raw output.
+// Each line looks like "(source)\tKey: value"; list settings such as the
+// split tunnel end in a bare "Key:" followed by indented entries.
+struct WarpSettings {
+    struct SplitTunnel {
+        QStringList addresses; // IPs and CIDR ranges
+        QStringList hosts;
+    };
+
+    QString mode; // e.g. "WarpWithDnsOverHttps", empty when not reported
+    SplitTunnel exclude;
+    SplitTunnel include;
+    QStringList fallbackDomains;
+    QString familiesMode; // lowercased: "off", "malware" or "full"
+    QStringList trustedSsids;
+    std::optional<bool> disabledForWifi;
+    std::optional<bool> disabledForEthernet;
+    QString gatewayId;
+    QString organization;
+
+    static WarpSettings parse(const QByteArray &text);
+
+    // True for IPv4/IPv6 addresses and CIDR ranges, false for host names
+    static bool isAddress(const QByteArray &entry);
+};
@@ -0,0 +1,171 @@
+#include "warp_state_cache.h"
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <chrono>
+
+#include "spawn_helper.h"
+#include "warp_cli.h"
+#include "warp_engine.h"
+
+WarpStateCache *WarpStateCache::instance() {
+    static WarpStateCache *cache = new WarpStateCache(QCoreApplication::instance());
+    return cache;
+}
+
+qint64 WarpStateCache::clockMs() {
+    using namespace std::chrono;
+    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+WarpStateCache::WarpStateCache(QObject *parent)
+    : QObject(parent),
+      m_thread(new QThread(this)),
+      m_engine(new WarpEngine()) {
+    qRegisterMetaType<std::shared_ptr<const Snapshot>>();
+    m_thread->setObjectName(QStringLiteral("warp-engine"));
+    m_snapshot = m_engine->current();
+
+    // warp-cli is only ever launched from the engine thread, so that is
+    // where the spawn helper client has to live
+    SpawnHelper::setOwnerThread(m_thread);
+
+    m_engine->moveToThread(m_thread);
+    m_thread->start();
+    QMetaObject::invokeMethod(m_engine, &WarpEngine::initialize, Qt::BlockingQueuedConnection);
+
+    // All of these cross threads and are therefore queued
+    connect(m_engine, &WarpEngine::published, this, &WarpStateCache::onPublished);
+    WarpCli *cli = m_engine->cli();
+    connect(cli, &WarpCli::finished, this, &WarpStateCache::finished);
+    connect(cli, &WarpCli::statusChanged, this, &WarpStateCache::statusChanged);
+    connect(cli, &WarpCli::statusSubscriptionChanged, this, &WarpStateCache::statusSubscriptionChanged);
+}
+
+WarpStateCache::~WarpStateCache() {
+    // The engine's children (processes, sockets, timers) must be torn down
+    // on the thread that owns them
+    WarpEngine *engine = m_engine;
+    QMetaObject::invokeMethod(engine, [engine]() { delete engine; }, Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
+}
+
+template <typename Function>
+void WarpStateCache::post(Function &&function) {
+    QMetaObject::invokeMethod(m_engine, std::forward<Function>(function), Qt::QueuedConnection);
+}
+
+std::shared_ptr<const WarpStateCache::Snapshot> WarpStateCache::snapshot() const {
+    return m_snapshot;
+}
+
+WarpResult WarpStateCache::result(Entry entry) const {
+    return m_snapshot->at(entry).result;
+}
+
+QByteArray WarpStateCache::data(Entry entry) const {
+    return m_snapshot->at(entry).result.stdoutData;
+}
+
+QString WarpStateCache::text(Entry entry) const {
+    return m_snapshot->at(entry).result.stdoutText();
+}
+
+bool WarpStateCache::hasData(Entry entry) const {
+    return m_snapshot->at(entry).fetchedAtMs >= 0;
+}
+
+quint64 WarpStateCache::version(Entry entry) const {
+    return m_snapshot->at(entry).version;
+}
+
+bool WarpStateCache::isFresh(Entry entry) const {
+    return m_snapshot->at(entry).isFresh(clockMs());
+}
+
+void WarpStateCache::setTtl(Entry entry, int ms) {
+    WarpEngine *engine = m_engine;
+    post([engine, entry, ms]() { engine->setTtl(entry, ms); });
+}
+
+int WarpStateCache::ttl(Entry entry) const {
+    return m_snapshot->at(entry).ttlMs;
+}
+
+void WarpStateCache::request(Entry entry) {
+    // Freshness is decided on the engine thread, against its current state
+    WarpEngine *engine = m_engine;
+    post([engine, entry]() { engine->request(entry); });
+}
+
+void WarpStateCache::refresh(Entry entry) {
+    WarpEngine *engine = m_engine;
+    post([engine, entry]() { engine->refresh(entry); });
+}
+
+void WarpStateCache::invalidate(Entry entry) {
+    WarpEngine *engine = m_engine;
+    post([engine, entry]() { engine->invalidate(entry); });
+}
+
+void WarpStateCache::invalidateAll() {
+    WarpEngine *engine = m_engine;
+    post([engine]() { engine->invalidateAll(); });
+}
+
+void WarpStateCache::runCommand(const QString &requestId, const QStringList &args) {
+    WarpEngine *engine = m_engine;
+    post([engine, requestId, args]() { engine->runCommand(requestId, args); });
+}
+
+void WarpStateCache::run(const QString &requestId, const QStringList &args) {
+    WarpEngine *engine = m_engine;
+    post([engine, requestId, args]() { engine->cli()->run(requestId, args); });
+}
+
+void WarpStateCache::subscribeStatus() {
+    WarpEngine *engine = m_engine;
+    post([engine]() { engine->cli()->subscribeStatus(); });
+}
+
+void WarpStateCache::unsubscribeStatus() {
+    WarpEngine *engine = m_engine;
+    post([engine]() { engine->cli()->unsubscribeStatus(); });
+}
+
+const WarpSettings &WarpStateCache::settings() const {
+    return *m_snapshot->settings;
+}
+
+const StatusSnapshot &WarpStateCache::status() const {
+    return m_snapshot->status;
+}
+
+bool WarpStateCache::isStatusValid() const {
+    return m_snapshot->statusValid;
+}
+
+bool WarpStateCache::isZeroTrust() const {
+    return m_snapshot->zeroTrust;
+}
+
+void WarpStateCache::onPublished(const std::shared_ptr<const Snapshot> &snapshot, Entry entry, Event event) {
+    m_snapshot = snapshot;
+
+    switch (event) {
+    case Event::Updated:
+        emit updated(entry);
+        break;
+    case Event::Changed:
+        emit updated(entry);
+        emit changed(entry);
+        break;
+    case Event::Failed:
+        emit failed(entry, snapshot->at(entry).lastFailure);
+        break;
+    case Event::Invalidated:
+        break;
+    }
+}
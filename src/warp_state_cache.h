@@ -0,0 +1,140 @@
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include <array>
+#include <memory>
+
+#include "status_snapshot.h"
+#include "warp_settings.h"
+#include "warp_transport.h"
+
+class QThread;
+class WarpEngine;
+
+// Process-wide cache of what warp-cli reports. The tray, popup and
+// preferences all read from here, so a piece of state is fetched once and
+// shared instead of every view spawning its own warp-cli.
+//
+// The work happens on a dedicated engine thread (see WarpEngine). This
+// object lives on the GUI thread: it forwards requests to the engine and
+// holds the latest immutable Snapshot the engine published, so reads never
+// block and never see a half-updated state.
+class WarpStateCache : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Entry {
+        Status,       // warp-cli -j status
+        Settings,     // warp-cli settings
+        Registration, // warp-cli registration show
+        TunnelStats,  // warp-cli tunnel stats
+        Network,      // warp-cli debug network
+    };
+    Q_ENUM(Entry)
+
+    // What a published snapshot changed
+    enum class Event {
+        Updated,     // fetch completed with the same output as before
+        Changed,     // fetch completed with new output
+        Failed,      // fetch timed out or warp-cli could not be started
+        Invalidated, // only staleness or TTLs changed
+    };
+    Q_ENUM(Event)
+
+    static constexpr int kEntryCount = 5;
+
+    struct EntryState {
+        WarpResult result;      // last completed fetch
+        WarpResult lastFailure; // last fetch that did not complete
+        quint64 version = 0;    // bumped whenever the stored output changes
+        qint64 fetchedAtMs = -1; // on clockMs(), not the wall clock
+        int ttlMs = 0;
+        bool stale = true;
+
+        bool isFresh(qint64 nowMs) const { return fetchedAtMs >= 0 && !stale && nowMs - fetchedAtMs <= ttlMs; }
+    };
+
+    // Never modified once published; hold on to it for a consistent view
+    struct Snapshot {
+        std::array<EntryState, kEntryCount> entries;
+        std::shared_ptr<const WarpSettings> settings = std::make_shared<const WarpSettings>();
+        StatusSnapshot status; // parsed from the Status entry
+        bool statusValid = false;
+        bool zeroTrust = false; // derived from the Registration entry
+
+        const EntryState &at(Entry entry) const { return entries[static_cast<size_t>(entry)]; }
+    };
+
+    static WarpStateCache *instance();
+
+    // Monotonic milliseconds, the time base of entry ages; unlike the wall
+    // clock it does not jump when NTP or the user changes the time
+    static qint64 clockMs();
+    ~WarpStateCache() override;
+
+    std::shared_ptr<const Snapshot> snapshot() const;
+
+    // Last completed fetch, possibly stale. Empty until the first one lands.
+    WarpResult result(Entry entry) const;
+    QByteArray data(Entry entry) const;
+    QString text(Entry entry) const;
+    bool hasData(Entry entry) const;
+
+    // Bumped whenever the stored output changes
+    quint64 version(Entry entry) const;
+    bool isFresh(Entry entry) const;
+
+    void setTtl(Entry entry, int ms);
+    int ttl(Entry entry) const;
+
+    // Fetches entry unless it is still fresh
+    void request(Entry entry);
+    // Fetches entry regardless of its age
+    void refresh(Entry entry);
+    void invalidate(Entry entry);
+    void invalidateAll();
+
+    // Runs a state-changing command and invalidates every entry once it
+    // completes. The result is delivered through finished as usual.
+    void runCommand(const QString &requestId, const QStringList &args);
+    // Runs any other warp-cli query; the result arrives through finished
+    void run(const QString &requestId, const QStringList &args);
+
+    void subscribeStatus();
+    void unsubscribeStatus();
+
+    // Parsed on the engine thread from the Settings, Status and
+    // Registration entries
+    const WarpSettings &settings() const;
+    const StatusSnapshot &status() const;
+    bool isStatusValid() const;
+    bool isZeroTrust() const;
+
+signals:
+    // Every completed fetch, whether or not the output changed
+    void updated(WarpStateCache::Entry entry);
+    // Only when the output differs from what was stored before
+    void changed(WarpStateCache::Entry entry);
+    // Fetch timed out or warp-cli could not be started
+    void failed(WarpStateCache::Entry entry, const WarpResult &result);
+
+    // Forwarded from the engine's WarpCli
+    void finished(const QString &requestId, const WarpResult &result);
+    void statusChanged(const QByteArray &status);
+    void statusSubscriptionChanged(bool live);
+
+private:
+    explicit WarpStateCache(QObject *parent = nullptr);
+
+    template <typename Function>
+    void post(Function &&function);
+    void onPublished(const std::shared_ptr<const Snapshot> &snapshot, Entry entry, Event event);
+
+    QThread *m_thread;
+    WarpEngine *m_engine;
+    std::shared_ptr<const Snapshot> m_snapshot;
+};
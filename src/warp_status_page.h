@@ -0,0 +1,96 @@
+#pragma once
+
+/*
+ * Layout of the status page warp-gui keeps in $XDG_RUNTIME_DIR. Plain C so
+ * shell prompts, status bar modules and other tools can include it as is.
+ *
+ * The page is guarded by a seqlock: the writer makes `sequence` odd while it
+ * updates the fields and even again afterwards. Readers copy the page and
+ * retry if the sequence was odd or moved during the copy. They never block
+ * the writer or each other, and a read costs no system calls once the file
+ * is mapped.
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define WARP_STATUS_FILE_NAME "warp-gui-status"
+#define WARP_STATUS_MAGIC 0x50535747u /* "GWSP" */
+#define WARP_STATUS_VERSION 1u
+
+enum warp_status_state {
+    WARP_STATUS_UNKNOWN = 0, /* not running, or warp-cli gave no answer */
+    WARP_STATUS_DISCONNECTED = 1,
+    WARP_STATUS_CONNECTING = 2,
+    WARP_STATUS_CONNECTED = 3,
+};
+
+struct warp_status_page {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t sequence;   /* odd while an update is in progress */
+    uint32_t state;      /* enum warp_status_state */
+    int64_t updated_ms;  /* last change, milliseconds since the Unix epoch */
+    int32_t writer_pid;  /* 0 once warp-gui has exited */
+    uint32_t zero_trust; /* 1 when enrolled in a Zero Trust organization */
+    /* NUL-terminated UTF-8, truncated to fit */
+    char status[64];     /* as shown in the tray, e.g. "Connected" */
+    char reason[256];    /* detail from warp-cli, empty when none */
+    char mode[32];       /* lower case, e.g. "warp" or "doh" */
+    char colo[8];        /* Cloudflare colocation center while connected, e.g. "FRA" */
+};
+
+/* Maps the page read-only. Returns NULL when warp-gui has never run for this
+ * user, XDG_RUNTIME_DIR is unset, or warp-gui has created the file but not
+ * yet sized it (reading past the end of the file would raise SIGBUS). Keep
+ * the mapping for as long as you like; a restarted warp-gui reuses the same
+ * file. */
+static inline const struct warp_status_page *warp_status_map(void)
+{
+    const char *dir = getenv("XDG_RUNTIME_DIR");
+    char path[4096];
+    if (!dir || !*dir || snprintf(path, sizeof path, "%s/%s", dir, WARP_STATUS_FILE_NAME) >= (int)sizeof path)
+        return NULL;
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(struct warp_status_page)) {
+        close(fd);
+        return NULL;
+    }
+    void *page = mmap(NULL, sizeof(struct warp_status_page), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    return page == MAP_FAILED ? NULL : (const struct warp_status_page *)page;
+}
+
+/* Copies a consistent snapshot of the page into out. Returns 0 on success
+ * and -1 when the page is not a status page of this version, or the writer
+ * kept it busy for max_tries attempts. */
+static inline int warp_status_read(const struct warp_status_page *page, struct warp_status_page *out, int max_tries)
+{
+    for (int i = 0; i < max_tries; ++i) {
+        const uint32_t before = __atomic_load_n(&page->sequence, __ATOMIC_ACQUIRE);
+        if (before & 1u)
+            continue;
+        memcpy(out, page, sizeof *out);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&page->sequence, __ATOMIC_RELAXED) != before)
+            continue;
+        if (out->magic != WARP_STATUS_MAGIC || out->version != WARP_STATUS_VERSION)
+            return -1;
+        out->status[sizeof out->status - 1] = '\0';
+        out->reason[sizeof out->reason - 1] = '\0';
+        out->mode[sizeof out->mode - 1] = '\0';
+        out->colo[sizeof out->colo - 1] = '\0';
+        return 0;
+    }
+    return -1;
+}
@@ -0,0 +1,3 @@
+#include "warp_transport.h"
+
+WarpTransport::WarpTransport(QObject *parent) : QObject(parent) {}
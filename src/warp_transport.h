@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+struct WarpResult {
+    enum class Outcome {
+        Finished,      // The command ran to completion; see exitCode
+        TimedOut,      // The deadline passed and the command was killed
+        Cancelled,     // The caller withdrew the request
+        FailedToStart, // warp-cli could not be launched
+    };
+
+    Outcome outcome = Outcome::Finished;
+    int exitCode = -1;
+    QByteArray stdoutData;
+    QByteArray stderrData;
+
+    // Decoded copies for callers that need text; parsers should use the bytes
+    QString stdoutText() const { return QString::fromUtf8(stdoutData); }
+    QString stderrText() const { return QString::fromUtf8(stderrData); }
+
+    bool succeeded() const { return outcome == Outcome::Finished && exitCode == 0; }
+
+    static WarpResult withOutcome(Outcome outcome) {
+        WarpResult result;
+        result.outcome = outcome;
+        return result;
+    }
+};
+
+// A backend that executes warp-cli style commands and reports their result.
+// Requests are identified by a ticket chosen by the caller (WarpCli).
+class WarpTransport : public QObject {
+    Q_OBJECT
+
+public:
+    explicit WarpTransport(QObject *parent = nullptr);
+
+    virtual QString name() const = 0;
+    virtual bool isAvailable() const = 0;
+    virtual void submit(quint64 ticket, const QStringList &args) = 0;
+    // Stops a submitted request. No completed() is emitted for it afterwards.
+    virtual void abort(quint64 ticket) = 0;
+
+signals:
+    void completed(quint64 ticket, const WarpResult &result);
+    // The transport lost the request before it produced a result (e.g. the
+    // daemon connection went away). The caller may resubmit it elsewhere.
+    void dropped(quint64 ticket);
+};
@@ -8,11 +8,14 @@
 #include <KWindowSystem>
 #include <LayerShellQt/Window>
 
+#include "trace.h"
+
 bool WaylandPopupHelper::isWayland() {
     return KWindowSystem::isPlatformWayland();
 }
 
 void WaylandPopupHelper::setupPopupWindow(QWidget *widget, const QPoint &position, bool anchorBottom) {
+    TraceScope trace("ui", "WaylandPopupHelper::setupPopupWindow");
     if (!widget) {
         return;
     }
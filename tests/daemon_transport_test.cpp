@@ -0,0 +1,195 @@
+// DaemonTransport against a stand-in daemon on a QLocalServer: replies,
+// malformed replies, disconnects and a daemon that never answers.
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "daemon_transport.h"
+
+namespace {
+
+// Accepts one client and hands back each request line for the test to answer
+class StandInDaemon : public QObject {
+    Q_OBJECT
+
+public:
+    explicit StandInDaemon(const QString &path) {
+        QLocalServer::removeServer(path);
+        m_server.listen(path);
+        connect(&m_server, &QLocalServer::newConnection, this, [this]() {
+            m_client = m_server.nextPendingConnection();
+            connect(m_client, &QLocalSocket::readyRead, this, [this]() {
+                while (m_client->canReadLine()) {
+                    m_requests.append(QJsonDocument::fromJson(m_client->readLine()).object());
+                }
+            });
+        });
+    }
+
+    bool isListening() const { return m_server.isListening(); }
+    QLocalSocket *client() const { return m_client; }
+    QList<QJsonObject> &requests() { return m_requests; }
+
+    void send(const QByteArray &line) {
+        m_client->write(line + '\n');
+        m_client->flush();
+    }
+
+    void reply(qint64 id, int exitCode, const QString &out, const QString &err = QString()) {
+        QJsonObject obj;
+        obj.insert(QStringLiteral("id"), id);
+        obj.insert(QStringLiteral("exitCode"), exitCode);
+        obj.insert(QStringLiteral("stdout"), out);
+        obj.insert(QStringLiteral("stderr"), err);
+        send(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+    }
+
+private:
+    QLocalServer m_server;
+    QLocalSocket *m_client = nullptr;
+    QList<QJsonObject> m_requests;
+};
+
+const QStringList kStatusArgs{QStringLiteral("--accept-tos"), QStringLiteral("-j"), QStringLiteral("status")};
+
+} // namespace
+
+class DaemonTransportTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void reply();
+    void lateReplyAfterAbort();
+    void malformedReply();
+    void disconnectDropsInFlight();
+    void noReplyTimesOut();
+
+private:
+    QString socketPath() const { return m_dir.filePath(QStringLiteral("daemon.sock")); }
+
+    QTemporaryDir m_dir;
+};
+
+void DaemonTransportTest::initTestCase() {
+    QVERIFY(m_dir.isValid());
+    // Keep the user's daemon/* settings out of the test
+    qputenv("XDG_CONFIG_HOME", m_dir.path().toUtf8());
+}
+
+void DaemonTransportTest::reply() {
+    StandInDaemon daemon(socketPath());
+    QVERIFY(daemon.isListening());
+    DaemonTransport transport(socketPath());
+    QTRY_VERIFY(transport.isAvailable());
+    QCOMPARE(transport.name(), QStringLiteral("daemon"));
+
+    QSignalSpy completed(&transport, &WarpTransport::completed);
+    QSignalSpy dropped(&transport, &WarpTransport::dropped);
+    transport.submit(7, kStatusArgs);
+
+    QTRY_COMPARE(daemon.requests().size(), 1);
+    const QJsonObject request = daemon.requests().constFirst();
+    QCOMPARE(request.value(QStringLiteral("id")).toInteger(), 7);
+    QCOMPARE(request.value(QStringLiteral("args")).toArray(), QJsonArray::fromStringList(kStatusArgs));
+
+    // A reply for an unknown ticket is ignored
+    daemon.reply(99, 0, QStringLiteral("stray"));
+    daemon.reply(7, 0, QStringLiteral("{\"status\":\"Connected\"}"), QStringLiteral("note"));
+
+    QTRY_COMPARE(completed.size(), 1);
+    QCOMPARE(completed.at(0).at(0).value<quint64>(), quint64(7));
+    const auto result = completed.at(0).at(1).value<WarpResult>();
+    QCOMPARE(result.outcome, WarpResult::Outcome::Finished);
+    QCOMPARE(result.exitCode, 0);
+    QCOMPARE(result.stdoutData, QByteArray("{\"status\":\"Connected\"}"));
+    QCOMPARE(result.stderrData, QByteArray("note"));
+    QVERIFY(result.succeeded());
+    QCOMPARE(dropped.size(), 0);
+    QVERIFY(transport.isAvailable());
+}
+
+void DaemonTransportTest::lateReplyAfterAbort() {
+    StandInDaemon daemon(socketPath());
+    DaemonTransport transport(socketPath());
+    QTRY_VERIFY(transport.isAvailable());
+
+    QSignalSpy completed(&transport, &WarpTransport::completed);
+    transport.submit(1, kStatusArgs);
+    QTRY_COMPARE(daemon.requests().size(), 1);
+    transport.abort(1);
+    daemon.reply(1, 0, QStringLiteral("late"));
+
+    QTest::qWait(100);
+    QCOMPARE(completed.size(), 0);
+    QVERIFY(transport.isAvailable());
+}
+
+void DaemonTransportTest::malformedReply() {
+    StandInDaemon daemon(socketPath());
+    DaemonTransport transport(socketPath());
+    QTRY_VERIFY(transport.isAvailable());
+
+    QSignalSpy completed(&transport, &WarpTransport::completed);
+    QSignalSpy dropped(&transport, &WarpTransport::dropped);
+    transport.submit(1, kStatusArgs);
+    transport.submit(2, kStatusArgs);
+    QTRY_COMPARE(daemon.requests().size(), 2);
+
+    daemon.send("{\"id\": 1, \"exitCode\"");
+
+    // Both requests come back for another transport instead of hanging
+    QTRY_COMPARE(dropped.size(), 2);
+    QCOMPARE(completed.size(), 0);
+    QVERIFY(!transport.isAvailable());
+}
+
+void DaemonTransportTest::disconnectDropsInFlight() {
+    StandInDaemon daemon(socketPath());
+    DaemonTransport transport(socketPath());
+    QTRY_VERIFY(transport.isAvailable());
+
+    QSignalSpy dropped(&transport, &WarpTransport::dropped);
+    transport.submit(3, kStatusArgs);
+    QTRY_COMPARE(daemon.requests().size(), 1);
+    daemon.client()->disconnectFromServer();
+
+    QTRY_COMPARE(dropped.size(), 1);
+    QCOMPARE(dropped.at(0).at(0).value<quint64>(), quint64(3));
+    QVERIFY(!transport.isAvailable());
+
+    // Submitting while disconnected drops right away
+    transport.submit(4, kStatusArgs);
+    QCOMPARE(dropped.size(), 2);
+    QCOMPARE(dropped.at(1).at(0).value<quint64>(), quint64(4));
+}
+
+void DaemonTransportTest::noReplyTimesOut() {
+    StandInDaemon daemon(socketPath());
+    DaemonTransport transport(socketPath());
+    transport.setReplyTimeout(200);
+    QTRY_VERIFY(transport.isAvailable());
+
+    QSignalSpy completed(&transport, &WarpTransport::completed);
+    QSignalSpy dropped(&transport, &WarpTransport::dropped);
+    QElapsedTimer clock;
+    clock.start();
+    transport.submit(5, kStatusArgs);
+    QTRY_COMPARE(daemon.requests().size(), 1);
+
+    QTRY_COMPARE_WITH_TIMEOUT(dropped.size(), 1, 2000);
+    QVERIFY(clock.elapsed() >= 200);
+    QCOMPARE(dropped.at(0).at(0).value<quint64>(), quint64(5));
+    QCOMPARE(completed.size(), 0);
+    QVERIFY(!transport.isAvailable());
+}
+
+QTEST_GUILESS_MAIN(DaemonTransportTest)
+#include "daemon_transport_test.moc"
@@ -0,0 +1,109 @@
+#!/bin/sh
+# Runs warp-gui on a private session bus against the scripted warp-cli and
+# checks the io.github.WarpGui interface from the outside, the way a panel
+# widget would see it. Registered with ctest when dbus-run-session and gdbus
+# are installed.
+#
+#   dbus_service_test.sh <warp-gui> <stub dir>
+#
+# Re-executes itself under dbus-run-session, so neither the desktop session
+# bus nor a running warp-gui is touched.
+
+set -u
+
+if [ $# -ne 2 ]; then
+    echo "usage: $0 <warp-gui> <stub dir>" >&2
+    exit 2
+fi
+
+if [ -z "${WARP_GUI_TEST_PRIVATE_BUS:-}" ]; then
+    WARP_GUI_TEST_PRIVATE_BUS=1 exec dbus-run-session -- "$0" "$@"
+fi
+
+app=$1
+stub=$2
+dest=io.github.WarpGui
+path=/io/github/WarpGui
+iface=io.github.WarpGui
+
+scratch=$(mktemp -d)
+pid=
+cleanup() {
+    [ -n "$pid" ] && kill "$pid" 2>/dev/null && wait "$pid" 2>/dev/null
+    rm -rf "$scratch"
+}
+trap cleanup EXIT
+
+export PATH="$stub:$PATH"
+export QT_QPA_PLATFORM=${QT_QPA_PLATFORM:-offscreen}
+export XDG_CONFIG_HOME="$scratch" XDG_RUNTIME_DIR="$scratch" XDG_STATE_HOME="$scratch"
+unset WARP_GUI_DAEMON_SOCKET
+
+failures=0
+fail() {
+    echo "FAIL: $*" >&2
+    failures=$((failures + 1))
+}
+
+start() {
+    WARP_STUB_MODE=$1 "$app" >"$scratch/warp-gui.log" 2>&1 &
+    pid=$!
+}
+
+stop() {
+    kill "$pid" 2>/dev/null
+    wait "$pid" 2>/dev/null
+    pid=
+}
+
+mode() {
+    gdbus call --session --dest $dest --object-path $path \
+        --method org.freedesktop.DBus.Properties.Get $iface Mode 2>/dev/null
+}
+
+# Polls for up to five seconds until Mode reads as expected
+expect_mode() {
+    expected="(<'$1'>,)"
+    i=0
+    while [ $i -lt 50 ]; do
+        [ "$(mode)" = "$expected" ] && return 0
+        sleep 0.1
+        i=$((i + 1))
+    done
+    fail "WARP_STUB_MODE=$2: Mode is '$(mode)', expected $expected"
+    cat "$scratch/warp-gui.log" >&2
+    return 1
+}
+
+# Each mode warp-cli reports maps to a name SetMode accepts
+for pair in WarpWithDnsOverHttps=warp+doh Warp=warp DnsOverHttps=doh DnsOverTls=dot \
+            WarpWithDnsOverTls=warp+dot "WarpProxy on port 40000=proxy" TunnelOnly=tunnel_only; do
+    reported=${pair%=*}
+    start "$reported"
+    expect_mode "${pair#*=}" "$reported"
+    stop
+done
+
+start WarpWithDnsOverHttps
+if expect_mode warp+doh WarpWithDnsOverHttps; then
+    xml=$(gdbus introspect --session --dest $dest --object-path $path --xml)
+    echo "$xml" | grep -q 'name="Mode"' || fail "introspection does not list Mode"
+    echo "$xml" | grep -q 'warp+doh, dot, warp+dot, proxy, tunnel_only' ||
+        fail "introspection does not document the mode names"
+
+    # The value read back is accepted as is
+    current=$(mode | sed -n "s/^(<'\(.*\)'>,)\$/\1/p")
+    gdbus call --session --dest $dest --object-path $path --method $iface.SetMode "$current" >/dev/null ||
+        fail "SetMode rejected the Mode property value '$current'"
+
+    if gdbus call --session --dest $dest --object-path $path --method $iface.SetMode bogus \
+        >/dev/null 2>"$scratch/error"; then
+        fail "SetMode accepted an unknown mode"
+    elif ! grep -q InvalidArgs "$scratch/error"; then
+        fail "SetMode failed without InvalidArgs: $(cat "$scratch/error")"
+    fi
+fi
+stop
+
+[ $failures -eq 0 ] || exit 1
+echo "PASS"
@@ -0,0 +1,188 @@
+// DnsProbe against a stand-in resolver on 127.0.0.1 that answers over UDP
+// and TCP on the same port, truncates on request, or stays silent.
+
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTest>
+#include <QUdpSocket>
+
+#include <chrono>
+#include <future>
+
+#include "dns_probe.h"
+
+namespace {
+
+enum class Behavior {
+    Answer,
+    Truncate,  // TC bit over UDP, full answer over TCP
+    NxDomain,
+    Silent,
+};
+
+// Builds a response echoing the question, with an A record per address
+QByteArray makeResponse(const QByteArray &query, quint16 flags, const QList<QHostAddress> &addresses) {
+    QByteArray out = query.left(2);
+    out += char(flags >> 8);
+    out += char(flags & 0xff);
+    out += QByteArray::fromHex("0001");
+    out += char(0);
+    out += char(addresses.size());
+    out += QByteArray::fromHex("00000000");
+    out += query.mid(12);
+    for (const QHostAddress &address : addresses) {
+        const quint32 ip = address.toIPv4Address();
+        out += QByteArray::fromHex("c00c" "0001" "0001" "0000003c" "0004");
+        out += char(ip >> 24);
+        out += char((ip >> 16) & 0xff);
+        out += char((ip >> 8) & 0xff);
+        out += char(ip & 0xff);
+    }
+    return out;
+}
+
+class StandInResolver : public QObject {
+    Q_OBJECT
+
+public:
+    StandInResolver() {
+        // UDP and TCP must share a port number; retry until both bind
+        for (int attempt = 0; attempt < 20 && !m_tcp.isListening(); ++attempt) {
+            m_udp.close();
+            if (m_udp.bind(QHostAddress::LocalHost, 0)) {
+                m_tcp.listen(QHostAddress::LocalHost, m_udp.localPort());
+            }
+        }
+        connect(&m_udp, &QUdpSocket::readyRead, this, &StandInResolver::onDatagram);
+        connect(&m_tcp, &QTcpServer::newConnection, this, &StandInResolver::onConnection);
+    }
+
+    bool isReady() const { return m_tcp.isListening(); }
+    quint16 port() const { return m_udp.localPort(); }
+    void setBehavior(Behavior behavior) { m_behavior = behavior; }
+    int tcpQueries() const { return m_tcpQueries; }
+
+private:
+    void onDatagram() {
+        while (m_udp.hasPendingDatagrams()) {
+            QHostAddress peer;
+            quint16 peerPort = 0;
+            QByteArray query(static_cast<int>(m_udp.pendingDatagramSize()), Qt::Uninitialized);
+            m_udp.readDatagram(query.data(), query.size(), &peer, &peerPort);
+            switch (m_behavior) {
+            case Behavior::Answer:
+                m_udp.writeDatagram(makeResponse(query, 0x8180, {QHostAddress(QStringLiteral("192.0.2.1"))}), peer,
+                                    peerPort);
+                break;
+            case Behavior::Truncate:
+                m_udp.writeDatagram(makeResponse(query, 0x8380, {}), peer, peerPort);
+                break;
+            case Behavior::NxDomain:
+                m_udp.writeDatagram(makeResponse(query, 0x8183, {}), peer, peerPort);
+                break;
+            case Behavior::Silent:
+                break;
+            }
+        }
+    }
+
+    void onConnection() {
+        QTcpSocket *client = m_tcp.nextPendingConnection();
+        connect(client, &QTcpSocket::readyRead, this, [this, client]() {
+            const QByteArray framed = client->readAll();
+            const QByteArray query = framed.mid(2);
+            const QByteArray response = makeResponse(
+                query, 0x8180,
+                {QHostAddress(QStringLiteral("192.0.2.1")), QHostAddress(QStringLiteral("192.0.2.2"))});
+            ++m_tcpQueries;
+            client->write(QByteArray(1, char(response.size() >> 8)) + char(response.size() & 0xff) + response);
+            client->disconnectFromHost();
+        });
+    }
+
+    QUdpSocket m_udp;
+    QTcpServer m_tcp;
+    Behavior m_behavior = Behavior::Answer;
+    int m_tcpQueries = 0;
+};
+
+// Runs the blocking probe off the main thread while the resolver answers
+DnsProbe::Result runQuery(quint16 port, const QString &name, int timeoutMs = 2000) {
+    auto future = std::async(std::launch::async, [port, name, timeoutMs]() {
+        return DnsProbe::query(QStringLiteral("127.0.0.1"), name, DnsProbe::A, timeoutMs, port);
+    });
+    while (future.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
+        QTest::qWait(5);
+    }
+    return future.get();
+}
+
+} // namespace
+
+class DnsProbeTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void answer();
+    void truncatedRetriesOverTcp();
+    void nxDomain();
+    void noAnswerTimesOut();
+    void invalidInput();
+};
+
+void DnsProbeTest::answer() {
+    StandInResolver resolver;
+    QVERIFY(resolver.isReady());
+
+    const DnsProbe::Result result = runQuery(resolver.port(), QStringLiteral("example.com"));
+    QVERIFY2(result.ok, qPrintable(result.error));
+    QCOMPARE(result.rcode, 0);
+    QCOMPARE(result.addresses, QStringList{QStringLiteral("192.0.2.1")});
+    QVERIFY(!result.usedTcp);
+    QVERIFY(result.latencyMs >= 0);
+}
+
+void DnsProbeTest::truncatedRetriesOverTcp() {
+    StandInResolver resolver;
+    QVERIFY(resolver.isReady());
+    resolver.setBehavior(Behavior::Truncate);
+
+    const DnsProbe::Result result = runQuery(resolver.port(), QStringLiteral("example.com"));
+    QVERIFY2(result.ok, qPrintable(result.error));
+    QVERIFY(result.usedTcp);
+    QCOMPARE(resolver.tcpQueries(), 1);
+    QCOMPARE(result.addresses, (QStringList{QStringLiteral("192.0.2.1"), QStringLiteral("192.0.2.2")}));
+}
+
+void DnsProbeTest::nxDomain() {
+    StandInResolver resolver;
+    QVERIFY(resolver.isReady());
+    resolver.setBehavior(Behavior::NxDomain);
+
+    const DnsProbe::Result result = runQuery(resolver.port(), QStringLiteral("missing.example"));
+    QVERIFY(!result.ok);
+    QCOMPARE(result.rcode, 3);
+    QVERIFY(result.addresses.isEmpty());
+}
+
+void DnsProbeTest::noAnswerTimesOut() {
+    StandInResolver resolver;
+    QVERIFY(resolver.isReady());
+    resolver.setBehavior(Behavior::Silent);
+
+    const DnsProbe::Result result = runQuery(resolver.port(), QStringLiteral("example.com"), 200);
+    QVERIFY(!result.ok);
+    QCOMPARE(result.rcode, -1);
+    QCOMPARE(result.error, QStringLiteral("timed out"));
+    QVERIFY(result.latencyMs >= 200);
+    QVERIFY(result.latencyMs < 1000);
+}
+
+void DnsProbeTest::invalidInput() {
+    QVERIFY(!DnsProbe::query(QStringLiteral("not-an-address"), QStringLiteral("example.com")).ok);
+    QVERIFY(!DnsProbe::query(QStringLiteral("127.0.0.1"), QStringLiteral("bad..name")).ok);
+}
+
+QTEST_GUILESS_MAIN(DnsProbeTest)
+#include "dns_probe_test.moc"
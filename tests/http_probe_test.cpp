@@ -0,0 +1,160 @@
+// HttpProbe against a stand-in HTTP server on the loopback interface:
+// a normal response, a malformed one, one that never comes, a refused
+// port and a name with more than one address.
+
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTest>
+
+#include <chrono>
+#include <future>
+
+#include "http_probe.h"
+
+namespace {
+
+enum class Behavior {
+    Respond,
+    Garbage,
+    Silent,
+};
+
+class StandInServer : public QObject {
+    Q_OBJECT
+
+public:
+    explicit StandInServer(const QHostAddress &address = QHostAddress::LocalHost) {
+        m_server.listen(address, 0);
+        connect(&m_server, &QTcpServer::newConnection, this, [this]() {
+            QTcpSocket *client = m_server.nextPendingConnection();
+            connect(client, &QTcpSocket::readyRead, this, [this, client]() {
+                m_request += client->readAll();
+                if (!m_request.contains("\r\n\r\n")) {
+                    return;
+                }
+                switch (m_behavior) {
+                case Behavior::Respond:
+                    client->write("HTTP/1.0 200 OK\r\nContent-Type: text/plain\r\n\r\nfl=1\nloc=DE\ncolo=FRA\n");
+                    client->disconnectFromHost();
+                    break;
+                case Behavior::Garbage:
+                    client->write("not http at all");
+                    client->disconnectFromHost();
+                    break;
+                case Behavior::Silent:
+                    break;
+                }
+            });
+        });
+    }
+
+    bool isListening() const { return m_server.isListening(); }
+    quint16 port() const { return m_server.serverPort(); }
+    void setBehavior(Behavior behavior) { m_behavior = behavior; }
+    QByteArray request() const { return m_request; }
+
+private:
+    QTcpServer m_server;
+    QByteArray m_request;
+    Behavior m_behavior = Behavior::Respond;
+};
+
+// Runs the blocking probe off the main thread while the server answers
+HttpProbe::Result runGet(const QString &url, int timeoutMs = 2000) {
+    auto future = std::async(std::launch::async, [url, timeoutMs]() { return HttpProbe::get(QUrl(url), timeoutMs); });
+    while (future.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
+        QTest::qWait(5);
+    }
+    return future.get();
+}
+
+} // namespace
+
+class HttpProbeTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void response();
+    void malformedResponse();
+    void noResponseTimesOut();
+    void refused();
+    void triesEveryAddress();
+    void parseKeyValues();
+};
+
+void HttpProbeTest::response() {
+    StandInServer server;
+    QVERIFY(server.isListening());
+
+    const HttpProbe::Result result =
+        runGet(QStringLiteral("http://127.0.0.1:%1/cdn-cgi/trace?x=1").arg(server.port()));
+    QVERIFY2(result.ok, qPrintable(result.error));
+    QCOMPARE(result.statusCode, 200);
+    QCOMPARE(result.body, QByteArray("fl=1\nloc=DE\ncolo=FRA\n"));
+    QVERIFY(server.request().startsWith("GET /cdn-cgi/trace?x=1 HTTP/1.0\r\n"));
+    QVERIFY(server.request().contains("\r\nHost: 127.0.0.1\r\n"));
+
+    QVERIFY(result.timing.dnsMs >= 0);
+    QVERIFY(result.timing.connectMs >= 0);
+    QCOMPARE(result.timing.tlsMs, -1);
+    QVERIFY(result.timing.firstByteMs >= 0);
+    QVERIFY(result.timing.totalMs >= result.timing.dnsMs);
+}
+
+void HttpProbeTest::malformedResponse() {
+    StandInServer server;
+    server.setBehavior(Behavior::Garbage);
+
+    const HttpProbe::Result result = runGet(QStringLiteral("http://127.0.0.1:%1/").arg(server.port()));
+    QVERIFY(!result.ok);
+    QCOMPARE(result.error, QStringLiteral("Malformed HTTP response"));
+}
+
+void HttpProbeTest::noResponseTimesOut() {
+    StandInServer server;
+    server.setBehavior(Behavior::Silent);
+
+    const HttpProbe::Result result = runGet(QStringLiteral("http://127.0.0.1:%1/").arg(server.port()), 300);
+    QVERIFY(!result.ok);
+    QCOMPARE(result.error, QStringLiteral("Timed out"));
+    QVERIFY(result.timing.totalMs >= 300);
+    QVERIFY(result.timing.totalMs < 1500);
+}
+
+void HttpProbeTest::refused() {
+    quint16 port;
+    {
+        // A port that was just free is very likely still closed
+        QTcpServer probe;
+        QVERIFY(probe.listen(QHostAddress::LocalHost, 0));
+        port = probe.serverPort();
+    }
+
+    const HttpProbe::Result result = runGet(QStringLiteral("http://127.0.0.1:%1/").arg(port), 1000);
+    QVERIFY(!result.ok);
+    QVERIFY(!result.error.isEmpty());
+    QCOMPARE(result.timing.connectMs, -1);
+}
+
+void HttpProbeTest::triesEveryAddress() {
+    // localhost usually resolves to ::1 as well as 127.0.0.1; listening on
+    // IPv4 only means an IPv6-first lookup has to move on to the next one
+    StandInServer server(QHostAddress::LocalHost);
+    QVERIFY(server.isListening());
+
+    const HttpProbe::Result result = runGet(QStringLiteral("http://localhost:%1/").arg(server.port()));
+    QVERIFY2(result.ok, qPrintable(result.error));
+    QCOMPARE(result.statusCode, 200);
+}
+
+void HttpProbeTest::parseKeyValues() {
+    const auto fields = HttpProbe::parseKeyValues("fl=1\nloc = DE\r\nno equals\ncolo=FRA");
+    QCOMPARE(fields.value("fl"), QByteArray("1"));
+    QCOMPARE(fields.value("loc"), QByteArray("DE"));
+    QCOMPARE(fields.value("colo"), QByteArray("FRA"));
+    QVERIFY(!fields.contains("no equals"));
+}
+
+QTEST_GUILESS_MAIN(HttpProbeTest)
+#include "http_probe_test.moc"
@@ -0,0 +1,133 @@
+// WarpCli against the scripted warp-cli from bench/stub: which results are
+// reused within the freshness window and which completions drop them.
+
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "warp_cli.h"
+
+class WarpCliTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void init();
+    void queryIsReused();
+    void readOnlyQueryKeepsCachedStatus();
+    void commandDropsCachedStatus();
+    void commandSkipsBackgroundQueue();
+
+private:
+    // Invocations of the stub whose subcommand is args, e.g. "-j status"
+    int runs(const QString &args) const;
+    void finish(WarpCli &cli, const QString &requestId);
+
+    QTemporaryDir m_dir;
+};
+
+void WarpCliTest::initTestCase() {
+    QVERIFY(m_dir.isValid());
+    // Stub first on PATH; keep the user's settings and daemon socket out
+    qputenv("PATH", QByteArray(WARP_GUI_TEST_STUB_DIR) + ':' + qgetenv("PATH"));
+    qputenv("XDG_CONFIG_HOME", m_dir.path().toUtf8());
+    qunsetenv("WARP_GUI_DAEMON_SOCKET");
+    qputenv("WARP_STUB_LOG", m_dir.filePath(QStringLiteral("warp-cli.log")).toUtf8());
+}
+
+void WarpCliTest::init() {
+    QFile::remove(m_dir.filePath(QStringLiteral("warp-cli.log")));
+    qunsetenv("WARP_STUB_DELAY");
+}
+
+int WarpCliTest::runs(const QString &args) const {
+    QFile log(m_dir.filePath(QStringLiteral("warp-cli.log")));
+    if (!log.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+    int count = 0;
+    const QByteArray suffix = ' ' + args.toUtf8();
+    for (const QByteArray &line : log.readAll().split('\n')) {
+        count += line.endsWith(suffix) ? 1 : 0;
+    }
+    return count;
+}
+
+void WarpCliTest::finish(WarpCli &cli, const QString &requestId) {
+    QSignalSpy finished(&cli, &WarpCli::finished);
+    QTRY_VERIFY(!finished.isEmpty());
+    QCOMPARE(finished.constLast().at(0).toString(), requestId);
+    QCOMPARE(finished.constLast().at(1).value<WarpResult>().outcome, WarpResult::Outcome::Finished);
+}
+
+void WarpCliTest::queryIsReused() {
+    WarpCli cli;
+    cli.setFreshnessWindow(60000);
+
+    cli.runJson(QStringLiteral("first"), {QStringLiteral("status")});
+    finish(cli, QStringLiteral("first"));
+    cli.runJson(QStringLiteral("second"), {QStringLiteral("status")});
+    finish(cli, QStringLiteral("second"));
+
+    QCOMPARE(runs(QStringLiteral("-j status")), 1);
+}
+
+void WarpCliTest::readOnlyQueryKeepsCachedStatus() {
+    WarpCli cli;
+    cli.setFreshnessWindow(60000);
+
+    cli.runJson(QStringLiteral("status"), {QStringLiteral("status")});
+    finish(cli, QStringLiteral("status"));
+    // The cache's TunnelStats entry and Preferences run these as queries
+    cli.run(QStringLiteral("stats"), {QStringLiteral("tunnel"), QStringLiteral("stats")});
+    finish(cli, QStringLiteral("stats"));
+    cli.run(QStringLiteral("network"), {QStringLiteral("debug"), QStringLiteral("network")});
+    finish(cli, QStringLiteral("network"));
+
+    cli.runJson(QStringLiteral("again"), {QStringLiteral("status")});
+    finish(cli, QStringLiteral("again"));
+    QCOMPARE(runs(QStringLiteral("-j status")), 1);
+}
+
+void WarpCliTest::commandDropsCachedStatus() {
+    WarpCli cli;
+    cli.setFreshnessWindow(60000);
+
+    cli.runJson(QStringLiteral("status"), {QStringLiteral("status")});
+    finish(cli, QStringLiteral("status"));
+    cli.runCommand(QStringLiteral("connect"), {QStringLiteral("connect")});
+    finish(cli, QStringLiteral("connect"));
+
+    cli.runJson(QStringLiteral("again"), {QStringLiteral("status")});
+    finish(cli, QStringLiteral("again"));
+    QCOMPARE(runs(QStringLiteral("-j status")), 2);
+}
+
+void WarpCliTest::commandSkipsBackgroundQueue() {
+    WarpCli cli;
+    cli.setBackgroundConcurrency(1);
+    QSignalSpy finished(&cli, &WarpCli::finished);
+
+    // Three slow polls queue behind each other in the background lane
+    qputenv("WARP_STUB_DELAY", "0.3");
+    cli.runJson(QStringLiteral("status"), {QStringLiteral("status")});
+    cli.run(QStringLiteral("settings"), {QStringLiteral("settings")});
+    cli.run(QStringLiteral("stats"), {QStringLiteral("tunnel"), QStringLiteral("stats")});
+    QCOMPARE(cli.laneStats(WarpCli::Lane::Background).queued, 2);
+
+    // Not connect, disconnect or mode, and still not queued behind them
+    cli.runCommand(QStringLiteral("rotate"), {QStringLiteral("tunnel"), QStringLiteral("rotate-keys")});
+    QCOMPARE(cli.laneStats(WarpCli::Lane::Interactive).running, 1);
+    QCOMPARE(cli.laneStats(WarpCli::Lane::Background).queued, 2);
+
+    QTRY_COMPARE(finished.size(), 4);
+    QStringList order;
+    for (const QList<QVariant> &arguments : std::as_const(finished)) {
+        order.append(arguments.at(0).toString());
+    }
+    QVERIFY(order.indexOf(QStringLiteral("rotate")) < order.indexOf(QStringLiteral("stats")));
+}
+
+QTEST_GUILESS_MAIN(WarpCliTest)
+#include "warp_cli_test.moc"
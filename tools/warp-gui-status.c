@@ -0,0 +1,168 @@
+/*
+ * Prints warp-gui's connection state from its shared-memory status page,
+ * for shell prompts and status bars. Nothing is spawned and no IPC happens;
+ * the whole read is a memory copy.
+ *
+ *   warp-gui-status                  Connected
+ *   warp-gui-status -f '%s %c'       Connected FRA
+ *   warp-gui-status -j               {"state":"connected",...}
+ *   warp-gui-status -q && echo up
+ *
+ * Exit status: 0 connected, 1 not connected, 2 warp-gui is not running.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <getopt.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#include "warp_status_page.h"
+
+static const char *state_name(uint32_t state)
+{
+    switch (state) {
+    case WARP_STATUS_DISCONNECTED:
+        return "disconnected";
+    case WARP_STATUS_CONNECTING:
+        return "connecting";
+    case WARP_STATUS_CONNECTED:
+        return "connected";
+    default:
+        return "unknown";
+    }
+}
+
+static void print_json_string(const char *value)
+{
+    putchar('"');
+    for (const unsigned char *p = (const unsigned char *)value; *p; ++p) {
+        if (*p == '"' || *p == '\\')
+            printf("\\%c", *p);
+        else if (*p < 0x20)
+            printf("\\u%04x", *p);
+        else
+            putchar(*p);
+    }
+    putchar('"');
+}
+
+static void print_json(const struct warp_status_page *page)
+{
+    printf("{\"state\":\"%s\",\"status\":", state_name(page->state));
+    print_json_string(page->status);
+    printf(",\"reason\":");
+    print_json_string(page->reason);
+    printf(",\"mode\":");
+    print_json_string(page->mode);
+    printf(",\"colo\":");
+    print_json_string(page->colo);
+    printf(",\"zeroTrust\":%s,\"updatedMs\":%lld}\n", page->zero_trust ? "true" : "false",
+           (long long)page->updated_ms);
+}
+
+static void print_format(const char *format, const struct warp_status_page *page)
+{
+    for (const char *p = format; *p; ++p) {
+        if (*p != '%' || !p[1]) {
+            putchar(*p);
+            continue;
+        }
+        switch (*++p) {
+        case 's':
+            fputs(page->status, stdout);
+            break;
+        case 'S':
+            fputs(state_name(page->state), stdout);
+            break;
+        case 'r':
+            fputs(page->reason, stdout);
+            break;
+        case 'm':
+            fputs(page->mode, stdout);
+            break;
+        case 'c':
+            fputs(page->colo, stdout);
+            break;
+        case 'z':
+            fputs(page->zero_trust ? "zt" : "", stdout);
+            break;
+        case '%':
+            putchar('%');
+            break;
+        default:
+            putchar('%');
+            putchar(*p);
+            break;
+        }
+    }
+    putchar('\n');
+}
+
+static void usage(FILE *out)
+{
+    fputs("Usage: warp-gui-status [-q] [-j] [-f FORMAT]\n"
+          "  -f FORMAT  %s status, %S state (connected, connecting, disconnected, unknown),\n"
+          "             %r reason, %m mode, %c colo, %z \"zt\" under Zero Trust, %% percent\n"
+          "  -j         print every field as JSON\n"
+          "  -q         print nothing, only set the exit status\n"
+          "Exit status: 0 connected, 1 not connected, 2 warp-gui is not running\n",
+          out);
+}
+
+int main(int argc, char **argv)
+{
+    const char *format = "%s";
+    int json = 0;
+    int quiet = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "f:jqh")) != -1) {
+        switch (opt) {
+        case 'f':
+            format = optarg;
+            break;
+        case 'j':
+            json = 1;
+            break;
+        case 'q':
+            quiet = 1;
+            break;
+        case 'h':
+            usage(stdout);
+            return 0;
+        default:
+            usage(stderr);
+            return 2;
+        }
+    }
+
+    struct warp_status_page page;
+    const struct warp_status_page *mapped = warp_status_map();
+    if (!mapped || warp_status_read(mapped, &page, 1000) != 0) {
+        if (!quiet)
+            fputs("warp-gui-status: no status page; is warp-gui running?\n", stderr);
+        return 2;
+    }
+
+    /* A crashed writer never cleared its pid */
+    const int running = page.writer_pid > 0 && (kill(page.writer_pid, 0) == 0 || errno != ESRCH);
+    if (!running) {
+        page.state = WARP_STATUS_UNKNOWN;
+        snprintf(page.status, sizeof page.status, "Not running");
+        page.reason[0] = '\0';
+        page.colo[0] = '\0';
+    }
+
+    if (!quiet) {
+        if (json)
+            print_json(&page);
+        else
+            print_format(format, &page);
+    }
+
+    if (!running)
+        return 2;
+    return page.state == WARP_STATUS_CONNECTED ? 0 : 1;
+}